@@ -84,11 +84,52 @@
 #endif
 
 /** Use custom leak checking code.
+
+    This is cheap enough for release builds, where it provides live object
+    counts per class through LeakCheckedBase::getStatistics().
 */
 #ifndef VF_USE_LEAKCHECKED
 #define VF_USE_LEAKCHECKED 1
 #endif
 
+/** Compile in the instrumentation which reports through Metrics.
+
+    Collection still has to be started at run time with Metrics::enable().
+*/
+#ifndef VF_USE_METRICS
+#define VF_USE_METRICS 0
+#endif
+
+/** Compile in the VF_TRACE_SCOPE instrumentation.
+
+    Recording still has to be started at run time with Trace::enable().
+*/
+#ifndef VF_USE_TRACING
+#define VF_USE_TRACING 0
+#endif
+
+/** Activate C++20 coroutine awaitables for CallQueue and ThreadGroup.
+
+    When this is left undefined, coroutines are activated automatically if
+    the compiler supports them.
+*/
+//#define VF_USE_COROUTINES 1
+
+/** Use SSE2 intrinsics in the containers and math classes.
+
+    When this is left undefined, SSE2 is used automatically if the
+    compiler targets it. Set it to 0 to force the portable code paths.
+*/
+//#define VF_USE_SSE2 1
+
+/** Use NEON intrinsics in the math classes.
+
+    This is off unless it is set to 1, because the NEON code paths have
+    not been verified with an ARM compiler yet. The compiler must target
+    NEON when it is set.
+*/
+//#define VF_USE_NEON 1
+
 /*============================================================================*/
 
 // Ignore this
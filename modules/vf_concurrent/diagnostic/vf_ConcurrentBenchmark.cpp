@@ -0,0 +1,447 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+// One line of JSON output.
+//
+class ConcurrentBenchmark::Record
+{
+public:
+  explicit Record (char const* benchmark)
+  {
+    m_text << "{\"benchmark\":\"" << benchmark << "\"";
+  }
+
+  Record& add (char const* key, int value)
+  {
+    m_text << ",\"" << key << "\":" << String (value);
+    return *this;
+  }
+
+  Record& add (char const* key, double value)
+  {
+    m_text << ",\"" << key << "\":" << String (value);
+    return *this;
+  }
+
+  // Values are identifiers chosen by us, so no escaping is needed.
+  Record& add (char const* key, char const* value)
+  {
+    m_text << ",\"" << key << "\":\"" << value << "\"";
+    return *this;
+  }
+
+  void write (OutputStream& stream)
+  {
+    stream << m_text << "}\n";
+    stream.flush ();
+  }
+
+private:
+  String m_text;
+};
+
+//------------------------------------------------------------------------------
+
+class ConcurrentBenchmark::WorkerThread : public Thread
+{
+public:
+  WorkerThread (WaitableEvent& start, Body const& body)
+    : Thread ("ConcurrentBenchmark")
+    , m_start (start)
+    , m_body (body)
+  {
+  }
+
+  ~WorkerThread ()
+  {
+    stopThread (-1);
+  }
+
+  void run ()
+  {
+    m_start.wait ();
+
+    m_body ();
+  }
+
+private:
+  WaitableEvent& m_start;
+  Body m_body;
+};
+
+//------------------------------------------------------------------------------
+
+class ConcurrentBenchmark::Listener
+{
+public:
+  Listener () : m_sum (0)
+  {
+  }
+
+  void onEvent (int value)
+  {
+    m_sum += value;
+  }
+
+private:
+  int m_sum;
+};
+
+//------------------------------------------------------------------------------
+
+ConcurrentBenchmark::Options::Options ()
+  : maxProducers (SystemStats::getNumCpus ())
+  , callsPerProducer (100000)
+  , latencySamples (100000)
+  , maxListeners (64)
+  , listenerCalls (10000)
+  , parallelForLoops (10000)
+  , allocationsPerThread (1000000)
+{
+}
+
+ConcurrentBenchmark::ConcurrentBenchmark (Options const& options)
+  : m_options (options)
+  , m_start (true)
+  , m_consumed (0)
+{
+}
+
+void ConcurrentBenchmark::run (OutputStream& stream)
+{
+  runConfiguration (stream);
+  runThroughput (stream);
+  runLatency (stream);
+  runListeners (stream);
+  runParallelFor (stream);
+  runFreeStore (stream);
+}
+
+void ConcurrentBenchmark::runConfiguration (OutputStream& stream)
+{
+#if VF_USE_BOOST
+  char const* const allocator = "FifoFreeStoreWithTLS";
+#else
+  char const* const allocator = "FifoFreeStoreWithoutTLS";
+#endif
+
+#if VF_DEBUG
+  char const* const build = "debug";
+#else
+  char const* const build = "release";
+#endif
+
+  Record ("configuration")
+    .add ("allocator", allocator)
+    .add ("build", build)
+    .add ("cpus", SystemStats::getNumCpus ())
+    .write (stream);
+}
+
+//------------------------------------------------------------------------------
+
+// Producers call into a ManualCallQueue as fast as they can,
+// while this thread synchronizes it until every call is made.
+//
+void ConcurrentBenchmark::runThroughput (OutputStream& stream)
+{
+  for (int producers = 1; producers <= m_options.maxProducers; producers *= 2)
+  {
+    ManualCallQueue queue ("ConcurrentBenchmark");
+
+    int const total = producers * m_options.callsPerProducer;
+
+    m_consumed = 0;
+
+    double const seconds = runThreads (
+      producers,
+      vf::bind (&ConcurrentBenchmark::produceCalls, this, &queue),
+      vf::bind (&ConcurrentBenchmark::synchronizeUntil, this, &queue, total));
+
+    queue.close ();
+
+    Record ("callqueue.throughput")
+      .add ("producers", producers)
+      .add ("calls", total)
+      .add ("seconds", seconds)
+      .add ("callsPerSecond", total / seconds)
+      .write (stream);
+  }
+}
+
+// A single producer makes one call at a time, waiting for each
+// to be invoked before making the next, so only the hand-off is timed.
+//
+void ConcurrentBenchmark::runLatency (OutputStream& stream)
+{
+  ManualCallQueue queue ("ConcurrentBenchmark");
+
+  m_consumed = 0;
+  m_handedOff.set (0);
+  m_samples.clear ();
+  m_samples.reserve (m_options.latencySamples);
+
+  runThreads (
+    1,
+    vf::bind (&ConcurrentBenchmark::produceSamples, this, &queue),
+    vf::bind (&ConcurrentBenchmark::synchronizeUntil, this, &queue,
+              m_options.latencySamples));
+
+  queue.close ();
+
+  std::vector <int64> samples (m_samples);
+  std::sort (samples.begin (), samples.end ());
+
+  int const n = int (samples.size ());
+
+  if (n > 0)
+  {
+    Record ("callqueue.latency")
+      .add ("samples", n)
+      .add ("p50us",  ticksToMicroseconds (samples [jmin (n - 1, n / 2)]))
+      .add ("p99us",  ticksToMicroseconds (samples [jmin (n - 1, int (n * 0.99))]))
+      .add ("p999us", ticksToMicroseconds (samples [jmin (n - 1, int (n * 0.999))]))
+      .add ("maxus",  ticksToMicroseconds (samples [n - 1]))
+      .write (stream);
+  }
+}
+
+// Queues calls to a growing number of listeners on one CallQueue, timing
+// the cost to the caller and the cost of delivery separately.
+//
+void ConcurrentBenchmark::runListeners (OutputStream& stream)
+{
+  for (int count = 1; count <= m_options.maxListeners; count *= 2)
+  {
+    ManualCallQueue queue ("ConcurrentBenchmark");
+    Listeners <Listener> listeners;
+    std::vector <Listener> objects (count);
+
+    for (int i = 0; i < count; ++i)
+      listeners.add (&objects [i], queue);
+
+    queue.synchronize ();
+
+    int64 const startTicks = Time::getHighResolutionTicks ();
+
+    for (int i = 0; i < m_options.listenerCalls; ++i)
+      listeners.queue (&Listener::onEvent, i);
+
+    double const callSeconds = elapsedSeconds (startTicks);
+
+    int64 const deliverTicks = Time::getHighResolutionTicks ();
+
+    queue.synchronize ();
+
+    double const deliverSeconds = elapsedSeconds (deliverTicks);
+
+    for (int i = 0; i < count; ++i)
+      listeners.remove (&objects [i]);
+
+    queue.synchronize ();
+    queue.close ();
+
+    double const calls = m_options.listenerCalls;
+
+    Record ("listeners.fanout")
+      .add ("listeners", count)
+      .add ("calls", m_options.listenerCalls)
+      .add ("callNs", callSeconds * 1e9 / calls)
+      .add ("deliverNs", deliverSeconds * 1e9 / calls)
+      .add ("deliverNsPerListener", deliverSeconds * 1e9 / (calls * count))
+      .write (stream);
+  }
+}
+
+// Times loops whose body does nothing, with one iteration
+// and with one iteration per thread.
+//
+void ConcurrentBenchmark::runParallelFor (OutputStream& stream)
+{
+  ParallelFor parallelFor;
+
+  int const threads = parallelFor.getNumberOfThreads ();
+
+  int const sizes [] = { 1, threads };
+
+  for (int size = (threads > 1) ? 0 : 1; size < 2; ++size)
+  {
+    int const iterations = sizes [size];
+
+    // Wakes the threads up.
+    parallelFor.loop (iterations, &ConcurrentBenchmark::emptyLoopBody);
+
+    int64 const startTicks = Time::getHighResolutionTicks ();
+
+    for (int i = 0; i < m_options.parallelForLoops; ++i)
+      parallelFor.loop (iterations, &ConcurrentBenchmark::emptyLoopBody);
+
+    double const seconds = elapsedSeconds (startTicks);
+
+    Record ("parallelfor.overhead")
+      .add ("threads", threads)
+      .add ("iterations", iterations)
+      .add ("loops", m_options.parallelForLoops)
+      .add ("loopUs", seconds * 1e6 / m_options.parallelForLoops)
+      .write (stream);
+  }
+}
+
+void ConcurrentBenchmark::runFreeStore (OutputStream& stream)
+{
+  for (int threads = 1; threads <= m_options.maxProducers; threads *= 2)
+  {
+    double const seconds = runThreads (
+      threads,
+      vf::bind (&ConcurrentBenchmark::allocateAndFree, this),
+      Body ());
+
+    int const total = threads * m_options.allocationsPerThread;
+
+    Record ("freestore.fifo")
+      .add ("threads", threads)
+      .add ("allocations", total)
+      .add ("seconds", seconds)
+      .add ("allocationsPerSecond", total / seconds)
+      .write (stream);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+double ConcurrentBenchmark::runThreads (int numberOfThreads,
+                                        Body const& body,
+                                        Body const& consumer)
+{
+  OwnedArray <WorkerThread> threads;
+
+  m_start.reset ();
+
+  for (int i = 0; i < numberOfThreads; ++i)
+  {
+    WorkerThread* const thread = new WorkerThread (m_start, body);
+    threads.add (thread);
+    thread->startThread ();
+  }
+
+  int64 const startTicks = Time::getHighResolutionTicks ();
+
+  m_start.signal ();
+
+  // Function::operator() is not const, so call a copy.
+  Body call (consumer);
+  call ();
+
+  for (int i = 0; i < numberOfThreads; ++i)
+    threads [i]->waitForThreadToExit (-1);
+
+  return elapsedSeconds (startTicks);
+}
+
+void ConcurrentBenchmark::produceCalls (CallQueue* callQueue)
+{
+  for (int i = 0; i < m_options.callsPerProducer; ++i)
+    callQueue->call (&ConcurrentBenchmark::consumeCall, this);
+}
+
+void ConcurrentBenchmark::produceSamples (CallQueue* callQueue)
+{
+  for (int i = 0; i < m_options.latencySamples; ++i)
+  {
+    while (m_handedOff.get () != i)
+      Thread::yield ();
+
+    callQueue->call (&ConcurrentBenchmark::sampleLatency, this,
+                     Time::getHighResolutionTicks ());
+  }
+}
+
+void ConcurrentBenchmark::synchronizeUntil (ManualCallQueue* callQueue, int target)
+{
+  while (m_consumed < target)
+  {
+    // Let the producers run if they are sharing this processor.
+    if (!callQueue->synchronize ())
+      Thread::yield ();
+  }
+}
+
+void ConcurrentBenchmark::consumeCall ()
+{
+  ++m_consumed;
+}
+
+void ConcurrentBenchmark::sampleLatency (int64 ticks)
+{
+  m_samples.push_back (Time::getHighResolutionTicks () - ticks);
+
+  ++m_consumed;
+  ++m_handedOff;
+}
+
+void ConcurrentBenchmark::allocateAndFree ()
+{
+  enum
+  {
+    bytes = 64,
+    batch = 16
+  };
+
+  GlobalFifoFreeStore <ConcurrentBenchmark>::Ptr allocator (
+    GlobalFifoFreeStore <ConcurrentBenchmark>::getInstance ());
+
+  void* blocks [batch];
+
+  for (int i = 0; i < m_options.allocationsPerThread; i += batch)
+  {
+    for (int j = 0; j < batch; ++j)
+      blocks [j] = allocator->allocate (bytes);
+
+    for (int j = 0; j < batch; ++j)
+      GlobalFifoFreeStore <ConcurrentBenchmark>::deallocate (blocks [j]);
+  }
+}
+
+void ConcurrentBenchmark::emptyLoopBody (int)
+{
+}
+
+double ConcurrentBenchmark::ticksToMicroseconds (int64 ticks)
+{
+  return Time::highResolutionTicksToSeconds (ticks) * 1000000;
+}
+
+double ConcurrentBenchmark::elapsedSeconds (int64 startTicks)
+{
+  return Time::highResolutionTicksToSeconds (
+    Time::getHighResolutionTicks () - startTicks);
+}
@@ -0,0 +1,158 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_CONCURRENTBENCHMARK_VFHEADER
+#define VF_CONCURRENTBENCHMARK_VFHEADER
+
+/*============================================================================*/
+/**
+  Performance measurements for the concurrent primitives.
+
+  This measures:
+
+  - CallQueue throughput, with 1 to N producer threads feeding one consumer.
+
+  - Hand-off latency percentiles, from the producer calling into a CallQueue
+    to the functor being invoked by synchronize().
+
+  - Listeners fan-out cost as the number of listeners grows.
+
+  - ParallelFor dispatch overhead for an empty loop body.
+
+  - The FIFO free store, allocating and freeing from 1 to N threads.
+
+  Results are written as JSON, one object per line, so that runs can be
+  collected and compared by scripts. Every record has a "benchmark" field
+  naming the measurement. The first record describes the configuration,
+  including the free store selected at compile time, so that results built
+  with different settings can be told apart.
+
+  A console application runs everything with:
+
+  @code
+
+  int main (int, char**)
+  {
+    vf::ConcurrentBenchmark benchmark;
+
+    FileOutputStream stream (File ("benchmark.json"));
+
+    benchmark.run (stream);
+
+    return 0;
+  }
+
+  @endcode
+
+  @ingroup vf_concurrent
+*/
+class ConcurrentBenchmark : Uncopyable
+{
+public:
+  /** Settings for a run.
+  */
+  struct Options
+  {
+    Options ();
+
+    /** Highest number of producer threads. Each test doubles the count
+        from one up to this value. The default is the number of CPUs.
+    */
+    int maxProducers;
+
+    /** Number of calls each producer makes in the throughput test. */
+    int callsPerProducer;
+
+    /** Number of samples taken in the latency test. */
+    int latencySamples;
+
+    /** Highest number of listeners, doubling from one. */
+    int maxListeners;
+
+    /** Number of calls made to the listeners for each listener count. */
+    int listenerCalls;
+
+    /** Number of loops timed in the ParallelFor test. */
+    int parallelForLoops;
+
+    /** Number of allocate and free pairs each thread performs. */
+    int allocationsPerThread;
+  };
+
+  explicit ConcurrentBenchmark (Options const& options = Options ());
+
+  /** Run every benchmark.
+
+      @param stream Receives the results, one JSON object per line.
+  */
+  void run (OutputStream& stream);
+
+  /** Run individual benchmarks.
+  */
+  /** @{ */
+  void runConfiguration (OutputStream& stream);
+  void runThroughput (OutputStream& stream);
+  void runLatency (OutputStream& stream);
+  void runListeners (OutputStream& stream);
+  void runParallelFor (OutputStream& stream);
+  void runFreeStore (OutputStream& stream);
+  /** @} */
+
+private:
+  class Listener;
+  class Record;
+  class WorkerThread;
+
+  typedef Function <void (void)> Body;
+
+  double runThreads (int numberOfThreads, Body const& body, Body const& consumer);
+
+  void produceCalls (CallQueue* callQueue);
+  void produceSamples (CallQueue* callQueue);
+  void synchronizeUntil (ManualCallQueue* callQueue, int target);
+  void consumeCall ();
+  void sampleLatency (int64 ticks);
+  void allocateAndFree ();
+
+  static void emptyLoopBody (int loopIndex);
+  static double ticksToMicroseconds (int64 ticks);
+  static double elapsedSeconds (int64 startTicks);
+
+private:
+  Options const m_options;
+  WaitableEvent m_start;
+  int m_consumed;
+  Atomic <int> m_handedOff;
+  std::vector <int64> m_samples;
+};
+
+#endif
@@ -30,8 +30,131 @@
 */
 /*============================================================================*/
 
+#if VF_USE_METRICS
+class CallQueue::QueueMetrics : public Metrics::Source
+{
+public:
+  explicit QueueMetrics (String const& name)
+    : m_name (name)
+    , m_batchSize (0)
+  {
+    Metrics::add (this);
+  }
+
+  ~QueueMetrics ()
+  {
+    Metrics::remove (this);
+  }
+
+  // Called by producers.
+  //
+  void onQueued (Work* work)
+  {
+    if (Metrics::isEnabled ())
+    {
+      work->m_queuedTicks = Time::getHighResolutionTicks ();
+
+      int64 const depth = ++m_depth;
+
+      for (;;)
+      {
+        int64 const maxDepth = m_maxDepth.get ();
+
+        if (depth <= maxDepth || m_maxDepth.compareAndSetBool (depth, maxDepth))
+          break;
+      }
+    }
+  }
+
+  // The rest are called on the associated thread.
+  //
+  int64 onBegin ()
+  {
+    return Metrics::isEnabled () ? Time::getHighResolutionTicks () : 0;
+  }
+
+  void onEnd (Work* work, int64 startTicks)
+  {
+    // Only functors counted when they were queued are counted here,
+    // so the depth stays right when metrics are switched on or off.
+    //
+    if (work->m_queuedTicks != 0)
+    {
+      --m_depth;
+
+      if (startTicks != 0)
+        m_latency.record (toMicroseconds (startTicks - work->m_queuedTicks));
+    }
+
+    if (startTicks != 0)
+    {
+      int64 const micros = toMicroseconds (Time::getHighResolutionTicks () - startTicks);
+
+      m_execution.record (micros);
+
+      if (micros > m_slowestMicros.get ())
+      {
+        m_slowestName.set (typeid (*work).name ());
+        m_slowestMicros.set (micros);
+      }
+
+      ++m_batchSize;
+    }
+  }
+
+  void onSynchronized ()
+  {
+    if (m_batchSize > 0)
+    {
+      m_batches.record (m_batchSize);
+      m_batchSize = 0;
+    }
+  }
+
+  void addReports (Metrics::Snapshot& snapshot)
+  {
+    Metrics::Report& report = snapshot.add ("CallQueue", m_name);
+
+    char const* const slowestName = m_slowestName.get ();
+
+    report.addValue ("depth", m_depth.get ());
+    report.addValue ("maxDepth", m_maxDepth.get ());
+    report.addHistogram ("latencyUs", m_latency);
+    report.addHistogram ("executeUs", m_execution);
+    report.addHistogram ("batchSize", m_batches);
+    report.addText ("slowestFunctor", slowestName != nullptr ? slowestName : "");
+    report.addValue ("slowestUs", m_slowestMicros.get ());
+  }
+
+private:
+  static int64 toMicroseconds (int64 ticks)
+  {
+    return int64 (Time::highResolutionTicksToSeconds (ticks) * 1000000);
+  }
+
+  String const m_name;
+  Atomic <int64> m_depth;
+  Atomic <int64> m_maxDepth;
+  Metrics::Histogram m_latency;
+  Metrics::Histogram m_execution;
+  Metrics::Histogram m_batches;
+  AtomicPointer <char const> m_slowestName;
+  Atomic <int64> m_slowestMicros;
+  int m_batchSize;
+};
+#endif
+
+//------------------------------------------------------------------------------
+
 CallQueue::CallQueue (String name)
   : m_name (name)
+#if VF_USE_TRACING
+  , m_traceName (Trace::intern (name))
+#endif
+  , m_timedSequence (0)
+#if VF_USE_METRICS
+  , m_metrics (new QueueMetrics (name))
+#endif
 {
 }
 
@@ -42,6 +165,12 @@ CallQueue::~CallQueue ()
 
   // Can't destroy queue with unprocessed calls.
   jassert (m_queue.empty ());
+
+  // Timed calls that never became due are discarded.
+  addTimedWork ();
+
+  for (std::size_t i = 0; i < m_timedHeap.size (); ++i)
+    delete m_timedHeap [i];
 }
 
 bool CallQueue::isAssociatedWithCurrentThread () const
@@ -57,6 +186,10 @@ void CallQueue::queuep (Work* c)
   // process it.
   jassert (!m_closed.isSignaled ());
 
+#if VF_USE_METRICS
+  m_metrics->onQueued (c);
+#endif
+
   if (m_queue.push_back (c))
     signal ();
 }
@@ -89,6 +222,56 @@ void CallQueue::callp (Work* c)
   }
 }
 
+// Timed calls go through their own queue so that producers stay
+// wait-free. The associated thread moves them into the heap.
+//
+void CallQueue::callAtp (Time deadline, TimedWork* c)
+{
+  int64 const delay = deadline.toMilliseconds () - Time::currentTimeMillis ();
+
+  callAfterp (int (jlimit (int64 (0), int64 (std::numeric_limits <int>::max ()), delay)), c);
+}
+
+void CallQueue::callAfterp (int delayMilliseconds, TimedWork* c)
+{
+  jassert (!m_closed.isSignaled ());
+
+  c->m_deadline = getTicks () + jmax (0, delayMilliseconds);
+
+  // Signaling lets the associated thread pick up a deadline
+  // which may be earlier than the one it is waiting for.
+  //
+  if (m_timedQueue.push_back (c))
+    signal ();
+}
+
+#if VF_USE_COROUTINES
+void CallQueue::ResumeOnAwaiter::await_suspend (std::coroutine_handle <> handle)
+{
+  m_queue.queuep (new (m_queue.getAllocator ()) ResumeWork (handle));
+}
+#endif
+
+int CallQueue::getMillisecondsUntilNextDeadline ()
+{
+  int milliseconds;
+
+  addTimedWork ();
+
+  if (!m_timedHeap.empty ())
+  {
+    int64 const delta = m_timedHeap.front ()->m_deadline - getTicks ();
+
+    milliseconds = int (jlimit (int64 (0), int64 (std::numeric_limits <int>::max ()), delta));
+  }
+  else
+  {
+    milliseconds = -1;
+  }
+
+  return milliseconds;
+}
+
 bool CallQueue::synchronize ()
 {
   bool did_something;
@@ -121,6 +304,76 @@ void CallQueue::close ()
   synchronize ();
 }
 
+int64 CallQueue::getTicks ()
+{
+  return int64 (Time::getMillisecondCounterHiRes ());
+}
+
+// Call a functor and free it.
+//
+void CallQueue::invoke (Work* call)
+{
+  VF_TRACE_SCOPE (typeid (*call).name ());
+
+#if VF_USE_METRICS
+  int64 const startTicks = m_metrics->onBegin ();
+#endif
+
+  call->operator() ();
+
+#if VF_USE_METRICS
+  m_metrics->onEnd (call, startTicks);
+#endif
+
+  delete call;
+}
+
+// Move newly added timed calls into the heap. The sequence number
+// keeps calls with equal deadlines in the order they were added.
+//
+void CallQueue::addTimedWork ()
+{
+  for (;;)
+  {
+    TimedWork* const call = static_cast <TimedWork*> (m_timedQueue.pop_front ());
+
+    if (call == 0)
+      break;
+
+    call->m_sequence = ++m_timedSequence;
+
+    m_timedHeap.push_back (call);
+    std::push_heap (m_timedHeap.begin (), m_timedHeap.end (), LaterDeadline ());
+  }
+}
+
+// Call every timed call whose deadline has passed.
+//
+// Returns true if any functors were called.
+//
+bool CallQueue::doTimedWork ()
+{
+  bool did_something = false;
+
+  addTimedWork ();
+
+  int64 const now = getTicks ();
+
+  while (!m_timedHeap.empty () && m_timedHeap.front ()->m_deadline <= now)
+  {
+    TimedWork* const call = m_timedHeap.front ();
+
+    std::pop_heap (m_timedHeap.begin (), m_timedHeap.end (), LaterDeadline ());
+    m_timedHeap.pop_back ();
+
+    did_something = true;
+
+    invoke (call);
+  }
+
+  return did_something;
+}
+
 // Process everything in the queue. The list of pending calls is
 // acquired atomically. New calls may enter the queue while we are
 // processing.
@@ -129,6 +382,8 @@ void CallQueue::close ()
 //
 bool CallQueue::doSynchronize ()
 {
+  VF_TRACE_SCOPE (m_traceName);
+
   bool did_something;
 
   // Reset since we are emptying the queue. Since we loop
@@ -137,29 +392,50 @@ bool CallQueue::doSynchronize ()
   //
   reset ();
 
-  Work* call = m_queue.pop_front ();
+  did_something = false;
+
+  // Timed calls which become due can queue more calls, so the
+  // queue is emptied once more afterwards. Timed calls are only
+  // checked once, otherwise a functor that keeps adding itself
+  // with no delay would never let synchronize() return.
+  //
+  bool checkedTimedWork = false;
 
-  if (call)
+  for (;;)
   {
-    did_something = true;
+    Work* call = m_queue.pop_front ();
 
-    // This method of processing one at a time has the desired
-    // side effect of synchronizing nested calls to us from a functor.
-    //
-    for (;;)
+    if (call)
     {
-      call->operator() ();
-      delete call;
+      did_something = true;
+
+      // This method of processing one at a time has the desired
+      // side effect of synchronizing nested calls to us from a functor.
+      //
+      for (;;)
+      {
+        invoke (call);
 
-      call = m_queue.pop_front ();
-      if (call == 0)
-        break;
+        call = m_queue.pop_front ();
+        if (call == 0)
+          break;
+      }
     }
+
+    if (checkedTimedWork)
+      break;
+
+    checkedTimedWork = true;
+
+    if (doTimedWork ())
+      did_something = true;
+    else
+      break;
   }
-  else
-  {
-    did_something = false;
-  }
+
+#if VF_USE_METRICS
+  m_metrics->onSynchronized ();
+#endif
 
   return did_something;
 }
@@ -33,6 +33,9 @@
 #ifndef VF_CALLQUEUE_VFHEADER
 #define VF_CALLQUEUE_VFHEADER
 
+template <class T>
+class Future;
+
 /*============================================================================*/
 /**
   A FIFO for calling functors asynchronously.
@@ -140,6 +143,11 @@
   producers and mostly wait-free for consumers. It also uses a lock-free
   and wait-free (in the fast path) custom memory allocator.
 
+  When VF_USE_METRICS is set, every CallQueue reports to Metrics under the
+  kind "CallQueue": the current and maximum number of queued functors, the
+  time from queueing to execution and of execution itself, the number of
+  functors called per synchronize(), and the slowest functor type seen.
+
   @see GuiCallQueue, ManualCallQueue, MessageThread, ThreadWithCallQueue
 
   @ingroup vf_concurrent
@@ -164,6 +172,10 @@ public:
                public AllocatedBy <AllocatorType>
   {
   public:
+#if VF_USE_METRICS
+    Work () : m_queuedTicks (0) { }
+#endif
+
     virtual ~Work () { }
 
     /** Calls the functor.
@@ -171,6 +183,26 @@ public:
         This executes during the queue's call to synchronize().
     */
     virtual void operator() () = 0;
+
+#if VF_USE_METRICS
+  private:
+    friend class CallQueue;
+
+    int64 m_queuedTicks;
+#endif
+  };
+
+  /** Abstract nullary functor with a deadline in a @ref CallQueue.
+
+      @see callAt, callAfter
+  */
+  class TimedWork : public Work
+  {
+  private:
+    friend class CallQueue;
+
+    int64 m_deadline;
+    uint64 m_sequence;
   };
 
   //============================================================================
@@ -204,11 +236,20 @@ public:
 
       @see call
   */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void callf (Functor&& f)
+  {
+    callp (new (m_allocator) CallType <typename std::decay <Functor>::type> (
+      std::forward <Functor> (f)));
+  }
+#else
   template <class Functor>
   void callf (Functor const& f)
   {
     callp (new (m_allocator) CallType <Functor> (f));
   }
+#endif
 
   /** Add a function call and possibly synchronize.
 
@@ -217,6 +258,10 @@ public:
       associated with the CallQueue, synchronize() is called automatically. This
       behavior can be avoided by using queue() instead.
 
+      When the compiler supports variadic templates, any number of parameters
+      may be given. Each one is moved or copied exactly once, directly into
+      the Work allocated from the queue's FifoFreeStore.
+
       @param f The function to call followed by up to eight parameters,
                evaluated immediately. The parameter list must match the function
       signature. For class member functions, the first argument must be a
@@ -226,6 +271,14 @@ public:
 
       @todo Provide an example of when synchronize() is needed in call().
   */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Fn, class... Args>
+  void call (Fn&& f, Args&&... args)
+  {
+    callp (new (m_allocator) CallType <BoundCall <Fn, Args...> > (
+      std::forward <Fn> (f), std::forward <Args> (args)...));
+  }
+#else
   /** @{ */
   template <class Fn>
   void call (Fn f)
@@ -281,6 +334,7 @@ public:
     callf (vf::bind (f, t1, t2, t3, t4, t5, t6, t7, t8));
   }
   /** @} */
+#endif
 
   /** Add a functor without synchronizing.
 
@@ -291,11 +345,20 @@ public:
 
       @see queue
   */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void queuef (Functor&& f)
+  {
+    queuep (new (m_allocator) CallType <typename std::decay <Functor>::type> (
+      std::forward <Functor> (f)));
+  }
+#else
   template <class Functor>
   void queuef (Functor f)
   {
     queuep (new (m_allocator) CallType <Functor> (f));
   }
+#endif
 
   /** Add a function call without synchronizing.
 
@@ -340,6 +403,14 @@ public:
 
       @see call
   */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Fn, class... Args>
+  void queue (Fn&& f, Args&&... args)
+  {
+    queuep (new (m_allocator) CallType <BoundCall <Fn, Args...> > (
+      std::forward <Fn> (f), std::forward <Args> (args)...));
+  }
+#else
   /** @{ */
   template <class Fn>
   void queue (Fn f)
@@ -395,6 +466,156 @@ public:
     queuef (vf::bind (f, t1, t2, t3, t4, t5, t6, t7, t8));
   }
   /** @} */
+#endif
+
+  //============================================================================
+
+  /** Add a functor to be called at or after a deadline.
+
+      The functor is held by the queue until the deadline passes, and then
+      called from the next synchronize(). Timed functors never execute
+      synchronously from within this function, even when called from the
+      associated thread. Functors with equal deadlines execute in the order
+      they were added.
+
+      Timed functors whose deadline has not passed when the queue is destroyed
+      are deleted without being called.
+
+      With C++11 the functor is moved into the queue when possible, so a
+      functor which can't be copied, such as a UniqueFunction, may be used.
+
+      @param deadline The earliest time at which to call the functor.
+
+      @param f The functor to call, typically the return value of a call
+               to bind().
+
+      @see callAfter
+  */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void callAt (Time deadline, Functor&& f)
+  {
+    callAtp (deadline, new (m_allocator) TimedCallType <typename std::decay <Functor>::type> (
+      std::forward <Functor> (f)));
+  }
+#else
+  template <class Functor>
+  void callAt (Time deadline, Functor const& f)
+  {
+    callAtp (deadline, new (m_allocator) TimedCallType <Functor> (f));
+  }
+#endif
+
+  /** Add a functor to be called after a delay.
+
+      This is the same as callAt(), except that the deadline is expressed
+      relative to the current time.
+
+      @param delayMilliseconds The minimum number of milliseconds to wait
+                               before calling the functor.
+
+      @param f The functor to call, typically the return value of a call
+               to bind().
+
+      @see callAt
+  */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void callAfter (int delayMilliseconds, Functor&& f)
+  {
+    callAfterp (delayMilliseconds,
+      new (m_allocator) TimedCallType <typename std::decay <Functor>::type> (
+        std::forward <Functor> (f)));
+  }
+#else
+  template <class Functor>
+  void callAfter (int delayMilliseconds, Functor const& f)
+  {
+    callAfterp (delayMilliseconds, new (m_allocator) TimedCallType <Functor> (f));
+  }
+#endif
+
+  //============================================================================
+
+  /** Add a functor and retrieve its result later.
+
+      This works like callf(), but the return value of the functor is made
+      available through the returned Future. A continuation attached with
+      Future::then() can deliver the result to another CallQueue without
+      writing a second functor by hand.
+
+      @param f The functor to call, typically the return value of a call
+               to bind(). It must expose `result_type`.
+
+      @return A future which becomes ready after the functor is called.
+
+      @see Future
+  */
+  template <class Functor>
+  Future <typename Functor::result_type> callResult (Functor const& f);
+
+#if VF_USE_COROUTINES
+  //============================================================================
+
+  /** Awaitable which resumes a coroutine on a CallQueue.
+
+      @see resumeOn
+  */
+  class ResumeOnAwaiter
+  {
+  public:
+    explicit ResumeOnAwaiter (CallQueue& queue) : m_queue (queue)
+    {
+    }
+
+    bool await_ready () const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend (std::coroutine_handle <> handle);
+
+    void await_resume () const noexcept
+    {
+    }
+
+  private:
+    CallQueue& m_queue;
+  };
+
+  /** Continue a coroutine on this queue.
+
+      The coroutine is suspended, and resumed from the next synchronize() of
+      this queue, on the associated thread:
+
+      @code
+
+      CoroutineTask loadAndShow (ThreadWithCallQueue& io, GuiCallQueue& gui)
+      {
+        co_await io.resumeOn ();
+
+        String text = loadText ();
+
+        co_await gui.resumeOn ();
+
+        showText (text);
+      }
+
+      @endcode
+
+      The coroutine is always suspended, even if the caller is already on
+      the associated thread. Only one Work is allocated from the queue's
+      allocator for each switch.
+
+      @note This is only available when VF_USE_COROUTINES is set.
+
+      @see CoroutineTask
+  */
+  ResumeOnAwaiter resumeOn ()
+  {
+    return ResumeOnAwaiter (*this);
+  }
+#endif
 
 protected:
   //============================================================================
@@ -439,6 +660,20 @@ protected:
   */
   virtual void reset () = 0;
 
+  /** Determine when the earliest timed functor becomes due.
+
+      Derived classes use this to decide how long they may wait before
+      synchronizing the queue again. A timed functor added from another thread
+      signals the queue, so the value is only meaningful until the next signal.
+
+      @note This must be called from the associated thread.
+
+      @return The number of milliseconds until the earliest timed functor is
+              due, zero if it is already due, or -1 if there are no timed
+              functors in the queue.
+  */
+  int getMillisecondsUntilNextDeadline ();
+
 public:
   //============================================================================
 
@@ -460,6 +695,26 @@ public:
   */
   void queuep (Work* c);
 
+  /** Add a raw timed call.
+
+      @internal
+
+      @param deadline The earliest time at which to call the functor.
+
+      @param c The call to add. The memory must come from the allocator.
+  */
+  void callAtp (Time deadline, TimedWork* c);
+
+  /** Add a raw delayed call.
+
+      @internal
+
+      @param delayMilliseconds The minimum delay before calling the functor.
+
+      @param c The call to add. The memory must come from the allocator.
+  */
+  void callAfterp (int delayMilliseconds, TimedWork* c);
+
   /** Retrieve the allocator.
 
       @return The allocator to use when allocating a raw Work object.      
@@ -487,27 +742,97 @@ public:
   */
   bool isBeingSynchronized () const { return m_isBeingSynchronized.isSignaled(); }
 
+  /** See if the queue has been closed.
+
+      No calls may be added to a closed queue.
+
+      @return `true` if close() was called.
+  */
+  bool isClosed () const { return m_closed.isSignaled (); }
+
 private:
   template <class Functor>
   class CallType : public Work
   {
   public:
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+    // Constructs the functor in place from the arguments.
+    template <class... Args>
+    explicit CallType (Args&&... args) : m_f (std::forward <Args> (args)...) { }
+#else
     explicit CallType (Functor const& f) : m_f (f) { }
+#endif
+    void operator() () { m_f (); }
+
+  private:
+    Functor m_f;
+  };
+
+#if VF_USE_COROUTINES
+  class ResumeWork : public Work
+  {
+  public:
+    explicit ResumeWork (std::coroutine_handle <> handle) : m_handle (handle) { }
+    void operator() () { m_handle.resume (); }
+
+  private:
+    std::coroutine_handle <> m_handle;
+  };
+#endif
+
+  template <class Functor>
+  class TimedCallType : public TimedWork
+  {
+  public:
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+    template <class Arg>
+    explicit TimedCallType (Arg&& f) : m_f (std::forward <Arg> (f)) { }
+#else
+    explicit TimedCallType (Functor const& f) : m_f (f) { }
+#endif
     void operator() () { m_f (); }
 
   private:
     Functor m_f;
   };
 
+  struct LaterDeadline
+  {
+    bool operator() (TimedWork const* lhs, TimedWork const* rhs) const
+    {
+      if (lhs->m_deadline != rhs->m_deadline)
+        return lhs->m_deadline > rhs->m_deadline;
+
+      return lhs->m_sequence > rhs->m_sequence;
+    }
+  };
+
+  static int64 getTicks ();
+  void invoke (Work* call);
+  void addTimedWork ();
+  bool doTimedWork ();
   bool doSynchronize ();
 
+#if VF_USE_METRICS
+  class QueueMetrics;
+#endif
+
 private:
   String const m_name;
+#if VF_USE_TRACING
+  char const* const m_traceName;
+#endif
   Thread::ThreadID m_id;
   LockFreeQueue <Work> m_queue;
+  LockFreeQueue <Work> m_timedQueue;
+  std::vector <TimedWork*> m_timedHeap;
+  uint64 m_timedSequence;
   AtomicFlag m_closed;
   AtomicFlag m_isBeingSynchronized;
   AllocatorType m_allocator;
+#if VF_USE_METRICS
+  ScopedPointer <QueueMetrics> m_metrics;
+#endif
 };
 
 #endif
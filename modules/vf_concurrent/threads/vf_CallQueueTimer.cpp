@@ -0,0 +1,158 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+// Shared between the timer and the functors in the CallQueue, so that
+// a pending expiration can outlive the timer that produced it.
+//
+class CallQueueTimer::State : public ReferenceCountedObject
+{
+public:
+  typedef ReferenceCountedObjectPtr <State> Ptr;
+
+  explicit State (callback_t const& callback)
+    : m_callback (callback)
+    , m_generation (0)
+    , m_pending (0)
+  {
+  }
+
+  // Invalidate all expirations currently in the queue.
+  void invalidate ()
+  {
+    ++m_generation;
+    m_pending.set (0);
+  }
+
+  int getGeneration () const
+  {
+    return m_generation.get ();
+  }
+
+  // Returns true if the caller should put an expiration in the queue.
+  bool trySetPending ()
+  {
+    return m_pending.compareAndSetBool (1, 0);
+  }
+
+  void fire (int generation)
+  {
+    if (generation == m_generation.get ())
+    {
+      m_pending.set (0);
+
+      m_callback ();
+    }
+  }
+
+private:
+  callback_t m_callback;
+  Atomic <int> m_generation;
+  Atomic <int> m_pending;
+};
+
+//------------------------------------------------------------------------------
+
+// CallQueue item for one expiration.
+// This is used to avoid bind overhead.
+//
+class CallQueueTimer::Work : public CallQueue::Work
+{
+public:
+  Work (State* state, int generation)
+    : m_state (state)
+    , m_generation (generation)
+  {
+  }
+
+  void operator() ()
+  {
+    m_state->fire (m_generation);
+  }
+
+private:
+  State::Ptr m_state;
+  int const m_generation;
+};
+
+//------------------------------------------------------------------------------
+
+CallQueueTimer::CallQueueTimer (CallQueue& callQueue, callback_t const& callback)
+  : m_callQueue (callQueue)
+  , m_state (new State (callback))
+{
+}
+
+CallQueueTimer::~CallQueueTimer ()
+{
+  cancelTimer ();
+}
+
+void CallQueueTimer::startTimer (int delayMilliSeconds, int periodMilliSeconds)
+{
+  TimerWheel::Timer::cancelTimer ();
+
+  m_state->invalidate ();
+
+  TimerWheel::Timer::startTimer (delayMilliSeconds, periodMilliSeconds);
+}
+
+void CallQueueTimer::startTimerAt (Time deadline, int periodMilliSeconds)
+{
+  TimerWheel::Timer::cancelTimer ();
+
+  m_state->invalidate ();
+
+  TimerWheel::Timer::startTimerAt (deadline, periodMilliSeconds);
+}
+
+void CallQueueTimer::cancelTimer ()
+{
+  TimerWheel::Timer::cancelTimer ();
+
+  m_state->invalidate ();
+}
+
+bool CallQueueTimer::isTimerRunning () const
+{
+  return TimerWheel::Timer::isTimerRunning ();
+}
+
+// Called on the TimerWheel thread.
+//
+void CallQueueTimer::onTimerExpired ()
+{
+  if (m_state->trySetPending ())
+  {
+    m_callQueue.queuep (new (m_callQueue.getAllocator ()) Work (
+      m_state, m_state->getGeneration ()));
+  }
+}
@@ -0,0 +1,143 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_CALLQUEUETIMER_VFHEADER
+#define VF_CALLQUEUETIMER_VFHEADER
+
+/*============================================================================*/
+/**
+  A timer which delivers its callback through a CallQueue.
+
+  The timer is serviced by the TimerWheel, but instead of running the callback
+  on the wheel's thread, a functor is queued on the chosen CallQueue when the
+  timer expires. The callback therefore executes during the queue's call to
+  synchronize(), on the thread associated with the queue, and a slow callback
+  does not delay any other timers.
+
+  If a repeating timer expires again before the previous expiration has been
+  processed by the queue, the expirations are coalesced so that a queue which
+  is falling behind does not accumulate a backlog.
+
+  @code
+
+  struct Meter
+  {
+    Meter (CallQueue& callQueue)
+      : m_timer (callQueue, vf::bind (&Meter::onRefresh, this))
+    {
+      m_timer.startTimer (0, 40); // 25 times a second
+    }
+
+    void onRefresh ()
+    {
+      // (runs on the thread associated with callQueue)
+    }
+
+    CallQueueTimer m_timer;
+  };
+
+  @endcode
+
+  @note The timer should be destroyed or cancelled from the thread associated
+        with the CallQueue. Calls which are still pending in the queue after
+        cancelTimer() returns are discarded.
+
+  @see CallQueue, TimerWheel
+
+  @ingroup vf_concurrent
+*/
+class CallQueueTimer : private TimerWheel::Timer
+{
+public:
+  typedef Function <void (void)> callback_t;
+
+  /** Create a timer.
+
+      The timer is initially stopped.
+
+      @param callQueue The CallQueue on which to make the callback.
+
+      @param callback  The functor to call when the timer expires.
+  */
+  CallQueueTimer (CallQueue& callQueue, callback_t const& callback);
+
+  /** Destroy the timer.
+
+      The timer is cancelled.
+  */
+  ~CallQueueTimer ();
+
+  /** Start the timer.
+
+      If the timer is already running it is restarted with the new values, and
+      any expirations which have not been processed yet are discarded.
+
+      @param delayMilliSeconds  The time until the first expiration.
+
+      @param periodMilliSeconds The time between subsequent expirations, or
+                                zero for a one-shot timer.
+  */
+  void startTimer (int delayMilliSeconds, int periodMilliSeconds = 0);
+
+  /** Start the timer with an absolute deadline.
+
+      @param deadline           The time of the first expiration.
+
+      @param periodMilliSeconds The time between subsequent expirations, or
+                                zero for a one-shot timer.
+  */
+  void startTimerAt (Time deadline, int periodMilliSeconds = 0);
+
+  /** Cancel the timer.
+
+      Expirations which were already queued but not yet processed are discarded.
+  */
+  void cancelTimer ();
+
+  /** Determine if the timer is running.
+
+      @return `true` if the timer will expire in the future.
+  */
+  bool isTimerRunning () const;
+
+private:
+  class State;
+  class Work;
+
+  void onTimerExpired ();
+
+private:
+  CallQueue& m_callQueue;
+  ReferenceCountedObjectPtr <State> m_state;
+};
+
+#endif
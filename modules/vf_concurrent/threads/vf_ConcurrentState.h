@@ -178,6 +178,48 @@ public:
     : m_obj (t1, t2, t3, t4, t5, t6, t7, t8) { }
   /** @} */
 
+  /** Create a concurrent state whose lock reports contention.
+
+      The lock is named for LockMetrics. Up to 8 further parameters are
+      forwarded to the constructor of Object.
+  */
+  /** @{ */
+  explicit ConcurrentState (LockName const& name)
+    : m_mutex (name.get ()) { }
+
+  template <class T1>
+  ConcurrentState (LockName const& name, T1 t1)
+    : m_obj (t1), m_mutex (name.get ()) { }
+
+  template <class T1, class T2>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2)
+    : m_obj (t1, t2), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3)
+    : m_obj (t1, t2, t3), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3, class T4>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3, T4 t4)
+    : m_obj (t1, t2, t3, t4), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3, class T4, class T5>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3, T4 t4, T5 t5)
+    : m_obj (t1, t2, t3, t4, t5), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3, class T4, class T5, class T6>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3, T4 t4, T5 t5, T6 t6)
+    : m_obj (t1, t2, t3, t4, t5, t6), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3, class T4, class T5, class T6, class T7>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3, T4 t4, T5 t5, T6 t6, T7 t7)
+    : m_obj (t1, t2, t3, t4, t5, t6, t7), m_mutex (name.get ()) { }
+
+  template <class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8>
+  ConcurrentState (LockName const& name, T1 t1, T2 t2, T3 t3, T4 t4, T5 t5, T6 t6, T7 t7, T8 t8)
+    : m_obj (t1, t2, t3, t4, t5, t6, t7, t8), m_mutex (name.get ()) { }
+  /** @} */
+
 private:
   typedef ReadWriteMutex ReadWriteMutexType;
 
@@ -0,0 +1,108 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_COROUTINETASK_VFHEADER
+#define VF_COROUTINETASK_VFHEADER
+
+#if VF_USE_COROUTINES
+
+/*============================================================================*/
+/**
+  Return type for a fire-and-forget coroutine.
+
+  A function returning CoroutineTask can use `co_await` with
+  CallQueue::resumeOn() and ThreadGroup::schedule() to move between threads.
+  The coroutine starts running immediately in the caller, and its frame is
+  destroyed when it finishes.
+
+  Coroutine frames are allocated from a FifoFreeStore, which suits the usual
+  pattern of short lived coroutines that finish in roughly the order they
+  were started. A frame cannot be larger than a page of the underlying
+  PagedFreeStore.
+
+  There is nobody to report an exception to, so an exception escaping from
+  the coroutine terminates the application.
+
+  @note This is only available when VF_USE_COROUTINES is set.
+
+  @ingroup vf_concurrent
+*/
+class CoroutineTask
+{
+public:
+  typedef GlobalFifoFreeStore <CoroutineTask> AllocatorType;
+
+  class promise_type
+  {
+  public:
+    static void* operator new (std::size_t bytes)
+    {
+      return AllocatorType::getInstance ()->allocate (bytes);
+    }
+
+    static void operator delete (void* p) noexcept
+    {
+      AllocatorType::deallocate (p);
+    }
+
+    CoroutineTask get_return_object () const noexcept
+    {
+      return CoroutineTask ();
+    }
+
+    std::suspend_never initial_suspend () const noexcept
+    {
+      return std::suspend_never ();
+    }
+
+    std::suspend_never final_suspend () const noexcept
+    {
+      return std::suspend_never ();
+    }
+
+    void return_void () const noexcept
+    {
+    }
+
+    void unhandled_exception () const noexcept
+    {
+      // If this goes off it means an exception escaped from the coroutine.
+      jassertfalse;
+
+      std::terminate ();
+    }
+  };
+};
+
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+FutureBase::State::State ()
+  : m_continuations (nullptr)
+{
+}
+
+FutureBase::State::~State ()
+{
+  Continuation* c = m_continuations;
+
+  while (c != nullptr)
+  {
+    Continuation* const next = c->m_next;
+
+    delete c;
+
+    c = next;
+  }
+}
+
+bool FutureBase::State::isReady () const
+{
+  return m_ready.isSignaled ();
+}
+
+void FutureBase::State::addContinuation (Continuation* c)
+{
+  bool ready;
+
+  {
+    SpinLock::ScopedLockType lock (m_mutex);
+
+    ready = m_ready.isSignaled ();
+
+    if (!ready)
+    {
+      c->m_next = m_continuations;
+      m_continuations = c;
+    }
+  }
+
+  if (ready)
+    c->onReady ();
+}
+
+void FutureBase::State::setReady ()
+{
+  Continuation* list;
+
+  {
+    SpinLock::ScopedLockType lock (m_mutex);
+
+    // Can only become ready once.
+    jassert (!m_ready.isSignaled ());
+
+    m_ready.signal ();
+
+    list = m_continuations;
+    m_continuations = nullptr;
+  }
+
+  // Continuations were pushed in reverse order.
+  Continuation* c = nullptr;
+
+  while (list != nullptr)
+  {
+    Continuation* const next = list->m_next;
+    list->m_next = c;
+    c = list;
+    list = next;
+  }
+
+  while (c != nullptr)
+  {
+    // The continuation may delete itself.
+    Continuation* const next = c->m_next;
+
+    c->onReady ();
+
+    c = next;
+  }
+}
+
+FutureBase::AllocatorType& FutureBase::getAllocator ()
+{
+  return *AllocatorType::getInstance ();
+}
@@ -0,0 +1,581 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_FUTURE_VFHEADER
+#define VF_FUTURE_VFHEADER
+
+/*============================================================================*/
+/**
+  Shared implementation for Future.
+
+  @internal
+
+  @ingroup vf_concurrent
+*/
+class FutureBase
+{
+public:
+  typedef GlobalFifoFreeStore <FutureBase> AllocatorType;
+
+  /** Something waiting for a State to become ready.
+  */
+  class Continuation
+  {
+  public:
+    Continuation () : m_next (nullptr) { }
+
+    virtual ~Continuation () { }
+
+    /** Called exactly once when the state becomes ready.
+
+        This happens on the thread that made the state ready, or from
+        addContinuation() if the state was already ready. The continuation
+        may delete itself.
+    */
+    virtual void onReady () = 0;
+
+  private:
+    friend class FutureBase;
+
+    Continuation* m_next;
+  };
+
+  /** Reference counted state shared between a Future and its producer.
+  */
+  class State
+    : public ReferenceCountedObject
+    , public AllocatedBy <AllocatorType>
+  {
+  public:
+    State ();
+
+    /** Continuations which never ran are deleted.
+    */
+    ~State ();
+
+    bool isReady () const;
+
+    /** Add a continuation.
+
+        Ownership passes to the state.
+    */
+    void addContinuation (Continuation* c);
+
+  protected:
+    void setReady ();
+
+  private:
+    SpinLock m_mutex;
+    AtomicFlag m_ready;
+    Continuation* m_continuations;
+  };
+
+  /** Retrieve the allocator used for states and combinators.
+  */
+  static AllocatorType& getAllocator ();
+};
+
+//------------------------------------------------------------------------------
+
+/** Storage for the result of a Future.
+
+    @internal
+*/
+template <class T>
+class FutureState : public FutureBase::State
+{
+public:
+  typedef T const& reference;
+
+  reference getValue () const
+  {
+    jassert (isReady ());
+
+    return m_value;
+  }
+
+  void setValue (T const& value)
+  {
+    m_value = value;
+
+    setReady ();
+  }
+
+  template <class Functor>
+  void evaluate (Functor& f)
+  {
+    m_value = f ();
+
+    setReady ();
+  }
+
+private:
+  T m_value;
+};
+
+template <>
+class FutureState <void> : public FutureBase::State
+{
+public:
+  typedef void reference;
+
+  void getValue () const
+  {
+    jassert (isReady ());
+  }
+
+  void setValue ()
+  {
+    setReady ();
+  }
+
+  template <class Functor>
+  void evaluate (Functor& f)
+  {
+    f ();
+
+    setReady ();
+  }
+};
+
+//------------------------------------------------------------------------------
+
+/** Adapts a continuation into a nullary functor.
+
+    @internal
+*/
+template <class T, class Functor>
+class FutureCall
+{
+public:
+  typedef typename Functor::result_type result_type;
+
+  FutureCall (Functor& f, FutureState <T>& state) : m_f (f), m_state (state) { }
+
+  result_type operator() () { return m_f (m_state.getValue ()); }
+
+private:
+  Functor& m_f;
+  FutureState <T>& m_state;
+};
+
+template <class Functor>
+class FutureCall <void, Functor>
+{
+public:
+  typedef typename Functor::result_type result_type;
+
+  FutureCall (Functor& f, FutureState <void>&) : m_f (f) { }
+
+  result_type operator() () { return m_f (); }
+
+private:
+  Functor& m_f;
+};
+
+/*============================================================================*/
+/**
+  The eventual result of a functor called on a CallQueue.
+
+  A Future is returned by CallQueue::callResult(). It becomes ready once the
+  functor has executed, and then holds the return value. Instead of polling,
+  a continuation is attached with then(), which calls a functor with the
+  value on a chosen CallQueue and returns another Future for its result:
+
+  @code
+
+  int computeAnswer ();
+  String formatAnswer (int answer);
+  void showAnswer (String text);
+
+  void example (CallQueue& worker, CallQueue& gui)
+  {
+    worker.callResult (vf::bind (&computeAnswer))
+      .then (worker, vf::bind (&formatAnswer, _1))
+      .then (gui, vf::bind (&showAnswer, _1));
+  }
+
+  @endcode
+
+  Future objects are cheap to copy, all copies refer to the same result. The
+  shared state is allocated from a FifoFreeStore, and each continuation
+  is allocated from the allocator of the CallQueue it runs on.
+
+  Functors must expose `result_type`, as the return value of bind() does. A
+  functor returning `void` produces a `Future <void>`, whose continuations
+  take no parameters.
+
+  @invariant Continuations are always queued, they never execute
+             synchronously from within then() or from the functor that
+             made the future ready.
+
+  @ingroup vf_concurrent
+*/
+template <class T>
+class Future
+{
+public:
+  typedef T value_type;
+
+  /** Create an invalid future.
+  */
+  Future ()
+  {
+  }
+
+  /** Determine if the future refers to a result.
+  */
+  bool isValid () const
+  {
+    return m_state != nullptr;
+  }
+
+  /** Determine if the result is available.
+  */
+  bool isReady () const
+  {
+    jassert (isValid ());
+
+    return m_state->isReady ();
+  }
+
+  /** Retrieve the result.
+
+      @invariant The future is ready.
+  */
+  typename FutureState <T>::reference getValue () const
+  {
+    jassert (isValid ());
+
+    return m_state->getValue ();
+  }
+
+  /** Attach a continuation.
+
+      When this future becomes ready, the functor is queued on the specified
+      CallQueue and called with the result. For a `Future <void>` the
+      functor is called without parameters.
+
+      @param queue The CallQueue to call the functor on.
+
+      @param f The functor to call, typically the return value of a call
+               to bind().
+
+      @return A future for the result of the functor.
+  */
+  template <class Functor>
+  Future <typename Functor::result_type> then (CallQueue& queue, Functor const& f) const;
+
+  /** Create a future which becomes ready when all futures are ready.
+
+      @param futures The futures to wait for. An empty list produces a future
+                     which is immediately ready.
+  */
+  static Future <void> whenAll (std::vector <Future> const& futures);
+
+  /** Create a future which becomes ready when any future is ready.
+
+      @param futures The futures to wait for.
+
+      @return A future holding the index of the first future to become
+              ready, or -1 if the list is empty.
+  */
+  static Future <int> whenAny (std::vector <Future> const& futures);
+
+private:
+  template <class U>
+  friend class Future;
+  friend class CallQueue;
+
+  typedef FutureState <T> StateType;
+
+  explicit Future (StateType* state) : m_state (state)
+  {
+  }
+
+  template <class Functor>
+  class ThenWork;
+  class WhenAllState;
+  class WhenAnyState;
+  class WhenAllInput;
+  class WhenAnyInput;
+
+private:
+  ReferenceCountedObjectPtr <StateType> m_state;
+};
+
+//------------------------------------------------------------------------------
+
+template <class T>
+template <class Functor>
+class Future <T>::ThenWork
+  : public CallQueue::Work
+  , public FutureBase::Continuation
+{
+public:
+  typedef typename Functor::result_type ResultType;
+
+  ThenWork (CallQueue& queue,
+            Functor const& f,
+            StateType* source,
+            FutureState <ResultType>* result)
+    : m_queue (queue)
+    , m_f (f)
+    , m_source (source)
+    , m_result (result)
+  {
+  }
+
+  // The reference to the source is only taken here, so a
+  // continuation waiting in the source does not keep it alive.
+  //
+  void onReady ()
+  {
+    m_sourceRef = m_source;
+
+    m_queue.queuep (this);
+  }
+
+  void operator() ()
+  {
+    FutureCall <T, Functor> call (m_f, *m_sourceRef);
+
+    m_result->evaluate (call);
+  }
+
+private:
+  CallQueue& m_queue;
+  Functor m_f;
+  StateType* const m_source;
+  ReferenceCountedObjectPtr <StateType> m_sourceRef;
+  ReferenceCountedObjectPtr <FutureState <ResultType> > m_result;
+};
+
+template <class T>
+template <class Functor>
+Future <typename Functor::result_type> Future <T>::then (
+  CallQueue& queue, Functor const& f) const
+{
+  typedef typename Functor::result_type ResultType;
+
+  jassert (isValid ());
+
+  FutureState <ResultType>* const result =
+    new (FutureBase::getAllocator ()) FutureState <ResultType>;
+
+  Future <ResultType> future (result);
+
+  m_state->addContinuation (new (queue.getAllocator ()) ThenWork <Functor> (
+    queue, f, m_state, result));
+
+  return future;
+}
+
+//------------------------------------------------------------------------------
+
+template <class T>
+class Future <T>::WhenAllState : public FutureState <void>
+{
+public:
+  explicit WhenAllState (int count) : m_remaining (count)
+  {
+  }
+
+  void onInputReady ()
+  {
+    if (--m_remaining == 0)
+      setValue ();
+  }
+
+private:
+  Atomic <int> m_remaining;
+};
+
+template <class T>
+class Future <T>::WhenAllInput
+  : public FutureBase::Continuation
+  , public AllocatedBy <FutureBase::AllocatorType>
+{
+public:
+  explicit WhenAllInput (WhenAllState* state) : m_state (state)
+  {
+  }
+
+  void onReady ()
+  {
+    m_state->onInputReady ();
+
+    delete this;
+  }
+
+private:
+  ReferenceCountedObjectPtr <WhenAllState> m_state;
+};
+
+template <class T>
+Future <void> Future <T>::whenAll (std::vector <Future> const& futures)
+{
+  int const count = int (futures.size ());
+
+  WhenAllState* const state = new (FutureBase::getAllocator ()) WhenAllState (count);
+
+  Future <void> future (state);
+
+  if (count > 0)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      jassert (futures [i].isValid ());
+
+      futures [i].m_state->addContinuation (
+        new (FutureBase::getAllocator ()) WhenAllInput (state));
+    }
+  }
+  else
+  {
+    state->setValue ();
+  }
+
+  return future;
+}
+
+//------------------------------------------------------------------------------
+
+template <class T>
+class Future <T>::WhenAnyState : public FutureState <int>
+{
+public:
+  void onInputReady (int index)
+  {
+    if (m_done.trySignal ())
+      setValue (index);
+  }
+
+private:
+  AtomicFlag m_done;
+};
+
+template <class T>
+class Future <T>::WhenAnyInput
+  : public FutureBase::Continuation
+  , public AllocatedBy <FutureBase::AllocatorType>
+{
+public:
+  WhenAnyInput (WhenAnyState* state, int index)
+    : m_state (state)
+    , m_index (index)
+  {
+  }
+
+  void onReady ()
+  {
+    m_state->onInputReady (m_index);
+
+    delete this;
+  }
+
+private:
+  ReferenceCountedObjectPtr <WhenAnyState> m_state;
+  int const m_index;
+};
+
+template <class T>
+Future <int> Future <T>::whenAny (std::vector <Future> const& futures)
+{
+  int const count = int (futures.size ());
+
+  WhenAnyState* const state = new (FutureBase::getAllocator ()) WhenAnyState;
+
+  Future <int> future (state);
+
+  if (count > 0)
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      jassert (futures [i].isValid ());
+
+      futures [i].m_state->addContinuation (
+        new (FutureBase::getAllocator ()) WhenAnyInput (state, i));
+    }
+  }
+  else
+  {
+    state->onInputReady (-1);
+  }
+
+  return future;
+}
+
+//------------------------------------------------------------------------------
+
+/** Calls the functor and makes its result available.
+
+    @internal
+*/
+template <class Functor>
+class FutureResultWork : public CallQueue::Work
+{
+public:
+  typedef typename Functor::result_type ResultType;
+
+  FutureResultWork (Functor const& f, FutureState <ResultType>* result)
+    : m_f (f)
+    , m_result (result)
+  {
+  }
+
+  void operator() ()
+  {
+    m_result->evaluate (m_f);
+  }
+
+private:
+  Functor m_f;
+  ReferenceCountedObjectPtr <FutureState <ResultType> > m_result;
+};
+
+template <class Functor>
+Future <typename Functor::result_type> CallQueue::callResult (Functor const& f)
+{
+  typedef typename Functor::result_type ResultType;
+
+  FutureState <ResultType>* const result =
+    new (FutureBase::getAllocator ()) FutureState <ResultType>;
+
+  Future <ResultType> future (result);
+
+  callp (new (m_allocator) FutureResultWork <Functor> (f, result));
+
+  return future;
+}
+
+#endif
@@ -37,6 +37,9 @@
 /**
   A ThreadGroup singleton.
 
+  The threads are created with default options unless setOptions() is called
+  during startup, before the singleton is first used.
+
   @see ThreadGroup
 
   @ingroup vf_concurrent
@@ -44,11 +47,25 @@
 class GlobalThreadGroup : public ThreadGroup,
                           public RefCountedSingleton <GlobalThreadGroup>
 {
+public:
+  /** Set the options used to create the singleton.
+
+      This must be called before the first call to getInstance(), otherwise
+      it has no effect.
+
+      @param options The options for the group and its workers.
+  */
+  static void setOptions (Options const& options)
+  {
+    getOptions () = options;
+  }
+
 private:
   friend class RefCountedSingleton <GlobalThreadGroup>;
 
   GlobalThreadGroup ()
-    : RefCountedSingleton <GlobalThreadGroup> (
+    : ThreadGroup (getOptions ())
+    , RefCountedSingleton <GlobalThreadGroup> (
         SingletonLifetime::persistAfterCreation)
   {
   }
@@ -57,6 +74,13 @@ private:
   {
     return new GlobalThreadGroup;
   }
+
+  static Options& getOptions ()
+  {
+    static Options options;
+
+    return options;
+  }
 };
 
 #endif
@@ -33,6 +33,7 @@
 GuiCallQueue::GuiCallQueue ()
   : CallQueue ("GuiCallQueue")
   , m_thread ("GuiCallQueue")
+  , m_wakeTime (0)
 {
   // This object must be created from the Juce Message Thread.
   //
@@ -49,6 +50,9 @@ void GuiCallQueue::close ()
 {
   m_thread.stop (true);
 
+  // A wakeup may still be pending from the helper thread.
+  cancelPendingUpdate ();
+
   CallQueue::close ();
 }
 
@@ -70,5 +74,31 @@ void GuiCallQueue::handleAsyncUpdate()
 {
   synchronize ();
 
+  scheduleWakeup ();
+
   //updateAllTopLevelWindows ();
 }
+
+// The message thread has no way to wait with a timeout, so the
+// helper thread triggers the update when the earliest timed functor
+// becomes due. A new wakeup is only needed if none is pending, or
+// if the earliest deadline moved closer.
+//
+void GuiCallQueue::scheduleWakeup ()
+{
+  int const milliseconds = getMillisecondsUntilNextDeadline ();
+
+  if (milliseconds >= 0)
+  {
+    double const now = Time::getMillisecondCounterHiRes ();
+    double const wakeTime = now + milliseconds;
+
+    if (m_wakeTime <= now || wakeTime < m_wakeTime)
+    {
+      m_wakeTime = wakeTime;
+
+      m_thread.callAfter (milliseconds,
+        vf::bind (&AsyncUpdater::triggerAsyncUpdate, (AsyncUpdater*)this));
+    }
+  }
+}
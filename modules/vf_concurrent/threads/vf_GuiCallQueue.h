@@ -79,8 +79,10 @@ private:
   void signal ();
   void reset ();
   void handleAsyncUpdate ();
+  void scheduleWakeup ();
 
   ThreadWithCallQueue m_thread;
+  double m_wakeTime;
 };
 
 #endif
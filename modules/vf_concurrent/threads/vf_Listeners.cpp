@@ -30,88 +30,6 @@
 */
 /*============================================================================*/
 
-// CallQueue item to process a Call for a particular listener.
-// This is used to avoid bind overhead.
-//
-class ListenersBase::CallWork : public CallQueue::Work
-{
-public:
-  inline CallWork (ListenersBase::Call* const c, void* const listener)
-    : m_call (c), m_listener (listener)
-  {
-  }
-
-  void operator() ()
-  {
-    m_call->operator() (m_listener);
-  }
-
-private:
-  ListenersBase::Call::Ptr m_call;
-  void* const m_listener;
-};
-
-//------------------------------------------------------------------------------
-
-// CallQueue item to process a Call for a group.
-// This is used to avoid bind overhead.
-//
-class ListenersBase::GroupWork : public CallQueue::Work
-{
-public:
-  inline GroupWork (Group* group,
-                    ListenersBase::Call* c,
-                    const timestamp_t timestamp)
-    : m_group (group)
-    , m_call (c)
-    , m_timestamp (timestamp)
-  {
-  }
-
-  void operator() ()
-  {
-    m_group->do_call (m_call, m_timestamp);
-  }
-
-private:
-  Group::Ptr m_group;
-  ListenersBase::Call::Ptr m_call;
-  const timestamp_t m_timestamp;
-};
-
-//------------------------------------------------------------------------------
-
-// CallQueue item to process a call for a particular listener.
-// This is used to avoid bind overhead.
-//
-class ListenersBase::GroupWork1 : public CallQueue::Work
-{
-public:
-  inline GroupWork1 (Group* group,
-                     ListenersBase::Call* c,
-                     const timestamp_t timestamp,
-                     void* const listener)
-    : m_group (group)
-    , m_call (c)
-    , m_timestamp (timestamp)
-    , m_listener (listener)
-  {
-  }
-
-  void operator() ()
-  {
-    m_group->do_call1 (m_call, m_timestamp, m_listener);
-  }
-
-private:
-  Group::Ptr m_group;
-  ListenersBase::Call::Ptr m_call;
-  const timestamp_t m_timestamp;
-  void* const m_listener;
-};
-
-//------------------------------------------------------------------------------
-
 // A Proxy maintains a list of Entry.
 // Each Entry holds a group and the current Call (which can be updated).
 //
@@ -137,19 +55,40 @@ struct ListenersBase::Proxy::Entry : Entries::Node,
 
 //------------------------------------------------------------------------------
 
-// A Group maintains a list of Entry.
+// A Group maintains an immutable array of Entry.
 //
-struct ListenersBase::Group::Entry : List <Entry>::Node,
-                                     AllocatedBy <AllocatorType>
+struct ListenersBase::Group::Entry
+{
+  void* listener;
+  timestamp_t timestamp;
+};
+
+class ListenersBase::Group::EntryArray
 {
-  Entry (void* const l, const timestamp_t t)
-    : listener (l)
-    , timestamp (t)
+public:
+  explicit EntryArray (int size)
+    : next (nullptr)
+    , m_size (size)
+    , m_entries (size)
+  {
+  }
+
+  int size () const
   {
+    return m_size;
   }
 
-  void* const listener;
-  const timestamp_t timestamp;
+  Entry& operator[] (int index) const
+  {
+    return m_entries [index];
+  }
+
+  // Links arrays which were replaced but not yet deleted.
+  EntryArray* next;
+
+private:
+  int const m_size;
+  HeapBlock <Entry> m_entries;
 };
 
 //------------------------------------------------------------------------------
@@ -160,45 +99,101 @@ struct ListenersBase::Group::Entry : List <Entry>::Node,
 
 // - A list of listeners associated with the same CallQueue.
 //
-// - The list is only iterated on the CallQueue's thread.
+// - The list is an immutable array which is replaced on every
+//   add or remove. Writers are serialized by the groups mutex.
+//
+// - The array is only iterated on the CallQueue's thread, one
+//   Work at a time. A replaced array goes on a list of retired
+//   arrays owned by the group, which the CallQueue's thread
+//   deletes before it starts the next iteration. Any
+//   iteration in progress has finished by then, so the iteration
+//   needs no lock and no reference count. Retiring never touches
+//   the CallQueue, so it is safe while the queue is closing.
+//   Whatever is left is deleted with the group.
 //
 // - It is safe to add or remove listeners from the group
-//   at any time.
+//   at any time, including from a listener during a call.
 //
 
 ListenersBase::Group::Group (CallQueue& callQueue)
   : m_fifo (callQueue)
-  , m_listener (0)
 {
 }
 
 ListenersBase::Group::~Group ()
 {
   // If this goes off it means a Listener forgot to remove itself.
-  jassert (m_list.empty ());
+  jassert (empty ());
 
-  // shouldn't be deleting group during a call
-  jassert (m_listener == 0);
+  delete m_entries.get ();
+
+  reclaim ();
+}
+
+bool ListenersBase::Group::empty () const
+{
+  EntryArray* const entries = m_entries.get ();
+
+  return entries == nullptr || entries->size () == 0;
+}
+
+void ListenersBase::Group::retire (EntryArray* const entries)
+{
+  if (entries != nullptr)
+  {
+    for (;;)
+    {
+      entries->next = m_retired.get ();
+
+      if (m_retired.compareAndSet (entries, entries->next))
+        break;
+    }
+  }
+}
+
+// Deletes the retired arrays. This must only happen when no
+// iteration is in progress, at the start of do_call() or
+// do_call1(), or from the destructor.
+//
+void ListenersBase::Group::reclaim ()
+{
+  EntryArray* entries = m_retired.exchange (nullptr);
+
+  while (entries != nullptr)
+  {
+    EntryArray* const next = entries->next;
+
+    delete entries;
+
+    entries = next;
+  }
 }
 
 // Add the listener with the given timestamp.
 // The listener will only get calls with higher timestamps.
 // The caller must prevent duplicates.
 //
-void ListenersBase::Group::add (void* listener,
-                                const timestamp_t timestamp,
-                                AllocatorType& allocator)
+void ListenersBase::Group::add (void* listener, const timestamp_t timestamp)
 {
-  ReadWriteMutex::ScopedWriteLockType lock (m_mutex);
-
   jassert (!contains (listener));
 
-  // Should never be able to get here while in call()
-  jassert (m_listener == 0);
+  EntryArray* const oldEntries = m_entries.get ();
+
+  int const oldSize = (oldEntries != nullptr) ? oldEntries->size () : 0;
+
+  EntryArray* const newEntries = new EntryArray (oldSize + 1);
+
+  for (int i = 0; i < oldSize; ++i)
+    (*newEntries) [i] = (*oldEntries) [i];
 
   // Add the listener and remember the time stamp so we don't
   // send it calls that were queued earlier than the add().
-  m_list.push_back (*new (allocator) Entry (listener, timestamp));
+  (*newEntries) [oldSize].listener = listener;
+  (*newEntries) [oldSize].timestamp = timestamp;
+
+  m_entries.set (newEntries);
+
+  retire (oldEntries);
 }
 
 // Removes the listener from the group if it exists.
@@ -208,140 +203,140 @@ bool ListenersBase::Group::remove (void* listener)
 {
   bool found = false;
 
-  ReadWriteMutex::ScopedWriteLockType lock (m_mutex);
+  EntryArray* const oldEntries = m_entries.get ();
 
-  // Should never be able to get here while in call()
-  jassert (m_listener == 0);
-
-  for (List <Entry>::iterator iter = m_list.begin(); iter != m_list.end(); ++iter)
+  if (contains (listener))
   {
-    Entry* entry = &(*iter);
-    if (entry->listener == listener)
+    int const oldSize = oldEntries->size ();
+
+    EntryArray* newEntries;
+
+    if (oldSize > 1)
     {
-      m_list.erase (m_list.iterator_to (*entry));
-      delete entry;
-      found = true;
-      break;
+      newEntries = new EntryArray (oldSize - 1);
+
+      for (int i = 0, j = 0; i < oldSize; ++i)
+      {
+        if ((*oldEntries) [i].listener != listener)
+          (*newEntries) [j++] = (*oldEntries) [i];
+      }
+    }
+    else
+    {
+      newEntries = nullptr;
     }
+
+    // Tells a call in progress that listeners may have gone.
+    ++m_removals;
+
+    m_entries.set (newEntries);
+
+    retire (oldEntries);
+
+    found = true;
   }
 
   return found;
 }
 
-// Used for assertions.
-// The caller must synchronize.
+// Used for assertions, and to find the group of a listener.
+// The caller must synchronize with writers.
 //
-bool ListenersBase::Group::contains (void* const listener) /*const*/
+bool ListenersBase::Group::contains (void* const listener) const
 {
-  for (List <Entry>::iterator iter = m_list.begin(); iter != m_list.end(); iter++)
-    if (iter->listener == listener)
-      return true;
-  return false;
+  bool found = false;
+
+  EntryArray* const entries = m_entries.get ();
+
+  if (entries != nullptr)
+  {
+    for (int i = 0; i < entries->size (); ++i)
+    {
+      if ((*entries) [i].listener == listener)
+      {
+        found = true;
+        break;
+      }
+    }
+  }
+
+  return found;
 }
 
-void ListenersBase::Group::call (Call* const c, const timestamp_t timestamp)
+void ListenersBase::Group::call (Work* const w)
 {
   jassert (!empty ());
-  m_fifo.callp (new (m_fifo.getAllocator()) GroupWork (this, c, timestamp));
+  m_fifo.callp (w);
 }
 
-void ListenersBase::Group::queue (Call* const c, const timestamp_t timestamp)
+void ListenersBase::Group::queue (Work* const w)
 {
   jassert (!empty ());
-  m_fifo.queuep (new (m_fifo.getAllocator()) GroupWork (this, c, timestamp));
+  m_fifo.queuep (w);
 }
 
-void ListenersBase::Group::call1 (Call* const c,
-                                  const timestamp_t timestamp,
-                                  void* const listener)
+// Calls each listener that is currently in our list. This must
+// only happen on the thread of our CallQueue, either directly from
+// CallQueue::synchronize(), or from Proxy::Work.
+//
+void ListenersBase::Group::do_call (Invoker& invoker, const timestamp_t timestamp)
 {
-  m_fifo.callp (new (m_fifo.getAllocator()) GroupWork1 (
-    this, c, timestamp, listener));
-}
+  jassert (m_fifo.isBeingSynchronized ());
 
-void ListenersBase::Group::queue1 (Call* const c,
-                                   const timestamp_t timestamp,
-                                   void* const listener)
-{
-  m_fifo.queuep (new (m_fifo.getAllocator()) GroupWork1 (
-    this, c, timestamp, listener));
-}
+  reclaim ();
 
-// Queues a reference to the Call on the thread queue of each listener
-// that is currently in our list. The thread queue must be in the
-// stack's call chain, either directly from CallQueue::synchronize(),
-// or from Proxy::do_call() called from CallQueue::synchronize().
-//
-void ListenersBase::Group::do_call (Call* const c, const timestamp_t timestamp)
-{
-  if (!empty ())
-  {
-    ReadWriteMutex::ScopedReadLockType lock (m_mutex);
+  // If the last listener was removed before we got here,
+  // the parent listener list may have been deleted.
+  //
+  EntryArray* const entries = m_entries.get ();
 
-    // Recursion not allowed.
-    jassert (m_listener == 0);
+  if (entries != nullptr)
+  {
+    int const removals = m_removals.get ();
 
-    // The body of the loop MUST NOT cause listeners to get called.
-    // Therefore, we don't have to worry about listeners removing
-    // themselves while iterating the list.
-    //
-    for (List <Entry>::iterator iter = m_list.begin(); iter != m_list.end();)
+    for (int i = 0; i < entries->size (); ++i)
     {
-      Entry* entry = &(*iter++);
+      Entry const& entry = (*entries) [i];
 
       // Since it is possible for a listener to be added after a
       // Call gets queued but before it executes, this prevents listeners
       // from seeing Calls created before they were added.
       //
-      if (timestamp > entry->timestamp)
+      if (timestamp > entry.timestamp)
       {
-        m_listener = entry->listener;
-
-        // The thread queue's synchronize() function MUST be in our call
-        // stack to guarantee that these calls will not execute immediately.
-        // They will be handled by the tail recusion unrolling in the
-        // thread queue.
-        jassert (m_fifo.isBeingSynchronized ());
-
-        m_fifo.callp (new (m_fifo.getAllocator()) CallWork (c, m_listener));
-
-        m_listener = 0;
+        // A listener we already called might have removed this one.
+        // The array we hold stays valid until we return, but the
+        // removed listener must not be called.
+        //
+        if (m_removals.get () == removals || contains (entry.listener))
+          invoker.invokeListener (entry.listener);
       }
     }
   }
-  else
-  {
-    // last listener was removed before we got here,
-    // and the parent listener list may have been deleted.
-  }
 }
 
-void ListenersBase::Group::do_call1 (Call* const c, const timestamp_t timestamp,
+void ListenersBase::Group::do_call1 (Invoker& invoker,
+                                     const timestamp_t timestamp,
                                      void* const listener)
 {
-  if (!empty ())
-  {
-    ReadWriteMutex::ScopedReadLockType lock (m_mutex);
+  jassert (m_fifo.isBeingSynchronized ());
+
+  reclaim ();
 
-    // Recursion not allowed.
-    jassert (m_listener == 0);
+  EntryArray* const entries = m_entries.get ();
 
-    for (List <Entry>::iterator iter = m_list.begin(); iter != m_list.end();)
+  if (entries != nullptr)
+  {
+    for (int i = 0; i < entries->size (); ++i)
     {
-      Entry* entry = &(*iter++);
+      Entry const& entry = (*entries) [i];
 
-      if (entry->listener == listener)
+      if (entry.listener == listener)
       {
-        if (timestamp > entry->timestamp)
-        {
-          m_listener = entry->listener;
-
-          jassert (m_fifo.isBeingSynchronized ());
-
-          m_fifo.callp (new (m_fifo.getAllocator()) CallWork (c, m_listener));
+        if (timestamp > entry.timestamp)
+          invoker.invokeListener (entry.listener);
 
-          m_listener = 0;
-        }
+        break;
       }
     }
   }
@@ -351,6 +346,25 @@ void ListenersBase::Group::do_call1 (Call* const c, const timestamp_t timestamp,
   }
 }
 
+//------------------------------------------------------------------------------
+
+ListenersBase::Group::Work::Work (Group* group,
+                                  const timestamp_t timestamp,
+                                  void* const listener)
+  : m_group (group)
+  , m_timestamp (timestamp)
+  , m_listener (listener)
+{
+}
+
+void ListenersBase::Group::Work::operator() ()
+{
+  if (m_listener == nullptr)
+    m_group->do_call (*this, m_timestamp);
+  else
+    m_group->do_call1 (*this, m_timestamp, m_listener);
+}
+
 //------------------------------------------------------------------------------
 //
 // Proxy
@@ -379,12 +393,33 @@ public:
     Group* group = m_entry->group;
 
     if (!group->empty ())
-      group->do_call (c, m_timestamp);
+    {
+      CallInvoker invoker (c);
+
+      group->do_call (invoker, m_timestamp);
+    }
 
     c->decReferenceCount ();
   }
 
 private:
+  class CallInvoker : public Invoker
+  {
+  public:
+    explicit CallInvoker (Call* const c) : m_call (c)
+    {
+    }
+
+    void invokeListener (void* const listener)
+    {
+      m_call->operator() (listener);
+    }
+
+  private:
+    Call* const m_call;
+  };
+
+
   Proxy* const m_proxy;
   Entry::Ptr m_entry;
   const timestamp_t m_timestamp;
@@ -570,7 +605,7 @@ void ListenersBase::add_void (void* const listener, CallQueue& callQueue)
   }
 
   // Add the listener to the group with the current timestamp
-  group->add (listener, m_timestamp, *m_allocator);
+  group->add (listener, m_timestamp);
 
   // Increment the timestamp within the mutex so
   // future calls will be newer than this listener.
@@ -643,31 +678,33 @@ void ListenersBase::remove_void (void* const listener)
   }
 }
 
-void ListenersBase::callp (Call::Ptr cp)
+void ListenersBase::callw (WorkFactory const& factory)
 {
-  Call* c = cp;
-
   ReadWriteMutex::ScopedReadLockType lock (m_groups_mutex);
 
   // can't be const iterator because queue() might cause called functors
   // to modify the list.
   for (Groups::iterator iter = m_groups.begin(); iter != m_groups.end();)
-    (iter++)->call (c, m_timestamp);
+  {
+    Group* group = &(*iter++);
+    group->call (factory.createWork (group, m_timestamp, nullptr));
+  }
 }
 
-void ListenersBase::queuep (Call::Ptr cp)
+void ListenersBase::queuew (WorkFactory const& factory)
 {
-  Call* c = cp;
-
   ReadWriteMutex::ScopedReadLockType lock (m_groups_mutex);
 
   // can't be const iterator because queue() might cause called functors
   // to modify the list.
   for (Groups::iterator iter = m_groups.begin(); iter != m_groups.end();)
-    (iter++)->queue (c, m_timestamp);
+  {
+    Group* group = &(*iter++);
+    group->queue (factory.createWork (group, m_timestamp, nullptr));
+  }
 }
 
-void ListenersBase::call1p_void (void* const listener, Call* c)
+void ListenersBase::call1w_void (void* const listener, WorkFactory const& factory)
 {
   ReadWriteMutex::ScopedReadLockType lock (m_groups_mutex);
 
@@ -678,13 +715,13 @@ void ListenersBase::call1p_void (void* const listener, Call* c)
     Group* group = &(*iter++);
     if (group->contains (listener))
     {
-      group->call1 (c, m_timestamp, listener);
+      group->call (factory.createWork (group, m_timestamp, listener));
       break;
     }
   }
 }
 
-void ListenersBase::queue1p_void (void* const listener, Call* c)
+void ListenersBase::queue1w_void (void* const listener, WorkFactory const& factory)
 {
   ReadWriteMutex::ScopedReadLockType lock (m_groups_mutex);
 
@@ -695,7 +732,7 @@ void ListenersBase::queue1p_void (void* const listener, Call* c)
     Group* group = &(*iter++);
     if (group->contains (listener))
     {
-      group->queue1 (c, m_timestamp, listener);
+      group->queue (factory.createWork (group, m_timestamp, listener));
       break;
     }
   }
@@ -227,6 +227,19 @@ public:
 
   typedef GlobalFifoFreeStore <ListenersBase> CallAllocatorType;
 
+  // Calls a member function on one listener.
+  //
+  class Invoker
+  {
+  public:
+    virtual ~Invoker () { }
+
+    virtual void invokeListener (void* const listener) = 0;
+  };
+
+  // A shared call, used by update() so that a pending
+  // call can be replaced with a newer one.
+  //
   class Call : public ReferenceCountedObject,
                public AllocatedBy <CallAllocatorType>
   {
@@ -235,7 +248,7 @@ public:
     virtual void operator () (void* const listener) = 0;
   };
 
-private:
+protected:
   typedef unsigned long timestamp_t;
 
   class Group;
@@ -244,11 +257,8 @@ private:
   class Proxy;
   typedef List <Proxy> Proxies;
 
-  class CallWork;
-  class GroupWork;
-  class GroupWork1;
-
-  // Maintains a list of listeners registered on the same CallQueue
+  // Maintains the listeners registered on the same CallQueue, in a
+  // copy-on-write array which is read without locking.
   //
   class Group : public Groups::Node,
                 public ReferenceCountedObject,
@@ -257,32 +267,44 @@ private:
   public:
     typedef ReferenceCountedObjectPtr <Group> Ptr;
 
+    class Work;
+
     explicit Group    (CallQueue& callQueue);
     ~Group            ();
-    void add          (void* listener, const timestamp_t timestamp,
-                       AllocatorType& allocator);
+    void add          (void* listener, const timestamp_t timestamp);
     bool remove       (void* listener);
-    bool contains     (void* const listener);
-    void call         (Call* const c, const timestamp_t timestamp);
-    void queue        (Call* const c, const timestamp_t timestamp);
-    void call1        (Call* const c, const timestamp_t timestamp,
-                       void* const listener);
-    void queue1       (Call* const c, const timestamp_t timestamp,
-                       void* const listener);
-    void do_call      (Call* const c, const timestamp_t timestamp);
-    void do_call1     (Call* const c, const timestamp_t timestamp,
+    bool contains     (void* const listener) const;
+    void call         (Work* const w);
+    void queue        (Work* const w);
+    void do_call      (Invoker& invoker, const timestamp_t timestamp);
+    void do_call1     (Invoker& invoker, const timestamp_t timestamp,
                        void* const listener);
-
-    bool empty        () const { return m_list.empty(); }
+    bool empty        () const;
     CallQueue& getCallQueue () const { return m_fifo; }
 
   private:
     struct Entry;
+    class EntryArray;
+
+    void retire (EntryArray* const entries);
+    void reclaim ();
 
     CallQueue& m_fifo;
-    List <Entry> m_list;
-    void* m_listener;
-    CacheLine::Aligned <ReadWriteMutex> m_mutex;
+    AtomicPointer <EntryArray> m_entries;
+    AtomicPointer <EntryArray> m_retired;
+    Atomic <int> m_removals;
+  };
+
+  // Produces the Group::Work for each Group that receives a call.
+  //
+  class WorkFactory
+  {
+  public:
+    virtual ~WorkFactory () { }
+
+    virtual Group::Work* createWork (Group* group,
+                                     const timestamp_t timestamp,
+                                     void* const listener) const = 0;
   };
 
   // A Proxy is keyed to a unique pointer-to-member of a
@@ -329,10 +351,10 @@ protected:
   void add_void     (void* const listener, CallQueue& callQueue);
   void remove_void  (void* const listener);
 
-  void callp        (Call::Ptr c);
-  void queuep       (Call::Ptr c);
-  void call1p_void  (void* const listener, Call* c);
-  void queue1p_void (void* const listener, Call* c);
+  void callw        (WorkFactory const& factory);
+  void queuew       (WorkFactory const& factory);
+  void call1w_void  (void* const listener, WorkFactory const& factory);
+  void queue1w_void (void* const listener, WorkFactory const& factory);
   void updatep      (void const* const member,
                      const size_t bytes, Call::Ptr cp);
 
@@ -349,6 +371,26 @@ private:
   CallAllocatorType::Ptr m_callAllocator;
 };
 
+//------------------------------------------------------------------------------
+
+// CallQueue item which calls a functor on the listeners of a Group.
+// The functor is stored inline by the derived class, so a call needs
+// one allocation per Group and none per listener.
+//
+class ListenersBase::Group::Work : public CallQueue::Work,
+                                   public ListenersBase::Invoker
+{
+public:
+  Work (Group* group, const timestamp_t timestamp, void* const listener);
+
+  void operator() ();
+
+private:
+  Group::Ptr m_group;
+  const timestamp_t m_timestamp;
+  void* const m_listener;
+};
+
 /*============================================================================*/
 
 template <class ListenerClass>
@@ -374,37 +416,70 @@ private:
   };
 
   template <class Functor>
-  inline void callf (const Functor& f)
+  class WorkType : public Group::Work
   {
-    callp (new (getCallAllocator ()) CallType <Functor> (f));
-  }
+  public:
+    WorkType (Group* group,
+              const timestamp_t timestamp,
+              void* const listener,
+              const Functor& f)
+      : Group::Work (group, timestamp, listener)
+      , m_f (f)
+    {
+    }
+
+    void invokeListener (void* const listener)
+    {
+      ListenerClass* object = static_cast <ListenerClass*> (listener);
+      m_f.operator() (object);
+    }
+
+  private:
+    Functor m_f;
+  };
 
   template <class Functor>
-  inline void queuef (const Functor& f)
+  class FactoryType : public WorkFactory
   {
-    queuep (new (getCallAllocator ()) CallType <Functor> (f));
-  }
+  public:
+    explicit FactoryType (const Functor& f) : m_f (f)
+    {
+    }
+
+    Group::Work* createWork (Group* group,
+                             const timestamp_t timestamp,
+                             void* const listener) const
+    {
+      return new (group->getCallQueue ().getAllocator ())
+        WorkType <Functor> (group, timestamp, listener, m_f);
+    }
 
-  inline void call1p (ListenerClass* const listener, Call::Ptr c)
+  private:
+    const Functor& m_f;
+  };
+
+  template <class Functor>
+  inline void callf (const Functor& f)
   {
-    call1p_void (listener, c);
+    callw (FactoryType <Functor> (f));
   }
 
-  inline void queue1p (ListenerClass* const listener, Call::Ptr c)
+  template <class Functor>
+  inline void queuef (const Functor& f)
   {
-    queue1p_void (listener, c);
+    queuew (FactoryType <Functor> (f));
   }
 
   template <class Functor>
   inline void call1f (ListenerClass* const listener, const Functor& f)
   {
-    call1p (listener, new (getCallAllocator ()) CallType <Functor> (f));
+    call1w_void (listener, FactoryType <Functor> (f));
   }
 
   template <class Functor>
   inline void queue1f (ListenerClass* const listener, const Functor& f)
   {
-    queue1p (listener, new (getCallAllocator ()) CallType <Functor> (f));
+    queue1w_void (listener, FactoryType <Functor> (f));
   }
 
   template <class Member, class Functor>
@@ -478,6 +553,13 @@ public:
                 arguments.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Mf, class... Args>
+  void call (Mf mf, Args&&... args)
+  {
+    callf (BoundMemberCall <Mf, Args...> (mf, std::forward <Args> (args)...));
+  }
+#else
   template <class Mf>
   inline void call (Mf mf)
   {
@@ -531,6 +613,7 @@ public:
   {
     callf (vf::bind (mf, vf::_1, t1, t2, t3, t4, t5, t6, t7, t8));
   }
+#endif
   /** @} */
 
   /** Queue a member function on every added listener, without synchronizing.
@@ -542,6 +625,13 @@ public:
                 arguments.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Mf, class... Args>
+  void queue (Mf mf, Args&&... args)
+  {
+    queuef (BoundMemberCall <Mf, Args...> (mf, std::forward <Args> (args)...));
+  }
+#else
   template <class Mf>
   inline void queue (Mf mf)
   {
@@ -595,6 +685,7 @@ public:
   {
     queuef (vf::bind (mf, vf::_1, t1, t2, t3, t4, t5, t6, t7, t8));
   }
+#endif
   /** @} */
 
   /** Call a member function on every added listener, replacing pending
@@ -612,6 +703,13 @@ public:
                 arguments.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Mf, class... Args>
+  void update (Mf mf, Args&&... args)
+  {
+    updatef (mf, BoundMemberCall <Mf, Args...> (mf, std::forward <Args> (args)...));
+  }
+#else
   template <class Mf>
   inline void update (Mf mf)
   { updatef (mf, vf::bind (mf, vf::_1)); }
@@ -663,6 +761,7 @@ public:
   {
     updatef (mf, vf::bind (mf, vf::_1, t1, t2, t3, t4, t5, t6, t7, t8));
   }
+#endif
   /** @} */
 
   /** Call a member function on a specific listener.
@@ -677,6 +776,13 @@ public:
                       to 8 arguments.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Mf, class... Args>
+  void call1 (ListenerClass* const listener, Mf mf, Args&&... args)
+  {
+    call1f (listener, BoundMemberCall <Mf, Args...> (mf, std::forward <Args> (args)...));
+  }
+#else
   template <class Mf>
   inline void call1 (ListenerClass* const listener, Mf mf)
   {
@@ -730,6 +836,7 @@ public:
   {
     call1f (listener, vf::bind (mf, vf::_1, t1, t2, t3, t4, t5, t6, t7, t8));
   }
+#endif
   /** @} */
 
   /** Queue a member function on a specific listener.
@@ -742,6 +849,13 @@ public:
                       to 8 arguments.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Mf, class... Args>
+  void queue1 (ListenerClass* const listener, Mf mf, Args&&... args)
+  {
+    queue1f (listener, BoundMemberCall <Mf, Args...> (mf, std::forward <Args> (args)...));
+  }
+#else
   template <class Mf>
   inline void queue1 (ListenerClass* const listener, Mf mf)
   {
@@ -795,6 +909,7 @@ public:
   {
     queue1f (listener, vf::bind (mf, vf::_1, t1, t2, t3, t4, t5, t6, t7, t8));
   }
+#endif
   /** @} */
 };
 /** @} */
@@ -0,0 +1,111 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+LockMetrics::LockMetrics (char const* kind, String const& name)
+  : m_kind (kind)
+  , m_name (name)
+  , m_depth (0)
+  , m_holdTicks (0)
+{
+  Metrics::add (this);
+}
+
+LockMetrics::~LockMetrics ()
+{
+  Metrics::remove (this);
+}
+
+void LockMetrics::exclusiveEntered ()
+{
+  if (m_depth++ == 0)
+    m_holdTicks = Metrics::isEnabled () ? Time::getHighResolutionTicks () : 0;
+}
+
+void LockMetrics::exclusiveExited ()
+{
+  if (--m_depth == 0 && m_holdTicks != 0)
+    m_holdNs.record (toNanoseconds (Time::getHighResolutionTicks () - m_holdTicks));
+}
+
+void LockMetrics::addReports (Metrics::Snapshot& snapshot)
+{
+  Metrics::Report& report = snapshot.add (m_kind, m_name);
+
+  report.addValue ("sharedAcquisitions", m_shared.acquisitions.get ());
+  report.addValue ("sharedContended", m_shared.contended.get ());
+  report.addHistogram ("sharedWaitNs", m_shared.waitNs);
+  report.addHistogram ("sharedSpins", m_shared.spins);
+
+  report.addValue ("exclusiveAcquisitions", m_exclusive.acquisitions.get ());
+  report.addValue ("exclusiveContended", m_exclusive.contended.get ());
+  report.addHistogram ("exclusiveWaitNs", m_exclusive.waitNs);
+  report.addHistogram ("exclusiveSpins", m_exclusive.spins);
+
+  report.addHistogram ("exclusiveHoldNs", m_holdNs);
+}
+
+int64 LockMetrics::toNanoseconds (int64 ticks)
+{
+  return int64 (Time::highResolutionTicksToSeconds (ticks) * 1000000000);
+}
+
+//------------------------------------------------------------------------------
+
+LockMetrics::Acquisition::Acquisition (LockMetrics* metrics)
+  : m_metrics ((metrics != nullptr && Metrics::isEnabled ()) ? metrics : nullptr)
+  , m_waitTicks (0)
+  , m_spins (0)
+{
+}
+
+void LockMetrics::Acquisition::contended ()
+{
+  if (m_metrics != nullptr && m_waitTicks == 0)
+    m_waitTicks = Time::getHighResolutionTicks ();
+}
+
+void LockMetrics::Acquisition::acquired (Access access)
+{
+  if (m_metrics != nullptr)
+  {
+    Counts& counts = (access == shared) ? m_metrics->m_shared : m_metrics->m_exclusive;
+
+    ++counts.acquisitions;
+
+    if (m_waitTicks != 0)
+    {
+      ++counts.contended;
+      counts.waitNs.record (toNanoseconds (Time::getHighResolutionTicks () - m_waitTicks));
+      counts.spins.record (m_spins);
+    }
+  }
+}
@@ -0,0 +1,165 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_LOCKMETRICS_VFHEADER
+#define VF_LOCKMETRICS_VFHEADER
+
+/*============================================================================*/
+/**
+  The name under which a lock reports contention.
+
+  This is used to name the lock of a ConcurrentState, where the other
+  constructor parameters are forwarded to the shared object:
+
+  @code
+
+  ConcurrentState <SharedData> sharedState (LockName ("mixer"), 16);
+
+  @endcode
+
+  @see LockMetrics
+
+  @ingroup vf_concurrent
+*/
+class LockName
+{
+public:
+  explicit LockName (String const& name) : m_name (name) { }
+
+  String const& get () const { return m_name; }
+
+private:
+  String const m_name;
+};
+
+//------------------------------------------------------------------------------
+
+/**
+  Contention measurements for one lock.
+
+  Named instances of ReadWriteMutex, ProfiledCriticalSection and
+  ConcurrentState own one of these when VF_USE_METRICS is set, and report
+  through Metrics. For each kind of access, shared and exclusive, this
+  records:
+
+  - The number of acquisitions, and how many of those had to wait.
+
+  - The time spent waiting, in nanoseconds.
+
+  - The number of spins or retries made while waiting.
+
+  The time exclusive access is held is also recorded. Nothing is measured
+  while Metrics is disabled. Uncontended acquisitions cost one atomic
+  increment, since timing starts only once an acquisition has to wait.
+
+  Locks which show frequent or long waits are candidates for a lock-free
+  design, such as a CallQueue or a copy-on-write structure.
+
+  @ingroup vf_concurrent
+*/
+class LockMetrics : public Metrics::Source
+{
+public:
+  enum Access
+  {
+    shared,
+    exclusive
+  };
+
+  /** Create the metrics and register them.
+
+      @param kind The type of lock. This must be a string literal.
+
+      @param name The name of the lock.
+  */
+  LockMetrics (char const* kind, String const& name);
+
+  ~LockMetrics ();
+
+  /** Tracks one attempt to acquire the lock.
+  */
+  class Acquisition : vf::Uncopyable
+  {
+  public:
+    /** Start tracking.
+
+        @param metrics The lock's metrics, which may be nullptr.
+    */
+    explicit Acquisition (LockMetrics* metrics);
+
+    /** Determine if this acquisition is being measured. */
+    bool isProfiling () const { return m_metrics != nullptr; }
+
+    /** Call when the acquisition has to wait. Only the first call counts. */
+    void contended ();
+
+    /** Call for each spin or retry while waiting. */
+    void spin () { ++m_spins; }
+
+    /** Call once the lock is held. */
+    void acquired (Access access);
+
+  private:
+    LockMetrics* const m_metrics;
+    int64 m_waitTicks;
+    int m_spins;
+  };
+
+  /** Call after exclusive access is acquired, from the holding thread. */
+  void exclusiveEntered ();
+
+  /** Call before exclusive access is released, from the holding thread. */
+  void exclusiveExited ();
+
+  void addReports (Metrics::Snapshot& snapshot);
+
+private:
+  struct Counts
+  {
+    Atomic <int64> acquisitions;
+    Atomic <int64> contended;
+    Metrics::Histogram waitNs;
+    Metrics::Histogram spins;
+  };
+
+  static int64 toNanoseconds (int64 ticks);
+
+  char const* const m_kind;
+  String const m_name;
+  Counts m_shared;
+  Counts m_exclusive;
+  Metrics::Histogram m_holdNs;
+  int m_depth;
+  int64 m_holdTicks;
+};
+
+#endif
@@ -45,6 +45,11 @@ bool ManualCallQueue::synchronize ()
   return CallQueue::synchronize ();
 }
 
+int ManualCallQueue::nextDeadline ()
+{
+  return getMillisecondsUntilNextDeadline ();
+}
+
 void ManualCallQueue::signal ()
 {
 }
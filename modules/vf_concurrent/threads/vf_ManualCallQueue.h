@@ -100,6 +100,19 @@ public:
   */
   bool synchronize ();
 
+  /** Determine when the queue next needs to be synchronized for timed functors.
+
+      Timed functors are added with callAt() or callAfter(). Callers which
+      are not otherwise synchronizing the queue periodically can use this to
+      schedule the next call to synchronize().
+
+      @note This must be called from the associated thread.
+
+      @return The number of milliseconds until the earliest timed functor is
+              due, zero if it is already due, or -1 if there are none.
+  */
+  int nextDeadline ();
+
 private:
   void signal ();
   void reset ();
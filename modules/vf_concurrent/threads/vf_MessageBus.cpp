@@ -0,0 +1,550 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+struct MessageBus::Subscription
+{
+  Subscription ()
+    : subscriber (nullptr)
+    , typeId (nullptr)
+    , sequence (0)
+  {
+  }
+
+  SubscriberBase* subscriber;
+  void const* typeId;
+  String topic;
+  sequence_t sequence;
+};
+
+//------------------------------------------------------------------------------
+
+// The subscriptions of a Destination. Once published, an array is never
+// changed. Adding or removing a subscription replaces the whole array.
+//
+class MessageBus::SubscriptionArray
+{
+public:
+  typedef std::vector <Subscription> Vector;
+
+  explicit SubscriptionArray (Vector const& subscriptions)
+    : next (nullptr)
+    , m_subscriptions (subscriptions)
+  {
+  }
+
+  int size () const
+  {
+    return int (m_subscriptions.size ());
+  }
+
+  Subscription const& operator[] (int index) const
+  {
+    return m_subscriptions [index];
+  }
+
+  Vector const& getVector () const
+  {
+    return m_subscriptions;
+  }
+
+  // Links arrays which were replaced but not yet deleted.
+  SubscriptionArray* next;
+
+private:
+  Vector const m_subscriptions;
+};
+
+//------------------------------------------------------------------------------
+
+// A reference to an Envelope waiting in the pending list of a Destination.
+//
+class MessageBus::Delivery
+  : public LockFreeQueue <Delivery>::Node
+  , public AllocatedBy <CallQueue::AllocatorType>
+{
+public:
+  explicit Delivery (Envelope* envelope)
+    : m_envelope (envelope)
+  {
+  }
+
+  Envelope const& getEnvelope () const
+  {
+    return *m_envelope;
+  }
+
+private:
+  ReferenceCountedObjectPtr <Envelope> m_envelope;
+};
+
+//------------------------------------------------------------------------------
+
+// All subscriptions that share a CallQueue.
+//
+// - The subscription array is only read on the CallQueue's thread, or
+//   by publishers holding the read lock. A replaced array goes on a list
+//   of retired arrays, which deliver() deletes before it reads the
+//   current one, so delivery needs no lock. Retiring never touches the
+//   CallQueue, so it is safe while the queue is closing. Whatever is
+//   left is deleted with the Destination.
+//
+// - The subscriber being called is announced in m_delivering before it
+//   is checked for removal. An unsubscribe from another thread waits
+//   while it is announced, so it either removes the subscriber before
+//   the check, or returns after the call.
+//
+// - Messages accumulate in the pending list. Only the transition from
+//   empty to non-empty queues a DeliverWork, which then drains the list.
+//
+class MessageBus::Destination
+  : public Destinations::Node
+  , public ReferenceCountedObject
+{
+public:
+  typedef ReferenceCountedObjectPtr <Destination> Ptr;
+
+  explicit Destination (CallQueue& callQueue);
+  ~Destination ();
+
+  CallQueue& getCallQueue () const { return m_callQueue; }
+
+  bool empty () const;
+  bool wants (Envelope const& envelope) const;
+
+  void add (Subscription const& subscription);
+  bool remove (SubscriberBase* subscriber);
+  void waitForDelivery (SubscriberBase* subscriber);
+
+  void post (Envelope* envelope);
+  void deliver ();
+
+private:
+  void replace (SubscriptionArray* subscriptions);
+  void reclaim ();
+  bool contains (SubscriberBase* subscriber) const;
+
+  CallQueue& m_callQueue;
+  AtomicPointer <SubscriptionArray> m_subscriptions;
+  AtomicPointer <SubscriptionArray> m_retired;
+  AtomicPointer <SubscriberBase> m_delivering;
+  Atomic <int> m_removals;
+  LockFreeQueue <Delivery> m_pending;
+};
+
+//------------------------------------------------------------------------------
+
+// Delivers everything pending for a Destination.
+//
+class MessageBus::DeliverWork : public CallQueue::Work
+{
+public:
+  explicit DeliverWork (Destination* destination)
+    : m_destination (destination)
+  {
+  }
+
+  void operator() ()
+  {
+    m_destination->deliver ();
+  }
+
+private:
+  Destination::Ptr m_destination;
+};
+
+//------------------------------------------------------------------------------
+
+MessageBus::Destination::Destination (CallQueue& callQueue)
+  : m_callQueue (callQueue)
+{
+}
+
+MessageBus::Destination::~Destination ()
+{
+  // Messages which were never delivered.
+  for (;;)
+  {
+    Delivery* const delivery = m_pending.pop_front ();
+
+    if (delivery != nullptr)
+      delete delivery;
+    else
+      break;
+  }
+
+  delete m_subscriptions.get ();
+
+  reclaim ();
+}
+
+bool MessageBus::Destination::empty () const
+{
+  SubscriptionArray* const subscriptions = m_subscriptions.get ();
+
+  return subscriptions == nullptr || subscriptions->size () == 0;
+}
+
+// Called by publishers with the read lock.
+//
+bool MessageBus::Destination::wants (Envelope const& envelope) const
+{
+  bool wanted = false;
+
+  SubscriptionArray* const subscriptions = m_subscriptions.get ();
+
+  if (subscriptions != nullptr)
+  {
+    for (int i = 0; i < subscriptions->size (); ++i)
+    {
+      Subscription const& s = (*subscriptions) [i];
+
+      if (s.typeId == envelope.getTypeId () &&
+          topicMatches (s.topic, envelope.getTopic ()))
+      {
+        wanted = true;
+        break;
+      }
+    }
+  }
+
+  return wanted;
+}
+
+bool MessageBus::Destination::contains (SubscriberBase* subscriber) const
+{
+  bool found = false;
+
+  SubscriptionArray* const subscriptions = m_subscriptions.get ();
+
+  if (subscriptions != nullptr)
+  {
+    for (int i = 0; i < subscriptions->size (); ++i)
+    {
+      if ((*subscriptions) [i].subscriber == subscriber)
+      {
+        found = true;
+        break;
+      }
+    }
+  }
+
+  return found;
+}
+
+void MessageBus::Destination::replace (SubscriptionArray* subscriptions)
+{
+  SubscriptionArray* const old = m_subscriptions.exchange (subscriptions);
+
+  if (old != nullptr)
+  {
+    for (;;)
+    {
+      old->next = m_retired.get ();
+
+      if (m_retired.compareAndSet (old, old->next))
+        break;
+    }
+  }
+}
+
+// Deletes the retired arrays. This must only happen when no delivery
+// is in progress, at the start of deliver(), or from the destructor.
+//
+void MessageBus::Destination::reclaim ()
+{
+  SubscriptionArray* subscriptions = m_retired.exchange (nullptr);
+
+  while (subscriptions != nullptr)
+  {
+    SubscriptionArray* const next = subscriptions->next;
+
+    delete subscriptions;
+
+    subscriptions = next;
+  }
+}
+
+// Caller has the write lock.
+//
+void MessageBus::Destination::add (Subscription const& subscription)
+{
+  SubscriptionArray* const old = m_subscriptions.get ();
+
+  SubscriptionArray::Vector v;
+
+  if (old != nullptr)
+    v = old->getVector ();
+
+  v.push_back (subscription);
+
+  replace (new SubscriptionArray (v));
+}
+
+// Returns true if the subscriber was removed.
+// Caller has the write lock.
+//
+bool MessageBus::Destination::remove (SubscriberBase* subscriber)
+{
+  bool const found = contains (subscriber);
+
+  if (found)
+  {
+    SubscriptionArray::Vector const& old = m_subscriptions.get ()->getVector ();
+
+    SubscriptionArray::Vector v;
+    v.reserve (old.size ());
+
+    for (std::size_t i = 0; i < old.size (); ++i)
+    {
+      if (old [i].subscriber != subscriber)
+        v.push_back (old [i]);
+    }
+
+    // Tells a delivery in progress that subscribers may have gone.
+    ++m_removals;
+
+    replace (v.empty () ? nullptr : new SubscriptionArray (v));
+  }
+
+  return found;
+}
+
+// Wait for a call to a removed subscriber that is in progress on
+// another thread. On the CallQueue's thread it can only be our caller.
+// Caller must not have the lock, since the subscriber may publish.
+//
+void MessageBus::Destination::waitForDelivery (SubscriberBase* subscriber)
+{
+  if (!m_callQueue.isAssociatedWithCurrentThread ())
+  {
+    while (m_delivering.get () == subscriber)
+      Thread::yield ();
+  }
+}
+
+// Called by publishers with the read lock.
+//
+void MessageBus::Destination::post (Envelope* envelope)
+{
+  if (m_pending.push_back (new (m_callQueue.getAllocator ()) Delivery (envelope)))
+    m_callQueue.queuep (new (m_callQueue.getAllocator ()) DeliverWork (this));
+}
+
+// Called on the CallQueue's thread.
+//
+void MessageBus::Destination::deliver ()
+{
+  jassert (m_callQueue.isBeingSynchronized ());
+
+  reclaim ();
+
+  for (;;)
+  {
+    Delivery* const delivery = m_pending.pop_front ();
+
+    if (delivery == nullptr)
+      break;
+
+    Envelope const& envelope = delivery->getEnvelope ();
+
+    // Loaded for each message, so that subscribers added
+    // by a previous message in the batch see this one.
+    //
+    SubscriptionArray* const subscriptions = m_subscriptions.get ();
+
+    if (subscriptions != nullptr)
+    {
+      int const removals = m_removals.get ();
+
+      for (int i = 0; i < subscriptions->size (); ++i)
+      {
+        Subscription const& s = (*subscriptions) [i];
+
+        if (s.typeId == envelope.getTypeId () &&
+            envelope.m_sequence > s.sequence &&
+            topicMatches (s.topic, envelope.getTopic ()))
+        {
+          m_delivering.set (s.subscriber);
+
+          // A subscriber we already called, or another thread,
+          // might have removed this one.
+          if (m_removals.get () == removals || contains (s.subscriber))
+            s.subscriber->deliver (envelope);
+
+          m_delivering.set (nullptr);
+        }
+      }
+    }
+
+    delete delivery;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+MessageBus::MessageBus ()
+  : m_sequence (0)
+  , m_allocator (AllocatorType::getInstance ())
+{
+}
+
+MessageBus::~MessageBus ()
+{
+  for (Destinations::iterator iter = m_destinations.begin ();
+       iter != m_destinations.end ();)
+  {
+    Destination* destination = &(*iter++);
+
+    // If this goes off it means a subscriber forgot to unsubscribe.
+    jassert (destination->empty ());
+
+    m_destinations.erase (m_destinations.iterator_to (*destination));
+    destination->decReferenceCount ();
+  }
+}
+
+void MessageBus::subscribe_void (SubscriberBase* subscriber,
+                                 void const* typeId,
+                                 String const& topic,
+                                 CallQueue& callQueue)
+{
+  ReadWriteMutex::ScopedWriteLockType lock (m_mutex);
+
+  // See if we already have a Destination for this CallQueue.
+  Destination* destination = nullptr;
+
+  for (Destinations::iterator iter = m_destinations.begin ();
+       iter != m_destinations.end ();)
+  {
+    Destination* cur = &(*iter++);
+
+    if (&cur->getCallQueue () == &callQueue)
+    {
+      destination = cur;
+      break;
+    }
+  }
+
+  if (destination == nullptr)
+  {
+    destination = new Destination (callQueue);
+
+    // The list holds a manual reference.
+    destination->incReferenceCount ();
+    m_destinations.push_back (*destination);
+  }
+
+  Subscription subscription;
+  subscription.subscriber = subscriber;
+  subscription.typeId = typeId;
+  subscription.topic = topic;
+  subscription.sequence = m_sequence;
+
+  destination->add (subscription);
+
+  // Increment within the lock, so only messages
+  // published from now on reach the subscriber.
+  ++m_sequence;
+}
+
+void MessageBus::unsubscribe (SubscriberBase* subscriber)
+{
+  // Destinations that might be calling the subscriber.
+  std::vector <Destination::Ptr> removed;
+
+  {
+    ReadWriteMutex::ScopedWriteLockType lock (m_mutex);
+
+    for (Destinations::iterator iter = m_destinations.begin ();
+         iter != m_destinations.end ();)
+    {
+      Destination* destination = &(*iter++);
+
+      if (destination->remove (subscriber))
+        removed.push_back (destination);
+
+      if (destination->empty ())
+      {
+        // A DeliverWork may still hold a reference.
+        m_destinations.erase (m_destinations.iterator_to (*destination));
+        destination->decReferenceCount ();
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < removed.size (); ++i)
+    removed [i]->waitForDelivery (subscriber);
+}
+
+void MessageBus::publishp (Envelope* envelope)
+{
+  // Keeps the envelope alive if nobody wants it.
+  ReferenceCountedObjectPtr <Envelope> ref (envelope);
+
+  ReadWriteMutex::ScopedReadLockType lock (m_mutex);
+
+  envelope->m_sequence = m_sequence;
+
+  for (Destinations::iterator iter = m_destinations.begin ();
+       iter != m_destinations.end ();)
+  {
+    Destination* destination = &(*iter++);
+
+    if (destination->wants (*envelope))
+      destination->post (envelope);
+  }
+}
+
+bool MessageBus::topicMatches (String const& subscriptionTopic,
+                               String const& messageTopic)
+{
+  bool matches;
+
+  int const length = subscriptionTopic.length ();
+
+  if (length == 0)
+  {
+    matches = true;
+  }
+  else if (messageTopic.startsWith (subscriptionTopic))
+  {
+    // Must end on a level boundary.
+    matches = messageTopic.length () == length ||
+              messageTopic [length] == '/';
+  }
+  else
+  {
+    matches = false;
+  }
+
+  return matches;
+}
@@ -0,0 +1,324 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_MESSAGEBUS_VFHEADER
+#define VF_MESSAGEBUS_VFHEADER
+
+/*============================================================================*/
+/**
+  A topic based publish and subscribe bus.
+
+  Publishers send typed messages to a topic, without knowing who is
+  listening. Subscribers register for a message type on a topic, together
+  with the CallQueue on which they want to receive the messages. This
+  replaces a collection of separate Listeners objects, one per publisher,
+  with a single bus shared by the application.
+
+  Topics are hierarchical, with levels separated by a slash. A subscription
+  receives messages sent to its topic and to every topic below it, so a
+  subscription to "audio" receives messages sent to "audio/levels/output".
+  A subscription to the empty topic receives everything of its type.
+
+  @code
+
+  struct OutputLevel
+  {
+    float level;
+  };
+
+  MessageBus bus;
+
+  struct VUMeter : MessageBus::Subscriber <OutputLevel>
+  {
+    VUMeter (GuiCallQueue& gui)
+    {
+      bus.subscribe <OutputLevel> (this, "audio/levels", gui);
+    }
+
+    ~VUMeter ()
+    {
+      bus.unsubscribe (this);
+    }
+
+    void onMessage (String const& topic, OutputLevel const& message)
+    {
+      // Called on the GuiCallQueue
+    }
+  };
+
+  void audioCallback ()
+  {
+    OutputLevel message = { calcOutputLevel () };
+
+    bus.publish ("audio/levels/output", message);
+  }
+
+  @endcode
+
+  Messages are batched per destination CallQueue. When a message is
+  published, it is appended to a pending list for each CallQueue with a
+  matching subscriber, and a single Work item is queued only if the list was
+  empty. That Work item delivers every message that arrived in the meantime,
+  so a burst of messages costs one queued functor per destination.
+
+  @invariant Messages published from the same thread are received in the
+             order they were published.
+
+  @invariant A subscriber does not receive messages published before it
+             subscribed, or delivered after unsubscribe() returns.
+
+  @invariant Subscribers may subscribe, unsubscribe and publish from
+             within onMessage().
+
+  @note The message type must be copy constructible. Each published message
+        is copied once, and the copy is shared by all recipients.
+
+  @see Listeners, CallQueue
+
+  @ingroup vf_concurrent
+*/
+class MessageBus : Uncopyable
+{
+public:
+  typedef GlobalFifoFreeStore <MessageBus> AllocatorType;
+
+  class SubscriberBase;
+
+  template <class Message>
+  class Subscriber;
+
+  MessageBus ();
+
+  /** Destroy the bus.
+
+      @invariant All subscribers have unsubscribed.
+  */
+  ~MessageBus ();
+
+  /** Subscribe to messages of a type on a topic.
+
+      A subscriber may subscribe to more than one topic, or to the same
+      topic on more than one CallQueue.
+
+      @param subscriber The subscriber, which must derive from
+                        Subscriber <Message>.
+
+      @param topic      The topic to subscribe to.
+
+      @param callQueue  The CallQueue on which to receive messages.
+  */
+  template <class Message>
+  void subscribe (Subscriber <Message>* subscriber,
+                  String const& topic,
+                  CallQueue& callQueue)
+  {
+    subscribe_void (subscriber, getTypeId <Message> (), topic, callQueue);
+  }
+
+  /** Remove every subscription of a subscriber.
+
+      It is safe to call this from any thread, including from onMessage().
+      No further messages are delivered to the subscriber once this returns.
+
+      If the subscriber is in onMessage() on another thread, this waits for
+      it to return. So onMessage() must not wait for the thread that calls
+      unsubscribe().
+
+      @param subscriber The subscriber to remove.
+  */
+  void unsubscribe (SubscriberBase* subscriber);
+
+  /** Publish a message.
+
+      The message is copied, and delivered to every subscriber for its type
+      whose topic matches. It is safe to call this from any thread.
+
+      @param topic   The topic of the message.
+
+      @param message The message to send.
+  */
+  template <class Message>
+  void publish (String const& topic, Message const& message)
+  {
+    publishp (new (*m_allocator) EnvelopeType <Message> (
+      topic, getTypeId <Message> (), message));
+  }
+
+  /** Determine if a subscription topic matches the topic of a message.
+
+      @return `true` if the topics are equal, or if the message topic is
+              below the subscription topic in the hierarchy.
+  */
+  static bool topicMatches (String const& subscriptionTopic,
+                            String const& messageTopic);
+
+private:
+  class Envelope;
+  class Delivery;
+  class Destination;
+  class DeliverWork;
+  struct Subscription;
+  class SubscriptionArray;
+
+  typedef unsigned long sequence_t;
+  typedef List <Destination> Destinations;
+
+  template <class Message>
+  class EnvelopeType;
+
+  template <class Message>
+  static void const* getTypeId ()
+  {
+    static char const id = 0;
+
+    return &id;
+  }
+
+  void subscribe_void (SubscriberBase* subscriber,
+                       void const* typeId,
+                       String const& topic,
+                       CallQueue& callQueue);
+
+  void publishp (Envelope* envelope);
+
+private:
+  Destinations m_destinations;
+  sequence_t m_sequence;
+  CacheLine::Aligned <ReadWriteMutex> m_mutex;
+  AllocatorType::Ptr m_allocator;
+};
+
+//------------------------------------------------------------------------------
+
+/** A message in flight, shared by all of its recipients.
+
+    @internal
+*/
+class MessageBus::Envelope
+  : public ReferenceCountedObject
+  , public AllocatedBy <AllocatorType>
+{
+public:
+  Envelope (String const& topic, void const* typeId)
+    : m_topic (topic)
+    , m_typeId (typeId)
+    , m_sequence (0)
+  {
+  }
+
+  String const& getTopic () const
+  {
+    return m_topic;
+  }
+
+  void const* getTypeId () const
+  {
+    return m_typeId;
+  }
+
+private:
+  friend class MessageBus;
+
+  String const m_topic;
+  void const* const m_typeId;
+  sequence_t m_sequence;
+};
+
+template <class Message>
+class MessageBus::EnvelopeType : public Envelope
+{
+public:
+  EnvelopeType (String const& topic, void const* typeId, Message const& message)
+    : Envelope (topic, typeId)
+    , m_message (message)
+  {
+  }
+
+  Message const& getMessage () const
+  {
+    return m_message;
+  }
+
+private:
+  Message const m_message;
+};
+
+//------------------------------------------------------------------------------
+
+/** Base for all subscribers.
+
+    @see Subscriber
+*/
+class MessageBus::SubscriberBase
+{
+public:
+  virtual ~SubscriberBase () { }
+
+private:
+  friend class MessageBus;
+
+  virtual void deliver (Envelope const& envelope) = 0;
+};
+
+/** A subscriber to messages of one type.
+
+    Derive from this once for each message type that is received. A class
+    which receives several message types must unsubscribe through each of
+    its Subscriber bases, for example
+    `bus.unsubscribe (static_cast <MessageBus::Subscriber <A>*> (this))`.
+
+    @ingroup vf_concurrent
+*/
+template <class Message>
+class MessageBus::Subscriber : public SubscriberBase
+{
+public:
+  /** Called on the subscription's CallQueue for each matching message.
+
+      @param topic   The topic the message was published to.
+
+      @param message The message. It is shared with other recipients, and
+                     only valid for the duration of the call.
+  */
+  virtual void onMessage (String const& topic, Message const& message) = 0;
+
+private:
+  void deliver (Envelope const& envelope)
+  {
+    EnvelopeType <Message> const& e =
+      static_cast <EnvelopeType <Message> const&> (envelope);
+
+    onMessage (e.getTopic (), e.getMessage ());
+  }
+};
+
+#endif
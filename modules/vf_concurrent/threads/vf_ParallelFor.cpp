@@ -43,6 +43,8 @@ int ParallelFor::getNumberOfThreads () const
 
 void ParallelFor::doLoop (int numberOfIterations, Iteration& iteration)
 {
+  VF_TRACE_SCOPE ("ParallelFor");
+
   if (numberOfIterations > 1)
   {
     int const numberOfThreads = m_pool.getNumberOfThreads ();
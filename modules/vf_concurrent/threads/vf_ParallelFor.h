@@ -99,6 +99,26 @@ public:
       @param f The functor to call for each loop index.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void loopf (int numberOfIterations, Functor&& f)
+  {
+    IterationType <typename std::decay <Functor>::type> iteration (
+      std::forward <Functor> (f));
+
+    doLoop (numberOfIterations, iteration);
+  }
+
+  // The arguments are moved or copied once, and shared by all iterations.
+  template <class Fn, class... Args>
+  void loop (int n, Fn&& f, Args&&... args)
+  {
+    IterationType <BoundCall <Fn, Args...> > iteration (
+      std::forward <Fn> (f), std::forward <Args> (args)...);
+
+    doLoop (n, iteration);
+  }
+#else
   template <class Functor>
   void loopf (int numberOfIterations, Functor const& f)
   {
@@ -142,6 +162,7 @@ public:
   template <class Fn, class T1, class T2, class T3, class T4, class T5, class T6, class T7, class T8>
   void loop (int n, Fn f, T1 t1, T2 t2, T3 t3, T4 t4, T5 t5, T6 t6, T7 t7, T8 t8)
   { loopf (n, vf::bind (f, t1, t2, t3, t4, t5, t6, t7, t8, vf::_1)); }
+#endif
   /** @} */
 
 private:
@@ -156,9 +177,16 @@ private:
   class IterationType : public Iteration, Uncopyable
   {
   public:
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+    template <class... Args>
+    explicit IterationType (Args&&... args) : m_f (std::forward <Args> (args)...)
+    {
+    }
+#else
     explicit IterationType (Functor const& f) : m_f (f)
     {
     }
+#endif
 
     void operator () (int loopIndex)
     {
@@ -202,6 +230,8 @@ private:
 
     void forLoopBody ()
     {
+      VF_TRACE_SCOPE ("ParallelFor::forLoopBody");
+
       for (;;)
       {
         // Request a loop index to process.
@@ -373,6 +403,8 @@ private:
 
     void forLoopBody ()
     {
+      VF_TRACE_SCOPE ("ParallelFor::forLoopBody");
+
       Iterator* iterator = m_factory (m_allocator);
 
       for (;;)
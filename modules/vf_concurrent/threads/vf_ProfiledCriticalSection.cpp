@@ -0,0 +1,93 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+ProfiledCriticalSection::ProfiledCriticalSection (String const& name)
+#if VF_USE_METRICS
+  : m_metrics (new LockMetrics ("CriticalSection", name))
+#endif
+{
+  (void) name;
+}
+
+ProfiledCriticalSection::~ProfiledCriticalSection ()
+{
+}
+
+void ProfiledCriticalSection::enter () const noexcept
+{
+#if VF_USE_METRICS
+  LockMetrics::Acquisition acquisition (m_metrics);
+
+  if (!acquisition.isProfiling () || !m_mutex.tryEnter ())
+  {
+    acquisition.contended ();
+
+    m_mutex.enter ();
+  }
+
+  acquisition.acquired (LockMetrics::exclusive);
+
+  if (m_metrics != nullptr)
+    m_metrics->exclusiveEntered ();
+#else
+  m_mutex.enter ();
+#endif
+}
+
+bool ProfiledCriticalSection::tryEnter () const noexcept
+{
+  bool const entered = m_mutex.tryEnter ();
+
+#if VF_USE_METRICS
+  if (entered)
+  {
+    LockMetrics::Acquisition acquisition (m_metrics);
+
+    acquisition.acquired (LockMetrics::exclusive);
+
+    if (m_metrics != nullptr)
+      m_metrics->exclusiveEntered ();
+  }
+#endif
+
+  return entered;
+}
+
+void ProfiledCriticalSection::exit () const noexcept
+{
+#if VF_USE_METRICS
+  if (m_metrics != nullptr)
+    m_metrics->exclusiveExited ();
+#endif
+
+  m_mutex.exit ();
+}
@@ -0,0 +1,86 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_PROFILEDCRITICALSECTION_VFHEADER
+#define VF_PROFILEDCRITICALSECTION_VFHEADER
+
+/*============================================================================*/
+/**
+  A CriticalSection which reports contention under a name.
+
+  This is a drop-in replacement for CriticalSection. When VF_USE_METRICS is
+  set it reports through LockMetrics, otherwise it is a plain
+  CriticalSection.
+
+  @code
+
+  ProfiledCriticalSection m_mutex ("PluginHost::m_mutex");
+
+  void PluginHost::process ()
+  {
+    ProfiledCriticalSection::ScopedLockType lock (m_mutex);
+
+    // ...
+  }
+
+  @endcode
+
+  @ingroup vf_concurrent
+*/
+class ProfiledCriticalSection : Uncopyable
+{
+public:
+  typedef GenericScopedLock <ProfiledCriticalSection> ScopedLockType;
+  typedef GenericScopedUnlock <ProfiledCriticalSection> ScopedUnlockType;
+  typedef GenericScopedTryLock <ProfiledCriticalSection> ScopedTryLockType;
+
+  explicit ProfiledCriticalSection (String const& name);
+
+  ~ProfiledCriticalSection ();
+
+  /** Acquire the lock. This is recursive. */
+  void enter () const noexcept;
+
+  /** Acquire the lock if it is not held by another thread. */
+  bool tryEnter () const noexcept;
+
+  /** Release the lock. */
+  void exit () const noexcept;
+
+private:
+  CriticalSection m_mutex;
+#if VF_USE_METRICS
+  ScopedPointer <LockMetrics> m_metrics;
+#endif
+};
+
+#endif
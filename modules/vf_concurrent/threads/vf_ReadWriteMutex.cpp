@@ -34,12 +34,24 @@ ReadWriteMutex::ReadWriteMutex () noexcept
 {
 }
 
+ReadWriteMutex::ReadWriteMutex (String const& name)
+#if VF_USE_METRICS
+  : m_metrics (new LockMetrics ("ReadWriteMutex", name))
+#endif
+{
+  (void) name;
+}
+
 ReadWriteMutex::~ReadWriteMutex () noexcept
 {
 }
 
 void ReadWriteMutex::enterRead () const noexcept
 {
+#if VF_USE_METRICS
+  LockMetrics::Acquisition acquisition (m_metrics);
+#endif
+
   for (;;)
   {
     // attempt the lock optimistically
@@ -53,6 +65,11 @@ void ReadWriteMutex::enterRead () const noexcept
       // a writer exists, give up the read lock
       m_readers->release ();
 
+#if VF_USE_METRICS
+      acquisition.contended ();
+      acquisition.spin ();
+#endif
+
       // block until the writer is done
       {
         CriticalSection::ScopedLockType lock (m_mutex);
@@ -65,6 +82,10 @@ void ReadWriteMutex::enterRead () const noexcept
       break;
     }
   }
+
+#if VF_USE_METRICS
+  acquisition.acquired (LockMetrics::shared);
+#endif
 }
 
 void ReadWriteMutex::exitRead () const noexcept
@@ -79,7 +100,18 @@ void ReadWriteMutex::enterWrite () const noexcept
 
   // Go for the mutex.
   // Another writer might block us here.
+#if VF_USE_METRICS
+  LockMetrics::Acquisition acquisition (m_metrics);
+
+  if (!acquisition.isProfiling () || !m_mutex.tryEnter ())
+  {
+    acquisition.contended ();
+
+    m_mutex.enter ();
+  }
+#else
   m_mutex.enter ();
+#endif
 
   // Only one competing writer will get here,
   // but we don't know who, so we have to drain
@@ -88,13 +120,28 @@ void ReadWriteMutex::enterWrite () const noexcept
   //
   if (m_readers->isSignaled ())
   {
+#if VF_USE_METRICS
+    acquisition.contended ();
+#endif
+
     SpinDelay delay; 
     do
     {
       delay.pause ();
+
+#if VF_USE_METRICS
+      acquisition.spin ();
+#endif
     }
     while (m_readers->isSignaled ());
   }
+
+#if VF_USE_METRICS
+  acquisition.acquired (LockMetrics::exclusive);
+
+  if (m_metrics != nullptr)
+    m_metrics->exclusiveEntered ();
+#endif
 }
 
 void ReadWriteMutex::exitWrite () const noexcept
@@ -104,6 +151,11 @@ void ReadWriteMutex::exitWrite () const noexcept
   // acquire the lock, thus starving readers. This fulfills
   // the write-preferencing requirement.
 
+#if VF_USE_METRICS
+  if (m_metrics != nullptr)
+    m_metrics->exclusiveExited ();
+#endif
+
   m_mutex.exit ();
 
   m_writes->release ();
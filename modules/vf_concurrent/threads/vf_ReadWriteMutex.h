@@ -56,6 +56,9 @@
   The implementation is wait-free in the fast path: acquiring read access
   for a lock without contention - just one interlocked increment!
 
+  A mutex constructed with a name reports contention through LockMetrics
+  when VF_USE_METRICS is set. The time read access is held is not measured.
+
   @class ReadWriteMutex
   @ingroup vf_concurrent
 */
@@ -119,6 +122,12 @@ public:
 
   /** Create a ReadWriteMutex */
   ReadWriteMutex () noexcept;
+
+  /** Create a ReadWriteMutex which reports contention under a name.
+
+      @see LockMetrics
+  */
+  explicit ReadWriteMutex (String const& name);
   
   /** Destroy a ReadWriteMutex
 
@@ -152,6 +161,9 @@ private:
 
   mutable CacheLine::Padded <AtomicCounter> m_writes;
   mutable CacheLine::Padded <AtomicCounter> m_readers;
+#if VF_USE_METRICS
+  ScopedPointer <LockMetrics> m_metrics;
+#endif
 };
 
 #endif
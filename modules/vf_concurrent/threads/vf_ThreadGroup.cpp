@@ -37,11 +37,28 @@ void ThreadGroup::QuitType::operator() (Worker* worker)
 
 //==============================================================================
 
-ThreadGroup::Worker::Worker (String name, ThreadGroup& group)
+ThreadGroup::Options::Options ()
+  : numberOfThreads (SystemStats::getNumCpus ())
+{
+}
+
+//==============================================================================
+
+ThreadGroup::Worker::Worker (String name,
+                             int index,
+                             Options const& options,
+                             ThreadGroup& group)
   : Thread (name)
   , m_group (group)
+  , m_index (index)
+  , m_scheduling (options.scheduling)
+  , m_onThreadStart (options.onThreadStart)
+  , m_onThreadExit (options.onThreadExit)
   , m_shouldExit (false)
 {
+  if (!options.workerCpus.empty ())
+    m_scheduling.cpus = options.workerCpus [index % options.workerCpus.size ()];
+
   startThread ();
 }
 
@@ -58,6 +75,17 @@ void ThreadGroup::Worker::setShouldExit ()
 
 void ThreadGroup::Worker::run ()
 {
+  bool const applied = m_scheduling.applyToCurrentThread ();
+
+  // If this goes off it means some of the scheduling could not be
+  // applied, for example SCHED_FIFO requires privileges which we
+  // might not have. This is not fatal, the rest is still applied.
+  //
+  jassert (applied);
+  (void) applied;
+
+  m_onThreadStart (m_index);
+
   do
   {
     m_group.m_semaphore.wait ();
@@ -66,11 +94,17 @@ void ThreadGroup::Worker::run ()
 
     jassert (work != nullptr);
 
-    work->operator() (this);
+    {
+      VF_TRACE_SCOPE (typeid (*work).name ());
+
+      work->operator() (this);
+    }
 
     delete work;
   }
   while (!m_shouldExit);
+
+  m_onThreadExit (m_index);
 }
 
 //==============================================================================
@@ -79,12 +113,29 @@ ThreadGroup::ThreadGroup (int numberOfThreads)
   : m_numberOfThreads (numberOfThreads)
   , m_semaphore (0)
 {
-  for (int i = 0; i++ < numberOfThreads; )
+  Options options;
+  options.numberOfThreads = numberOfThreads;
+
+  createThreads (options);
+}
+
+ThreadGroup::ThreadGroup (Options const& options)
+  : m_numberOfThreads (options.numberOfThreads)
+  , m_semaphore (0)
+{
+  createThreads (options);
+}
+
+void ThreadGroup::createThreads (Options const& options)
+{
+  jassert (options.numberOfThreads > 0);
+
+  for (int i = 0; i < options.numberOfThreads; ++i)
   {
     String s;
-    s << "ThreadGroup (" << i << ")";
+    s << "ThreadGroup (" << (i + 1) << ")";
 
-    m_threads.push_front (new Worker (s, *this));
+    m_threads.push_front (new Worker (s, i, options, *this));
   }
 }
 
@@ -39,6 +39,9 @@
 
   @brief A group of threads for parallelizing tasks.
 
+  The placement and scheduling of the worker threads can be controlled by
+  constructing the group with Options.
+
   @see ParallelFor
 */
 class ThreadGroup
@@ -46,6 +49,49 @@ class ThreadGroup
 public:
   typedef FifoFreeStoreType AllocatorType;
 
+  /** Options for creating a ThreadGroup.
+  */
+  class Options
+  {
+  public:
+    /** A function called on a worker thread with the zero based worker index.
+    */
+    typedef Function <void (int)> hook_t;
+
+    /** Create default options.
+
+        The default options create one thread per available CPU, with the
+        default scheduling and no hooks.
+    */
+    Options ();
+
+    /** The number of threads in the group.
+
+        This must be greater than zero.
+    */
+    int numberOfThreads;
+
+    /** The scheduling applied to every worker.
+    */
+    ThreadScheduling scheduling;
+
+    /** The processors for each worker.
+
+        When this is not empty, worker `i` runs on the processors in element
+        `i % workerCpus.size ()`, replacing the processors in scheduling. This
+        is used to pin each worker to its own processor.
+    */
+    std::vector <ThreadScheduling::CpuSet> workerCpus;
+
+    /** Called on each worker when it starts, after the scheduling is applied.
+    */
+    hook_t onThreadStart;
+
+    /** Called on each worker just before it exits.
+    */
+    hook_t onThreadExit;
+  };
+
   /** Creates the specified number of threads.
 
       @param numberOfThreads The number of threads in the group. This must be
@@ -54,6 +100,12 @@ public:
   */
   explicit ThreadGroup (int numberOfThreads = SystemStats::getNumCpus ());
 
+  /** Creates threads using the specified options.
+
+      @param options The options for the group and its workers.
+  */
+  explicit ThreadGroup (Options const& options);
+
   ~ThreadGroup ();
 
   /** Allocator access.
@@ -72,13 +124,77 @@ public:
   /** Calls a functor on multiple threads.
 
       The specified functor is executed on some or all available threads at once.
-      A call is always guaranteed to execute.
+      A call is always guaranteed to execute. With C++11, a functor which can't
+      be copied, such as a UniqueFunction, is accepted only when it is called
+      on one thread, with maxThreads equal to 1.
 
       @param maxThreads The maximum number of threads to use, or -1 for all.
 
       @param f The functor to call for each thread.
   */
   /** @{ */
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+  template <class Functor>
+  void callf (int maxThreads, Functor&& f)
+  {
+    callInPlace <typename std::decay <Functor>::type> (
+      maxThreads, std::forward <Functor> (f));
+  }
+
+  // The arguments are moved or copied once into the first work item. Any
+  // other threads receive copies of that item.
+  template <class Fn, class... Args>
+  void call (int maxThreads, Fn&& f, Args&&... args)
+  {
+    callInPlace <BoundCall <Fn, Args...> > (
+      maxThreads, std::forward <Fn> (f), std::forward <Args> (args)...);
+  }
+  /** @} */
+
+private:
+  template <class Functor>
+  class WorkType;
+
+  template <class Functor, class... Args>
+  void callInPlace (int maxThreads, Args&&... args)
+  {
+    jassert (maxThreads > 0 || maxThreads == -1);
+
+    int numberOfThreads = getNumberOfThreads ();
+
+    if (maxThreads != -1 && maxThreads < numberOfThreads)
+      numberOfThreads = maxThreads;
+
+    WorkType <Functor>* const work = new (getAllocator ())
+      WorkType <Functor> (std::forward <Args> (args)...);
+
+    // Copy before pushing the original, which may run at once.
+    queueCopies (work, numberOfThreads - 1, std::is_copy_constructible <Functor> ());
+
+    m_queue.push_front (work);
+    m_semaphore.signal ();
+  }
+
+  template <class Functor>
+  void queueCopies (WorkType <Functor>* work, int numberOfCopies, std::true_type)
+  {
+    for (int i = 0; i < numberOfCopies; ++i)
+    {
+      m_queue.push_front (new (getAllocator ()) WorkType <Functor> (work->getFunctor ()));
+      m_semaphore.signal ();
+    }
+  }
+
+  template <class Functor>
+  void queueCopies (WorkType <Functor>*, int numberOfCopies, std::false_type)
+  {
+    // If this goes off it means a functor which can't be copied
+    // was called on more than one thread. Use maxThreads == 1.
+    jassert (numberOfCopies == 0);
+  }
+
+public:
+#else
   template <class Functor>
   void callf (int maxThreads, Functor f)
   {
@@ -133,8 +249,74 @@ public:
     { callf (maxThreads, vf::bind (f, t1, t2, t3, t4, t5, t6, t7, t8)); }
 
   /** @} */
+#endif
+
+#if VF_USE_COROUTINES
+  /** Awaitable which resumes a coroutine on a thread in the group.
+
+      @see schedule
+  */
+  class ScheduleAwaiter
+  {
+  public:
+    explicit ScheduleAwaiter (ThreadGroup& group) : m_group (group)
+    {
+    }
+
+    bool await_ready () const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend (std::coroutine_handle <> handle)
+    {
+      m_group.callf (1, Resume (handle));
+    }
+
+    void await_resume () const noexcept
+    {
+    }
+
+  private:
+    struct Resume
+    {
+      explicit Resume (std::coroutine_handle <> handle) : m_handle (handle) { }
+      void operator() () { m_handle.resume (); }
+      std::coroutine_handle <> m_handle;
+    };
+
+    ThreadGroup& m_group;
+  };
+
+  /** Continue a coroutine on one of the threads in the group.
+
+      @code
+
+      CoroutineTask process (ThreadGroup& group, CallQueue& gui)
+      {
+        co_await group.schedule ();
+
+        Result result = compute ();
+
+        co_await gui.resumeOn ();
+
+        display (result);
+      }
+
+      @endcode
+
+      @note This is only available when VF_USE_COROUTINES is set.
+
+      @see CoroutineTask
+  */
+  ScheduleAwaiter schedule ()
+  {
+    return ScheduleAwaiter (*this);
+  }
+#endif
 
 private:
+  void createThreads (Options const& options);
   void stopThreads (int numberOfThreadsToStop);
 
   //============================================================================
@@ -147,7 +329,7 @@ private:
     , LeakChecked <Worker>
   {
   public:
-    Worker (String name, ThreadGroup& group);
+    Worker (String name, int index, Options const& options, ThreadGroup& group);
     ~Worker ();
 
     void setShouldExit ();
@@ -157,6 +339,10 @@ private:
 
   private:
     ThreadGroup& m_group;
+    int const m_index;
+    ThreadScheduling m_scheduling;
+    Options::hook_t m_onThreadStart;
+    Options::hook_t m_onThreadExit;
     bool m_shouldExit;
   };
 
@@ -179,7 +365,14 @@ private:
   class WorkType : public Work, LeakChecked <WorkType <Functor> >
   {
   public:
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+    // Constructs the functor in place from the arguments.
+    template <class... Args>
+    explicit WorkType (Args&&... args) : m_f (std::forward <Args> (args)...) { }
+    Functor& getFunctor () { return m_f; }
+#else
     explicit WorkType (Functor const& f) : m_f (f) { }
+#endif
     ~WorkType () { }
     void operator() (Worker*) { m_f (); }
 
@@ -148,8 +148,9 @@ void ThreadWithCallQueue::run ()
     if (!interrupted)
       interrupted = interruptionPoint ();
 
+    // Sleep no longer than the earliest timed functor allows.
     if (!interrupted)
-      m_thread.wait ();
+      m_thread.wait (getMillisecondsUntilNextDeadline ());
   }
 
   m_exit ();
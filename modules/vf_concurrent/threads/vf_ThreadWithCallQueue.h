@@ -43,7 +43,9 @@
   The thread runs an optional user-defined idle function, which must regularly
   check for an interruption using the InterruptibleThread interface. When an
   interruption is signaled, the idle function returns and the CallQueue is
-  synchronized. Then, the idle function is resumed.
+  synchronized. Then, the idle function is resumed. While there is nothing to
+  do, the thread sleeps until it is signaled or the earliest functor added
+  with callAt() or callAfter() becomes due.
 
   When the ThreadWithCallQueue first starts up, an optional user-defined
   initialization function is executed on the thread. When the thread exits,
@@ -56,16 +56,23 @@ namespace vf
 #include "memory/vf_PagedFreeStore.cpp"
 
 #include "threads/vf_CallQueue.cpp"
+#include "threads/vf_CallQueueTimer.cpp"
 #include "threads/vf_ConcurrentObject.cpp"
+#include "threads/vf_Future.cpp"
 #include "threads/vf_Listeners.cpp"
+#include "threads/vf_LockMetrics.cpp"
 #include "threads/vf_ManualCallQueue.cpp"
+#include "threads/vf_MessageBus.cpp"
 #include "threads/vf_MessageThread.cpp"
 #include "threads/vf_ParallelFor.cpp"
+#include "threads/vf_ProfiledCriticalSection.cpp"
 #include "threads/vf_ReadWriteMutex.cpp"
 #include "threads/vf_ThreadGroup.cpp"
 #include "threads/vf_ThreadWithCallQueue.cpp"
 
 #include "threads/vf_GuiCallQueue.cpp"
+
+#include "diagnostic/vf_ConcurrentBenchmark.cpp"
 }
 
 #if JUCE_MSVC
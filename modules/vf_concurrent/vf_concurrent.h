@@ -158,21 +158,29 @@ namespace vf
 #include "memory/vf_GlobalPagedFreeStore.h"
 #include "memory/vf_PagedFreeStore.h"
 
+#include "threads/vf_LockMetrics.h"
+#include "threads/vf_ProfiledCriticalSection.h"
 #include "threads/vf_ReadWriteMutex.h"
 #include "threads/vf_ThreadGroup.h"
 
 #include "threads/vf_CallQueue.h"
+#include "threads/vf_CallQueueTimer.h"
 #include "threads/vf_ConcurrentObject.h"
 #include "threads/vf_ConcurrentState.h"
+#include "threads/vf_CoroutineTask.h"
+#include "threads/vf_Future.h"
 #include "threads/vf_GlobalThreadGroup.h"
 #include "threads/vf_Listeners.h"
 #include "threads/vf_ManualCallQueue.h"
+#include "threads/vf_MessageBus.h"
 #include "threads/vf_ParallelFor.h"
 #include "threads/vf_ThreadWithCallQueue.h"
 
 #include "threads/vf_GuiCallQueue.h"
 
 #include "threads/vf_MessageThread.h"
+
+#include "diagnostic/vf_ConcurrentBenchmark.h"
 }
 
 #endif
@@ -0,0 +1,587 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_CONCURRENTHASHMAP_VFHEADER
+#define VF_CONCURRENTHASHMAP_VFHEADER
+
+#include "vf_LockFreeStack.h"
+#include "../math/vf_MurmurHash.h"
+#include "../threads/vf_SpinDelay.h"
+
+/*============================================================================*/
+/**
+  Concurrent hash map with lock-free reads.
+
+  This replaces a HashMap wrapped in a ConcurrentState, for registries which
+  are read far more often than they are changed. Lookups never block, and
+  changes to different keys usually proceed in parallel.
+
+  - Keys hash to chains of immutable nodes. Readers walk the chains without
+    any lock. Changing a value replaces its node. Chaining is used instead
+    of open addressing so that a change is one atomic pointer store. An open
+    addressed slot would be rewritten while readers may be copying it.
+
+  - Writers lock one of a fixed set of stripes, chosen by hash, so writers
+    only contend when their keys share a stripe.
+
+  - The table doubles when it becomes three quarters full. Growing locks
+    every stripe and publishes a new table atomically; readers see either
+    the old table or the new one.
+
+  - Replaced nodes and tables are freed once no reader can still see them.
+    Readers announce themselves in one of two epoch counters, and the writer
+    that frees memory waits for the counter of the previous epoch to drain.
+
+  Values are copied out of the map, so Value should be cheap to copy. Use a
+  pointer or a ReferenceCountedObjectPtr for large objects.
+
+  @code
+
+  ConcurrentHashMap <int, Session::Ptr> sessions;
+
+  sessions.set (id, session);
+
+  Session::Ptr session;
+  if (sessions.find (id, session))
+    session->touch ();
+
+  @endcode
+
+  @param Key   The key type, which must be copy constructible and
+               equality comparable.
+
+  @param Value The mapped type, which must be copy constructible.
+
+  @param Hash  A function object returning a uint32 for a key. The default
+               uses MurmurHash, which hashes the bytes of plain keys.
+
+  @ingroup vf_core
+*/
+template <class Key, class Value, class Hash = Murmur::HashFunction <Key> >
+class ConcurrentHashMap : Uncopyable
+{
+public:
+  typedef Key   KeyType;
+  typedef Value ValueType;
+
+  /** Create an empty map.
+
+      @param initialCapacity The number of items to make room for.
+  */
+  explicit ConcurrentHashMap (int initialCapacity = 0, Hash const& hash = Hash ())
+    : m_hash (hash)
+  {
+    int const wanted = jmax (int (numberOfStripes),
+                             initialCapacity * 100 / maxLoadPercent + 1);
+
+    int numberOfBuckets = numberOfStripes;
+    while (numberOfBuckets < wanted)
+      numberOfBuckets *= 2;
+
+    m_table.set (new Table (numberOfBuckets));
+  }
+
+  /** Destroy the map.
+
+      No other thread may be using the map.
+  */
+  ~ConcurrentHashMap ()
+  {
+    destroyTable (m_table.get ());
+
+    LockFreeStack <Garbage> garbage (m_garbage);
+
+    for (;;)
+    {
+      Garbage* const g = garbage.pop_front ();
+
+      if (g == nullptr)
+        break;
+
+      delete g;
+    }
+  }
+
+  /** Retrieve the number of items.
+  */
+  int size () const
+  {
+    return m_size.get ();
+  }
+
+  /** Look up a key.
+
+      This is lock-free.
+
+      @param key   The key to look up.
+
+      @param value Receives a copy of the value, if the key was found.
+
+      @return `true` if the key was found.
+  */
+  bool find (Key const& key, Value& value) const
+  {
+    uint32 const hash = m_hash (key);
+
+    ReadLock lock (*this);
+
+    Node const* const node = findNode (m_table.get (), hash, key);
+
+    if (node != nullptr)
+      value = node->value;
+
+    return node != nullptr;
+  }
+
+  /** Determine if a key is in the map.
+
+      This is lock-free.
+  */
+  bool contains (Key const& key) const
+  {
+    uint32 const hash = m_hash (key);
+
+    ReadLock lock (*this);
+
+    return findNode (m_table.get (), hash, key) != nullptr;
+  }
+
+  /** Add a key if it is not already present.
+
+      @return `true` if the key was added.
+  */
+  bool insert (Key const& key, Value const& value)
+  {
+    return put (key, value, false);
+  }
+
+  /** Add a key, or replace its value.
+
+      @return `true` if the key was added, `false` if it was replaced.
+  */
+  bool set (Key const& key, Value const& value)
+  {
+    return put (key, value, true);
+  }
+
+  /** Remove a key.
+
+      @return `true` if the key was removed.
+  */
+  bool erase (Key const& key)
+  {
+    uint32 const hash = m_hash (key);
+
+    bool erased = false;
+
+    {
+      SpinLock::ScopedLockType lock (m_stripes [hash & (numberOfStripes - 1)]);
+
+      Table* const table = m_table.get ();
+
+      AtomicPointer <Node>* link = &table->buckets [hash & table->mask];
+
+      for (Node* node = link->get (); node != nullptr; node = link->get ())
+      {
+        if (node->hash == hash && node->key == key)
+        {
+          // Readers on this node still reach the rest of the chain.
+          link->set (node->next.get ());
+
+          --m_size;
+
+          retire (node);
+
+          erased = true;
+          break;
+        }
+
+        link = &node->next;
+      }
+    }
+
+    reclaimIfNeeded ();
+
+    return erased;
+  }
+
+  /** Remove every key.
+  */
+  void clear ()
+  {
+    lockAllStripes ();
+
+    Table* const table = m_table.get ();
+
+    m_table.set (new Table (table->mask + 1));
+    m_size.set (0);
+
+    retireTable (table);
+
+    unlockAllStripes ();
+
+    reclaimIfNeeded ();
+  }
+
+  /** Call a function for every item.
+
+      This is lock-free. The function receives the key and the value. Items
+      which are added or removed during the call may or may not be visited.
+
+      @invariant The function does not change the map. Freeing removed items
+                 waits for readers to finish, so a change made from within
+                 the visit could wait forever.
+  */
+  template <class Functor>
+  void visit (Functor f) const
+  {
+#if VF_DEBUG
+    ++m_visiting.get ();
+#endif
+
+    ReadLock lock (*this);
+
+    Table const* const table = m_table.get ();
+
+    for (int i = 0; i <= table->mask; ++i)
+    {
+      for (Node const* node = table->buckets [i].get ();
+           node != nullptr;
+           node = node->next.get ())
+      {
+        f (node->key, node->value);
+      }
+    }
+
+#if VF_DEBUG
+    --m_visiting.get ();
+#endif
+  }
+
+private:
+  enum
+  {
+    numberOfStripes = 16,     // Must be a power of two
+    maxLoadPercent = 75,
+    reclaimThreshold = 128
+  };
+
+  // Anything that is freed once readers are done with it.
+  class Garbage : public LockFreeStack <Garbage>::Node
+  {
+  public:
+    virtual ~Garbage () { }
+  };
+
+  class Node : public Garbage
+  {
+  public:
+    Node (uint32 hash_, Key const& key_, Value const& value_, Node* next_)
+      : hash (hash_)
+      , key (key_)
+      , value (value_)
+    {
+      next.set (next_);
+    }
+
+    uint32 const hash;
+    Key const key;
+    Value const value;
+    AtomicPointer <Node> next;
+  };
+
+  class Table : public Garbage
+  {
+  public:
+    explicit Table (int numberOfBuckets)
+      : mask (numberOfBuckets - 1)
+    {
+      // Zero filled memory is a null AtomicPointer.
+      buckets.calloc (numberOfBuckets);
+    }
+
+    int const mask;
+    HeapBlock <AtomicPointer <Node> > buckets;
+  };
+
+  // Counts the readers of an epoch. Padded so that the two
+  // counters, which every reader touches, share no cache line.
+  struct ReaderCount
+  {
+    Atomic <int> count;
+    char padding [64 - sizeof (Atomic <int>)];
+  };
+
+  class ReadLock : Uncopyable
+  {
+  public:
+    explicit ReadLock (ConcurrentHashMap const& map)
+      : m_map (map)
+      , m_slot (map.enterRead ())
+    {
+    }
+
+    ~ReadLock ()
+    {
+      m_map.exitRead (m_slot);
+    }
+
+  private:
+    ConcurrentHashMap const& m_map;
+    int const m_slot;
+  };
+
+  int enterRead () const
+  {
+    for (;;)
+    {
+      int const epoch = m_epoch.get ();
+      int const slot = epoch & 1;
+
+      ++m_readers [slot].count;
+
+      // If the epoch moved on, the reclaimer may not wait for us.
+      if (m_epoch.get () == epoch)
+        return slot;
+
+      --m_readers [slot].count;
+    }
+  }
+
+  void exitRead (int slot) const
+  {
+    --m_readers [slot].count;
+  }
+
+  static Node* findNode (Table const* table, uint32 hash, Key const& key)
+  {
+    Node* node = table->buckets [hash & table->mask].get ();
+
+    while (node != nullptr && !(node->hash == hash && node->key == key))
+      node = node->next.get ();
+
+    return node;
+  }
+
+  bool put (Key const& key, Value const& value, bool replace)
+  {
+    uint32 const hash = m_hash (key);
+
+    bool inserted;
+
+    {
+      SpinLock::ScopedLockType lock (m_stripes [hash & (numberOfStripes - 1)]);
+
+      Table* const table = m_table.get ();
+
+      AtomicPointer <Node>& bucket = table->buckets [hash & table->mask];
+      AtomicPointer <Node>* link = &bucket;
+
+      Node* node = link->get ();
+
+      while (node != nullptr && !(node->hash == hash && node->key == key))
+      {
+        link = &node->next;
+        node = link->get ();
+      }
+
+      if (node == nullptr)
+      {
+        bucket.set (new Node (hash, key, value, bucket.get ()));
+
+        ++m_size;
+
+        inserted = true;
+      }
+      else
+      {
+        if (replace)
+        {
+          link->set (new Node (hash, key, value, node->next.get ()));
+
+          retire (node);
+        }
+
+        inserted = false;
+      }
+    }
+
+    if (inserted)
+      growIfNeeded ();
+
+    reclaimIfNeeded ();
+
+    return inserted;
+  }
+
+  void growIfNeeded ()
+  {
+    if (m_size.get () * 100 > (m_table.get ()->mask + 1) * maxLoadPercent)
+    {
+      lockAllStripes ();
+
+      Table* const table = m_table.get ();
+
+      // Someone else might have grown it already.
+      if (m_size.get () * 100 > (table->mask + 1) * maxLoadPercent)
+      {
+        Table* const bigger = new Table ((table->mask + 1) * 2);
+
+        for (int i = 0; i <= table->mask; ++i)
+        {
+          for (Node* node = table->buckets [i].get ();
+               node != nullptr;
+               node = node->next.get ())
+          {
+            AtomicPointer <Node>& bucket = bigger->buckets [node->hash & bigger->mask];
+
+            bucket.set (new Node (node->hash, node->key, node->value, bucket.get ()));
+          }
+        }
+
+        m_table.set (bigger);
+
+        retireTable (table);
+      }
+
+      unlockAllStripes ();
+    }
+  }
+
+  void lockAllStripes ()
+  {
+    for (int i = 0; i < numberOfStripes; ++i)
+      m_stripes [i].enter ();
+  }
+
+  void unlockAllStripes ()
+  {
+    for (int i = numberOfStripes; --i >= 0;)
+      m_stripes [i].exit ();
+  }
+
+  void retire (Garbage* garbage)
+  {
+    m_garbage.push_front (garbage);
+
+    ++m_garbageCount;
+  }
+
+  void retireTable (Table* table)
+  {
+    for (int i = 0; i <= table->mask; ++i)
+    {
+      for (Node* node = table->buckets [i].get (); node != nullptr;)
+      {
+        Node* const next = node->next.get ();
+        retire (node);
+        node = next;
+      }
+    }
+
+    retire (table);
+  }
+
+  void destroyTable (Table* table)
+  {
+    for (int i = 0; i <= table->mask; ++i)
+    {
+      for (Node* node = table->buckets [i].get (); node != nullptr;)
+      {
+        Node* const next = node->next.get ();
+        delete node;
+        node = next;
+      }
+    }
+
+    delete table;
+  }
+
+  // Everything in the garbage was unlinked before the epoch changes, so
+  // only readers of the epoch being ended can still see it. Readers of
+  // the epoch before that were waited for by the previous reclaim.
+  //
+  void reclaimIfNeeded ()
+  {
+#if VF_DEBUG
+    // If this goes off it means the map was changed from within visit().
+    jassert (m_visiting.get () == 0);
+#endif
+
+    if (m_garbageCount.get () >= reclaimThreshold && m_reclaimLock.tryEnter ())
+    {
+      LockFreeStack <Garbage> garbage (m_garbage);
+
+      int const epoch = m_epoch.get ();
+
+      m_epoch.set (epoch + 1);
+
+      SpinDelay delay;
+
+      while (m_readers [epoch & 1].count.get () != 0)
+        delay.pause ();
+
+      int count = 0;
+
+      for (;;)
+      {
+        Garbage* const g = garbage.pop_front ();
+
+        if (g == nullptr)
+          break;
+
+        delete g;
+        ++count;
+      }
+
+      m_garbageCount -= count;
+
+      m_reclaimLock.exit ();
+    }
+  }
+
+private:
+  Hash const m_hash;
+  AtomicPointer <Table> m_table;
+  Atomic <int> m_size;
+  Atomic <int> m_epoch;
+  mutable ReaderCount m_readers [2];
+  SpinLock m_stripes [numberOfStripes];
+  SpinLock m_reclaimLock;
+  LockFreeStack <Garbage> m_garbage;
+  Atomic <int> m_garbageCount;
+#if VF_DEBUG
+  mutable ThreadLocalValue <int> m_visiting;
+#endif
+};
+
+#endif
@@ -0,0 +1,342 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_INTERVALSET_VFHEADER
+#define VF_INTERVALSET_VFHEADER
+
+#include "../math/vf_Interval.h"
+
+/*============================================================================*/
+/**
+  A set of values represented as disjoint half-open intervals.
+
+  The set is stored in normal form: a sorted array of non-empty intervals
+  that neither intersect nor adjoin each other. Adding [0, 10) and [10, 20)
+  produces the single interval [0, 20). Empty intervals are ignored.
+
+  Queries use a binary search and take O(log n) time. An insertion or a
+  subtraction locates the affected intervals in O(log n), then replaces
+  them in place, which moves the rest of the array. The array is
+  contiguous, so this is cheap for the sizes that come up in practice:
+  dirty regions, sample ranges and selections.
+
+  @code
+
+  IntervalSet <int> dirty;
+  dirty.insert (Interval <int> (0, 100));
+  dirty.subtract (Interval <int> (40, 60));
+
+  jassert (dirty.size () == 2);
+  jassert (dirty.contains (20) && ! dirty.contains (50));
+
+  @endcode
+
+  @tparam Ty A scalar numerical type.
+
+  @ingroup vf_core
+*/
+template <class Ty>
+class IntervalSet
+{
+public:
+  typedef Interval <Ty> IntervalType;
+
+  /** Create an empty set.
+  */
+  IntervalSet ()
+  {
+  }
+
+  /** Determine if the set is empty.
+  */
+  bool isEmpty () const noexcept
+  {
+    return m_intervals.empty ();
+  }
+
+  /** Returns the number of disjoint intervals in the set.
+  */
+  int size () const noexcept
+  {
+    return int (m_intervals.size ());
+  }
+
+  /** Retrieve one of the intervals, in increasing order.
+
+      @param index The index of the interval, from 0 to size ().
+  */
+  IntervalType const& operator[] (int index) const noexcept
+  {
+    jassert (isPositiveAndBelow (index, size ()));
+
+    return m_intervals [index];
+  }
+
+  /** Remove all intervals.
+  */
+  void clear ()
+  {
+    m_intervals.clear ();
+  }
+
+  /** Returns the smallest interval containing the whole set.
+
+      The result is empty if the set is empty.
+  */
+  IntervalType getBounds () const
+  {
+    return isEmpty () ? IntervalType::none
+                      : IntervalType (m_intervals.front ().begin (), m_intervals.back ().end ());
+  }
+
+  /** Returns the sum of the lengths of the intervals.
+  */
+  Ty getTotalLength () const
+  {
+    Ty total = Ty ();
+
+    for (typename Intervals::const_iterator iter = m_intervals.begin ();
+         iter != m_intervals.end (); ++iter)
+      total += iter->length ();
+
+    return total;
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Add an interval to the set.
+
+      The interval is merged with the intervals that it intersects or
+      adjoins.
+  */
+  void insert (IntervalType const& interval)
+  {
+    if (interval.notEmpty ())
+    {
+      // Intervals which end before the new one begins are unaffected,
+      // as are those which begin after it ends.
+      iterator const first = std::lower_bound (m_intervals.begin (), m_intervals.end (),
+                                               interval.begin (), EndsBefore ());
+      iterator const last = std::upper_bound (first, m_intervals.end (),
+                                              interval.end (), ValueBeforeBegin ());
+
+      if (first == last)
+      {
+        m_intervals.insert (first, interval);
+      }
+      else
+      {
+        first->setBegin (jmin (first->begin (), interval.begin ()));
+        first->setEnd (jmax ((last - 1)->end (), interval.end ()));
+
+        m_intervals.erase (first + 1, last);
+      }
+    }
+  }
+
+  /** Add every interval of another set.
+  */
+  void insert (IntervalSet const& other)
+  {
+    for (typename Intervals::const_iterator iter = other.m_intervals.begin ();
+         iter != other.m_intervals.end (); ++iter)
+      insert (*iter);
+  }
+
+  /** Remove an interval from the set.
+
+      Intervals which partially overlap it are trimmed, and an interval
+      which strictly contains it is split in two.
+  */
+  void subtract (IntervalType const& interval)
+  {
+    if (interval.notEmpty ())
+    {
+      // Only intervals which intersect the subtracted one are affected.
+      iterator first = std::upper_bound (m_intervals.begin (), m_intervals.end (),
+                                         interval.begin (), ValueBeforeEnd ());
+      iterator const last = std::lower_bound (first, m_intervals.end (),
+                                              interval.end (), BeginsBefore ());
+
+      if (first != last)
+      {
+        IntervalType const head (first->begin (), interval.begin ());
+        IntervalType const tail (interval.end (), (last - 1)->end ());
+
+        if (head.notEmpty ())
+          *first++ = head;
+
+        if (tail.notEmpty ())
+        {
+          if (first == last)
+          {
+            // An interval which contains the subtracted one is split.
+            m_intervals.insert (first, tail);
+            return;
+          }
+
+          *first++ = tail;
+        }
+
+        m_intervals.erase (first, last);
+      }
+    }
+  }
+
+  /** Remove every interval of another set.
+  */
+  void subtract (IntervalSet const& other)
+  {
+    for (typename Intervals::const_iterator iter = other.m_intervals.begin ();
+         iter != other.m_intervals.end (); ++iter)
+      subtract (*iter);
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Find the interval containing a value.
+
+      @param value The value to look up.
+
+      @return The index of the interval containing the value, or -1.
+  */
+  int indexOf (Ty value) const
+  {
+    const_iterator const iter = std::upper_bound (m_intervals.begin (), m_intervals.end (),
+                                                  value, ValueBeforeBegin ());
+
+    int index = -1;
+
+    if (iter != m_intervals.begin () && (iter - 1)->contains (value))
+      index = int (iter - 1 - m_intervals.begin ());
+
+    return index;
+  }
+
+  /** Determine if a value is in the set.
+  */
+  bool contains (Ty value) const
+  {
+    return indexOf (value) != -1;
+  }
+
+  /** Determine if every value of an interval is in the set.
+  */
+  bool contains (IntervalType const& interval) const
+  {
+    bool result;
+
+    if (interval.notEmpty ())
+    {
+      int const index = indexOf (interval.begin ());
+
+      result = index != -1 && m_intervals [index].end () >= interval.end ();
+    }
+    else
+    {
+      result = true;
+    }
+
+    return result;
+  }
+
+  /** Determine if any value of an interval is in the set.
+  */
+  bool intersects (IntervalType const& interval) const
+  {
+    bool result = false;
+
+    if (interval.notEmpty ())
+    {
+      const_iterator const iter = std::upper_bound (m_intervals.begin (), m_intervals.end (),
+                                                    interval.begin (), ValueBeforeEnd ());
+
+      result = iter != m_intervals.end () && iter->begin () < interval.end ();
+    }
+
+    return result;
+  }
+
+  bool operator== (IntervalSet const& other) const
+  {
+    return m_intervals == other.m_intervals;
+  }
+
+  bool operator!= (IntervalSet const& other) const
+  {
+    return m_intervals != other.m_intervals;
+  }
+
+private:
+  typedef std::vector <IntervalType> Intervals;
+  typedef typename Intervals::iterator iterator;
+  typedef typename Intervals::const_iterator const_iterator;
+
+  // Comparisons for the binary searches, with their arguments in the order
+  // that std::lower_bound and std::upper_bound pass them.
+
+  struct EndsBefore
+  {
+    bool operator() (IntervalType const& interval, Ty value) const
+    {
+      return interval.end () < value;
+    }
+  };
+
+  struct ValueBeforeEnd
+  {
+    bool operator() (Ty value, IntervalType const& interval) const
+    {
+      return value < interval.end ();
+    }
+  };
+
+  struct BeginsBefore
+  {
+    bool operator() (IntervalType const& interval, Ty value) const
+    {
+      return interval.begin () < value;
+    }
+  };
+
+  struct ValueBeforeBegin
+  {
+    bool operator() (Ty value, IntervalType const& interval) const
+    {
+      return value < interval.begin ();
+    }
+  };
+
+  Intervals m_intervals;
+};
+
+#endif
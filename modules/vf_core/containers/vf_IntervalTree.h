@@ -0,0 +1,533 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_INTERVALTREE_VFHEADER
+#define VF_INTERVALTREE_VFHEADER
+
+#include "../math/vf_Interval.h"
+
+/*============================================================================*/
+/**
+  A collection of values keyed by possibly overlapping intervals.
+
+  This is an augmented AVL tree. It is sorted by the start of each
+  interval. Each node also records the largest end in its subtree, so
+  queries can skip subtrees that end before the query begins. Insertion
+  and removal take O(log n) time. A query takes O(log n + k) time, where
+  k is the number of intervals reported.
+
+  The nodes are kept in one array and linked by index, not by pointer.
+  Removed nodes are reused before the array grows. This keeps the tree
+  compact and needs no allocation per node.
+
+  Empty intervals overlap nothing, so they are not stored.
+
+  @code
+
+  IntervalTree <int64, Region*> regions;
+  regions.insert (Interval <int64> (0, 48000), region);
+
+  regions.findContaining (1000, Invalidate ());
+
+  @endcode
+
+  @tparam Ty    A scalar numerical type.
+  @tparam Value The type of value associated with each interval. It must be
+                copyable, default constructible and equality comparable.
+
+  @ingroup vf_core
+*/
+template <class Ty, class Value>
+class IntervalTree
+{
+public:
+  typedef Interval <Ty> IntervalType;
+  typedef Value ValueType;
+
+  /** Create an empty tree.
+  */
+  IntervalTree ()
+    : m_root (nil)
+    , m_free (nil)
+    , m_size (0)
+  {
+  }
+
+  /** Determine if the tree is empty.
+  */
+  bool isEmpty () const noexcept
+  {
+    return m_size == 0;
+  }
+
+  /** Returns the number of intervals in the tree.
+  */
+  int size () const noexcept
+  {
+    return m_size;
+  }
+
+  /** Remove all intervals.
+  */
+  void clear ()
+  {
+    m_nodes.clear ();
+    m_root = nil;
+    m_free = nil;
+    m_size = 0;
+  }
+
+  /** Allocate storage for a number of intervals ahead of time.
+  */
+  void reserve (int numberOfIntervals)
+  {
+    m_nodes.reserve (numberOfIntervals);
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Add an interval and its value.
+
+      The same interval may be added more than once.
+  */
+  void insert (IntervalType const& interval, Value const& value)
+  {
+    if (interval.notEmpty ())
+    {
+      int const node = allocate (interval, value);
+
+      m_root = insertNode (m_root, node);
+
+      ++m_size;
+    }
+  }
+
+  /** Remove an interval and its value.
+
+      If the pair was added more than once, one of them is removed.
+
+      @return `true` if the pair was found.
+  */
+  bool remove (IntervalType const& interval, Value const& value)
+  {
+    bool found = false;
+
+    if (interval.notEmpty ())
+    {
+      int const node = findNode (m_root, interval, value);
+
+      if (node != nil)
+      {
+        m_root = removeNode (m_root, node);
+
+        release (node);
+
+        --m_size;
+
+        found = true;
+      }
+    }
+
+    return found;
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Determine if any interval in the tree intersects the query.
+
+      This follows a single path from the root.
+  */
+  bool overlapsAny (IntervalType const& query) const
+  {
+    int n = query.notEmpty () ? m_root : nil;
+
+    while (n != nil && ! m_nodes [n].interval.intersects (query))
+    {
+      int const left = m_nodes [n].left;
+
+      // If the left subtree reaches past the start of the query and still
+      // has no match, the right subtree, which starts later, has none either.
+      if (left != nil && m_nodes [left].maxEnd > query.begin ())
+        n = left;
+      else
+        n = m_nodes [n].right;
+    }
+
+    return n != nil;
+  }
+
+  /** Report every interval which intersects the query.
+
+      The intervals are reported in order of their starting points.
+
+      @param query The interval to test against.
+      @param f     A functor called as `f (IntervalType const&, Value const&)`.
+
+      @return The number of intervals reported.
+  */
+  template <class Functor>
+  int findOverlapping (IntervalType const& query, Functor f) const
+  {
+    return query.notEmpty () ? visitOverlapping (m_root, query, f) : 0;
+  }
+
+  /** Report every interval which contains a point.
+
+      @param point The value to test.
+      @param f     A functor called as `f (IntervalType const&, Value const&)`.
+
+      @return The number of intervals reported.
+  */
+  template <class Functor>
+  int findContaining (Ty point, Functor f) const
+  {
+    return visitContaining (m_root, point, f);
+  }
+
+private:
+  enum
+  {
+    nil = -1
+  };
+
+  struct Node
+  {
+    Node (IntervalType const& interval_, Value const& value_)
+      : interval (interval_)
+      , maxEnd (interval_.end ())
+      , left (nil)
+      , right (nil)
+      , height (1)
+      , value (value_)
+    {
+    }
+
+    IntervalType interval;
+    Ty maxEnd;
+    int left;
+    int right;
+    int height;
+    Value value;
+  };
+
+  //----------------------------------------------------------------------------
+
+  int allocate (IntervalType const& interval, Value const& value)
+  {
+    int node;
+
+    if (m_free != nil)
+    {
+      node = m_free;
+      m_free = m_nodes [node].left;
+      m_nodes [node] = Node (interval, value);
+    }
+    else
+    {
+      node = int (m_nodes.size ());
+      m_nodes.push_back (Node (interval, value));
+    }
+
+    return node;
+  }
+
+  void release (int node)
+  {
+    m_nodes [node].value = Value ();
+    m_nodes [node].left = m_free;
+    m_free = node;
+  }
+
+  //----------------------------------------------------------------------------
+
+  // Nodes are ordered by start, then end, then index, so that
+  // every node has a distinct key.
+  //
+  static int compare (IntervalType const& a, IntervalType const& b) noexcept
+  {
+    if (a.begin () < b.begin ())
+      return -1;
+    else if (b.begin () < a.begin ())
+      return 1;
+    else if (a.end () < b.end ())
+      return -1;
+    else if (b.end () < a.end ())
+      return 1;
+    else
+      return 0;
+  }
+
+  bool isBefore (int a, int b) const noexcept
+  {
+    int const result = compare (m_nodes [a].interval, m_nodes [b].interval);
+
+    return result < 0 || (result == 0 && a < b);
+  }
+
+  int getHeight (int n) const noexcept
+  {
+    return n == nil ? 0 : m_nodes [n].height;
+  }
+
+  void update (int n) noexcept
+  {
+    Node& x = m_nodes [n];
+
+    x.height = 1 + jmax (getHeight (x.left), getHeight (x.right));
+    x.maxEnd = x.interval.end ();
+
+    if (x.left != nil && x.maxEnd < m_nodes [x.left].maxEnd)
+      x.maxEnd = m_nodes [x.left].maxEnd;
+
+    if (x.right != nil && x.maxEnd < m_nodes [x.right].maxEnd)
+      x.maxEnd = m_nodes [x.right].maxEnd;
+  }
+
+  int rotateLeft (int n) noexcept
+  {
+    int const r = m_nodes [n].right;
+
+    m_nodes [n].right = m_nodes [r].left;
+    m_nodes [r].left = n;
+
+    update (n);
+    update (r);
+
+    return r;
+  }
+
+  int rotateRight (int n) noexcept
+  {
+    int const l = m_nodes [n].left;
+
+    m_nodes [n].left = m_nodes [l].right;
+    m_nodes [l].right = n;
+
+    update (n);
+    update (l);
+
+    return l;
+  }
+
+  // Restores the AVL property at a node whose subtrees differ
+  // in height by at most two, and returns the new subtree root.
+  //
+  int rebalance (int n) noexcept
+  {
+    update (n);
+
+    int const left = m_nodes [n].left;
+    int const right = m_nodes [n].right;
+    int const balance = getHeight (left) - getHeight (right);
+
+    if (balance > 1)
+    {
+      if (getHeight (m_nodes [left].left) < getHeight (m_nodes [left].right))
+        m_nodes [n].left = rotateLeft (left);
+
+      n = rotateRight (n);
+    }
+    else if (balance < -1)
+    {
+      if (getHeight (m_nodes [right].right) < getHeight (m_nodes [right].left))
+        m_nodes [n].right = rotateRight (right);
+
+      n = rotateLeft (n);
+    }
+
+    return n;
+  }
+
+  int insertNode (int n, int node) noexcept
+  {
+    if (n == nil)
+      return node;
+
+    if (isBefore (node, n))
+    {
+      int const left = insertNode (m_nodes [n].left, node);
+      m_nodes [n].left = left;
+    }
+    else
+    {
+      int const right = insertNode (m_nodes [n].right, node);
+      m_nodes [n].right = right;
+    }
+
+    return rebalance (n);
+  }
+
+  int removeMin (int n, int* minimum) noexcept
+  {
+    if (m_nodes [n].left == nil)
+    {
+      *minimum = n;
+      return m_nodes [n].right;
+    }
+
+    int const left = removeMin (m_nodes [n].left, minimum);
+    m_nodes [n].left = left;
+
+    return rebalance (n);
+  }
+
+  int removeNode (int n, int node) noexcept
+  {
+    if (n == node)
+    {
+      int const left = m_nodes [n].left;
+      int const right = m_nodes [n].right;
+
+      if (right == nil)
+        return left;
+
+      int successor;
+      int const rest = removeMin (right, &successor);
+
+      m_nodes [successor].left = left;
+      m_nodes [successor].right = rest;
+
+      return rebalance (successor);
+    }
+
+    if (isBefore (node, n))
+    {
+      int const left = removeNode (m_nodes [n].left, node);
+      m_nodes [n].left = left;
+    }
+    else
+    {
+      int const right = removeNode (m_nodes [n].right, node);
+      m_nodes [n].right = right;
+    }
+
+    return rebalance (n);
+  }
+
+  // Equal intervals may be on either side of each other after rotations,
+  // so both subtrees are searched when the interval matches.
+  //
+  int findNode (int n, IntervalType const& interval, Value const& value) const
+  {
+    int found = nil;
+
+    if (n != nil)
+    {
+      Node const& x = m_nodes [n];
+
+      int const result = compare (interval, x.interval);
+
+      if (result < 0)
+      {
+        found = findNode (x.left, interval, value);
+      }
+      else if (result > 0)
+      {
+        found = findNode (x.right, interval, value);
+      }
+      else if (x.value == value)
+      {
+        found = n;
+      }
+      else
+      {
+        found = findNode (x.left, interval, value);
+
+        if (found == nil)
+          found = findNode (x.right, interval, value);
+      }
+    }
+
+    return found;
+  }
+
+  //----------------------------------------------------------------------------
+
+  template <class Functor>
+  int visitOverlapping (int n, IntervalType const& query, Functor& f) const
+  {
+    int count = 0;
+
+    if (n != nil && m_nodes [n].maxEnd > query.begin ())
+    {
+      Node const& x = m_nodes [n];
+
+      count += visitOverlapping (x.left, query, f);
+
+      if (x.interval.begin () < query.end ())
+      {
+        if (x.interval.end () > query.begin ())
+        {
+          f (x.interval, x.value);
+          ++count;
+        }
+
+        count += visitOverlapping (x.right, query, f);
+      }
+    }
+
+    return count;
+  }
+
+  template <class Functor>
+  int visitContaining (int n, Ty point, Functor& f) const
+  {
+    int count = 0;
+
+    if (n != nil && m_nodes [n].maxEnd > point)
+    {
+      Node const& x = m_nodes [n];
+
+      count += visitContaining (x.left, point, f);
+
+      if (! (point < x.interval.begin ()))
+      {
+        if (x.interval.end () > point)
+        {
+          f (x.interval, x.value);
+          ++count;
+        }
+
+        count += visitContaining (x.right, point, f);
+      }
+    }
+
+    return count;
+  }
+
+  std::vector <Node> m_nodes;
+  int m_root;
+  int m_free;
+  int m_size;
+};
+
+#endif
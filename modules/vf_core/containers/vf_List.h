@@ -664,6 +664,104 @@ public:
     return pos;
   }
 
+  /** Remove a range of elements.
+
+      The elements are unlinked in constant time, but they are counted in
+      order to keep size() correct, which takes linear time. Use the overload
+      which takes the count if it is already known.
+
+      @param first An iterator pointing to the first element to remove.
+
+      @param last An iterator pointing after the last element to remove.
+
+      @return An iterator pointing to the element after the ones removed.
+  */
+  iterator erase (iterator first, iterator last)
+  {
+    return erase (first, last, distance (first, last));
+  }
+
+  /** Remove a range of elements, in constant time.
+
+      @invariant The range must hold exactly `count` elements.
+
+      @param first An iterator pointing to the first element to remove.
+
+      @param last An iterator pointing after the last element to remove.
+
+      @param count The number of elements in the range.
+
+      @return An iterator pointing to the element after the ones removed.
+  */
+  iterator erase (iterator first, iterator last, size_type count)
+  {
+    jassert (count == distance (first, last));
+
+    if (first != last)
+    {
+      Node* const before = first.get_node ()->m_prev;
+      Node* const after = last.get_node ();
+      before->m_next = after;
+      after->m_prev = before;
+      m_size -= count;
+    }
+
+    return last;
+  }
+
+  /** Remove every element for which a predicate returns `true`.
+
+      The list is traversed once. The removed elements are not freed.
+
+      @param pred A functor called as `pred (Element&)`.
+
+      @return The number of elements removed.
+  */
+  template <class Predicate>
+  size_type remove_if (Predicate pred)
+  {
+    return remove_and_dispose_if (pred, NullDisposer ());
+  }
+
+  /** Remove every element for which a predicate returns `true`, and pass
+      each one to a disposer.
+
+      The list is traversed once. The disposer is called after the element
+      is unlinked, so it may delete the element.
+
+      @param pred A functor called as `pred (Element&)`.
+
+      @param disposer A functor called as `disposer (Element&)`.
+
+      @return The number of elements removed.
+  */
+  template <class Predicate, class Disposer>
+  size_type remove_and_dispose_if (Predicate pred, Disposer disposer)
+  {
+    size_type removed = 0;
+
+    Node* node = m_head.m_next;
+
+    while (node != &m_tail)
+    {
+      Node* const next = node->m_next;
+
+      if (pred (element_from (node)))
+      {
+        node->m_prev->m_next = next;
+        next->m_prev = node->m_prev;
+        --m_size;
+        ++removed;
+
+        disposer (element_from (node));
+      }
+
+      node = next;
+    }
+
+    return removed;
+  }
+
   /** Insert an element at the beginning of the list.
 
       @invariant The element must not exist in the list.
@@ -708,6 +806,106 @@ public:
     erase (--end ());
   }
 
+  /** Move all the elements of another list into this one, in constant time.
+
+      The other list is cleared.
+
+      @param pos The location to insert before.
+
+      @param other The list to move elements from.
+  */
+  void splice (iterator pos, List& other)
+  {
+    insert (pos, other);
+  }
+
+  /** Move one element of another list into this one, in constant time.
+
+      The other list may be this list.
+
+      @param pos The location to insert before.
+
+      @param other The list holding the element.
+
+      @param elem An iterator pointing to the element to move.
+  */
+  void splice (iterator pos, List& other, iterator elem)
+  {
+    if (pos != elem)
+    {
+      Element& e = *elem;
+      other.erase (elem);
+      insert (pos, e);
+    }
+  }
+
+  /** Move a range of elements of another list into this one.
+
+      When the other list is this list, this takes constant time. Otherwise
+      the elements are counted, which takes linear time. Use the overload
+      which takes the count if it is already known.
+
+      @invariant When the other list is this list, pos must not be
+                 inside the range.
+
+      @param pos The location to insert before.
+
+      @param other The list holding the elements.
+
+      @param first An iterator pointing to the first element to move.
+
+      @param last An iterator pointing after the last element to move.
+  */
+  void splice (iterator pos, List& other, iterator first, iterator last)
+  {
+    splice (pos, other, first, last, &other == this ? 0 : distance (first, last));
+  }
+
+  /** Move a range of elements of another list into this one, in constant
+      time.
+
+      @invariant The range must hold exactly `count` elements. When the
+                 other list is this list, the count is not used and pos
+                 must not be inside the range.
+
+      @param pos The location to insert before.
+
+      @param other The list holding the elements.
+
+      @param first An iterator pointing to the first element to move.
+
+      @param last An iterator pointing after the last element to move.
+
+      @param count The number of elements in the range.
+  */
+  void splice (iterator pos, List& other, iterator first, iterator last, size_type count)
+  {
+    jassert (&other == this || count == distance (first, last));
+
+    if (first != last && pos != first && pos != last)
+    {
+      Node* const firstNode = first.get_node ();
+      Node* const lastNode = last.get_node ()->m_prev;
+
+      // Unlink the range from the other list.
+      firstNode->m_prev->m_next = last.get_node ();
+      last.get_node ()->m_prev = firstNode->m_prev;
+
+      // Link it in before pos.
+      Node* const before = pos.get_node ();
+      firstNode->m_prev = before->m_prev;
+      before->m_prev->m_next = firstNode;
+      lastNode->m_next = before;
+      before->m_prev = lastNode;
+
+      if (&other != this)
+      {
+        other.m_size -= count;
+        m_size += count;
+      }
+    }
+  }
+
   /** Swap contents with another list.
   */ 
   void swap (List& other)
@@ -767,6 +965,23 @@ public:
   }
 
 private:
+  struct NullDisposer
+  {
+    void operator() (Element&) const
+    {
+    }
+  };
+
+  static size_type distance (iterator first, iterator last)
+  {
+    size_type count = 0;
+
+    for (; first != last; ++first)
+      ++count;
+
+    return count;
+  }
+
   inline reference element_from (Node* node)
   {
     return *(static_cast <pointer> (node));
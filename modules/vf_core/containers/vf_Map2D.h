@@ -33,8 +33,16 @@
 #ifndef VF_MAP2D_VFHEADER
 #define VF_MAP2D_VFHEADER
 
+#include "../memory/vf_AlignedHeapBlock.h"
+
 /** Two dimensional array.
 
+    The elements are stored row by row. The first row starts on a cache line,
+    and the distance between rows, the stride, may be larger than the width so
+    that every row starts on a cache line too; see getAlignedStride().
+
+    Large maps can be cleared or copied on the threads of a ParallelFor.
+
     @ingroup vf_core
 */
 template <class T>
@@ -50,9 +58,15 @@ public:
   }
 
   /** Create a new 2D map with the specified size.
+
+      Zero filled memory comes from calloc(), so the pages of a large map
+      are not touched until they are first written.
+
+      @param rowStride The number of elements from the start of one row to
+                       the start of the next, or zero to pack the rows.
   */
-  Map2D (int width, int height, bool fillMemoryWithZeros = false)
-    : m_data (new Data (width, height, fillMemoryWithZeros))
+  Map2D (int width, int height, bool fillMemoryWithZeros = false, int rowStride = 0)
+    : m_data (new Data (width, height, fillMemoryWithZeros, rowStride))
   {
   }
   
@@ -104,21 +118,71 @@ public:
     return m_data != nullptr;
   }
 
+  /** Returns the smallest stride of at least width elements which starts
+      every row on a cache line.
+
+      When sizeof (T) does not divide the cache line size, the stride is a
+      multiple of several lines.
+  */
+  static int getAlignedStride (int width) noexcept
+  {
+    int const multiple = Memory::cacheLineElementMultiple <T> ();
+
+    return ((width + multiple - 1) / multiple) * multiple;
+  }
+
   /** Initialize all elements with a value.
   */
   template <class U>
   void reset (U u = U ()) const noexcept
   {
-     std::fill (
-      m_data->getData (),
-      m_data->getData () + m_data->getRows () * m_data->getCols (), u);
+    fillRows (T (u), 0, getRows ());
+  }
+
+  /** Initialize all elements with a value, in parallel.
+
+      The rows are divided into chunks which are filled on the threads
+      of the ParallelFor.
+  */
+  template <class U, class ParallelForType>
+  void reset (U u, ParallelForType& parallelFor) const
+  {
+    parallelFor.loop (getNumberOfChunks (), &Map2D::fillChunk, this, T (u));
+  }
+
+  /** Set all elements to zero by replacing the storage.
+
+      The new memory comes from calloc(), which for a large map costs far
+      less than writing zeros over it. Other references to this map see
+      the change. Existing row pointers become invalid.
+  */
+  void clear () const
+  {
+    m_data->clear ();
+  }
+
+  /** Copy the elements of another map with the same size.
+
+      The strides of the two maps may differ.
+  */
+  void copyFrom (Map2D const& source) const noexcept
+  {
+    copyRows (&source, 0, getRows ());
+  }
+
+  /** Copy the elements of another map with the same size, in parallel.
+  */
+  template <class ParallelForType>
+  void copyFrom (Map2D const& source, ParallelForType& parallelFor) const
+  {
+    parallelFor.loop (getNumberOfChunks (), &Map2D::copyChunk, this, &source);
   }
 
   /** Get a pointer to the start of the data.
   */
   inline T* getData () const noexcept
   {
-    return m_data.getData ();
+    return m_data->getData ();
   }
 
   /** Conversion to T*.
@@ -142,6 +206,13 @@ public:
     return m_data->getCols ();
   }
 
+  /** Get the number of elements from the start of one row to the next.
+  */
+  inline int getStride () const noexcept
+  {
+    return m_data->getStride ();
+  }
+
   /** Access an element.
   */
   inline T& get (int x, int y) const noexcept
@@ -160,20 +231,96 @@ public:
   */
   inline T* getRow (int y) const noexcept
   {
-    return m_data->getRow ();
+    return m_data->getRow (y);
   }
 
 private:
+  enum
+  {
+    elementsPerChunk = 65536
+  };
+
+  int getRowsPerChunk () const noexcept
+  {
+    return jmax (1, int (elementsPerChunk) / jmax (1, getStride ()));
+  }
+
+  int getNumberOfChunks () const noexcept
+  {
+    int const rowsPerChunk = getRowsPerChunk ();
+
+    return (getRows () + rowsPerChunk - 1) / rowsPerChunk;
+  }
+
+  void fillRows (T const& value, int firstRow, int numberOfRows) const noexcept
+  {
+    if (numberOfRows > 0)
+    {
+      // The padding is filled too, so the rows form one run.
+      T* const first = getRow (firstRow);
+
+      std::fill (first, first + size_t (numberOfRows) * getStride (), value);
+    }
+  }
+
+  void copyRows (Map2D const* source, int firstRow, int numberOfRows) const noexcept
+  {
+    jassert (source->getRows () == getRows () && source->getCols () == getCols ());
+
+    if (numberOfRows > 0)
+    {
+      if (source->getStride () == getStride ())
+      {
+        T const* const first = source->getRow (firstRow);
+
+        std::copy (first, first + size_t (numberOfRows) * getStride (), getRow (firstRow));
+      }
+      else
+      {
+        for (int y = firstRow; y < firstRow + numberOfRows; ++y)
+        {
+          T const* const row = source->getRow (y);
+
+          std::copy (row, row + getCols (), getRow (y));
+        }
+      }
+    }
+  }
+
+  void fillChunk (T value, int chunkIndex) const noexcept
+  {
+    int const rowsPerChunk = getRowsPerChunk ();
+    int const firstRow = chunkIndex * rowsPerChunk;
+
+    fillRows (value, firstRow, jmin (rowsPerChunk, getRows () - firstRow));
+  }
+
+  void copyChunk (Map2D const* source, int chunkIndex) const noexcept
+  {
+    int const rowsPerChunk = getRowsPerChunk ();
+    int const firstRow = chunkIndex * rowsPerChunk;
+
+    copyRows (source, firstRow, jmin (rowsPerChunk, getRows () - firstRow));
+  }
+
   class Data : public ReferenceCountedObject
   {
   public:
     typedef ReferenceCountedObjectPtr <Data> Ptr;
 
-    Data (int width, int height, bool fillMemoryWithZeros = false)
+    Data (int width, int height, bool fillMemoryWithZeros, int rowStride)
       : m_rows (height)
       , m_cols (width)
-      , m_vec (height * width, fillMemoryWithZeros)
+      , m_stride (rowStride != 0 ? rowStride : width)
+    {
+      jassert (m_stride >= m_cols);
+
+      m_vec.allocate (getNumberOfElements (), fillMemoryWithZeros);
+    }
+
+    void clear ()
     {
+      m_vec.allocate (getNumberOfElements (), true);
     }
 
     inline int getRows () const noexcept
@@ -186,6 +333,11 @@ private:
       return m_cols;
     }
 
+    inline int getStride () const noexcept
+    {
+      return m_stride;
+    }
+
     inline T* getData () const noexcept
     {
       return m_vec.getData ();
@@ -194,20 +346,26 @@ private:
     inline T& get (int x, int y) const noexcept
     {
       jassert (isPositiveAndBelow (x, m_cols) && isPositiveAndBelow (y, m_rows));
-      return m_vec [y * m_cols + x];
+      return m_vec [size_t (y) * m_stride + x];
     }
 
     inline T* getRow (int y) const noexcept
     {
       jassert (isPositiveAndBelow (y, m_rows));
     
-      return m_vec + y * m_cols;
+      return m_vec + size_t (y) * m_stride;
     }
 
   private:
+    size_t getNumberOfElements () const noexcept
+    {
+      return size_t (m_rows) * m_stride;
+    }
+
     int const m_rows;
     int const m_cols;
-    HeapBlock <T> m_vec;
+    int const m_stride;
+    AlignedHeapBlock <T> m_vec;
   };
 
   typename Data::Ptr m_data;
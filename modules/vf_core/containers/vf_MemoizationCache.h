@@ -0,0 +1,575 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_MEMOIZATIONCACHE_VFHEADER
+#define VF_MEMOIZATIONCACHE_VFHEADER
+
+#include "../math/vf_MurmurHash.h"
+
+/*============================================================================*/
+/**
+  A 128 bit MurmurHash of the inputs to a computation.
+
+  The key identifies a result by its content: two computations with the
+  same inputs produce the same key. Build keys from every input which
+  affects the result, including parameters such as sizes and versions.
+
+  @code
+
+  CacheKey::Builder builder;
+  builder.add (radius);
+  builder.add (image.getWidth ());
+  builder.add (pixels, numberOfBytes);
+
+  CacheKey const key = builder.getKey ();
+
+  @endcode
+
+  @ingroup vf_core
+*/
+class CacheKey
+{
+public:
+  /** Accumulates the inputs of a key.
+  */
+  class Builder
+  {
+  public:
+    explicit Builder (uint32 seed = 0) : m_hasher (seed)
+    {
+    }
+
+    /** Add bytes. */
+    void add (void const* data, int bytes)
+    {
+      m_hasher.update (data, bytes);
+    }
+
+    /** Add a number or an enum value.
+
+        Only the bytes of the value are hashed. Those of a class or a
+        pointer do not describe what it refers to, so add its contents.
+    */
+    template <class Plain>
+    void add (Plain const& value)
+    {
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+      static_assert (std::is_arithmetic <Plain>::value || std::is_enum <Plain>::value,
+                     "Only numbers and enums can be added by value");
+#endif
+
+      m_hasher.update (&value, int (sizeof (Plain)));
+    }
+
+    /** Add the UTF-8 characters of a string, and its length. */
+    void add (String const& text)
+    {
+      char const* const utf8 = text.toUTF8 ();
+      int const bytes = int (strlen (utf8));
+
+      add (bytes);
+      add (utf8, bytes);
+    }
+
+    /** Produce the key. More inputs may be added afterwards. */
+    CacheKey getKey () const
+    {
+      CacheKey key;
+      m_hasher.finalize (key.m_words);
+      return key;
+    }
+
+  private:
+    Murmur::Hasher128 m_hasher;
+  };
+
+  /** Create the key of a block of bytes. */
+  CacheKey (void const* data, int bytes, uint32 seed = 0)
+  {
+    Murmur::Hash (data, bytes, seed, &m_words);
+  }
+
+  inline uint64 getLow () const { return m_words [0]; }
+  inline uint64 getHigh () const { return m_words [1]; }
+
+  inline bool operator== (CacheKey const& other) const
+  {
+    return m_words [0] == other.m_words [0] && m_words [1] == other.m_words [1];
+  }
+
+  inline bool operator!= (CacheKey const& other) const
+  {
+    return !operator== (other);
+  }
+
+private:
+  CacheKey ()
+  {
+  }
+
+  uint64 m_words [2];
+};
+
+/*============================================================================*/
+/**
+  Bounded, thread safe cache of computed results.
+
+  This remembers the results of expensive computations, such as rendered
+  glyphs or convolved images, so that identical requests are answered
+  without computing them again.
+
+  - Results are found by CacheKey, and each carries a cost in bytes. When
+    the total cost would exceed the budget, results are evicted with the
+    CLOCK algorithm: a sweep passes over the results, sparing those which
+    were used since its last visit.
+
+  - The cache is divided into shards, each with its own lock and an equal
+    part of the budget. A key always belongs to the same shard, so threads
+    only contend when they use the same shard at the same time.
+
+  - Hits, misses, insertions and evictions are counted. getStatistics()
+    returns them at any time, and when VF_USE_METRICS is set they are also
+    reported through Metrics, with the kind "MemoizationCache".
+
+  Values are copied in and out under the shard lock, so Value should be
+  cheap to copy, such as a ReferenceCountedObjectPtr or a juce::Image. It
+  must also be default constructible.
+
+  @code
+
+  struct Blur
+  {
+    int64 operator() (Image& result) const
+    {
+      result = computeBlur (...);
+      return result.getWidth () * result.getHeight () * 4;
+    }
+  };
+
+  static MemoizationCache <Image> cache ("blur", 64 * 1024 * 1024);
+
+  Image image = cache.getOrCompute (key, Blur ());
+
+  @endcode
+
+  @ingroup vf_core
+*/
+template <class Value>
+class MemoizationCache
+#if VF_USE_METRICS
+  : public Metrics::Source
+#else
+  : Uncopyable
+#endif
+{
+public:
+  struct Statistics
+  {
+    Statistics ()
+      : hits (0)
+      , misses (0)
+      , insertions (0)
+      , evictions (0)
+      , entries (0)
+      , bytes (0)
+    {
+    }
+
+    int64 hits;
+    int64 misses;
+    int64 insertions;
+    int64 evictions;
+    int64 entries;
+    int64 bytes;
+  };
+
+  /** Create a cache.
+
+      @param name           A name for reporting statistics.
+      @param maximumBytes   The total cost of the results to keep.
+      @param numberOfShards The number of independently locked parts.
+  */
+  MemoizationCache (String const& name, int64 maximumBytes, int numberOfShards = 16)
+    : m_name (name)
+  {
+    jassert (numberOfShards > 0);
+
+    for (int i = 0; i < numberOfShards; ++i)
+      m_shards.add (new Shard (maximumBytes / numberOfShards));
+
+#if VF_USE_METRICS
+    Metrics::add (this);
+#endif
+  }
+
+  ~MemoizationCache ()
+  {
+#if VF_USE_METRICS
+    Metrics::remove (this);
+#endif
+  }
+
+  /** Find a result.
+
+      @param key   The key of the result.
+      @param value Receives the result, if it was found.
+      @return `true` if the result was found.
+  */
+  bool find (CacheKey const& key, Value* value)
+  {
+    return getShard (key).find (key, value);
+  }
+
+  /** Remember a result.
+
+      This replaces any result with the same key. A result which costs
+      more than a shard's part of the budget is not remembered.
+
+      @param key   The key of the result.
+      @param value The result.
+      @param bytes The cost of the result.
+  */
+  void insert (CacheKey const& key, Value const& value, int64 bytes)
+  {
+    getShard (key).insert (key, value, bytes);
+  }
+
+  /** Find a result, computing and remembering it if it is missing.
+
+      The lock is not held during the computation, so two threads which
+      miss on the same key at once may both compute the result.
+
+      @param compute A functor with the signature `int64 (Value& result)`.
+                     It stores the result and returns its cost in bytes.
+  */
+  template <class Functor>
+  Value getOrCompute (CacheKey const& key, Functor const& compute)
+  {
+    Value value;
+
+    if (!find (key, &value))
+    {
+      int64 const bytes = compute (value);
+
+      insert (key, value, bytes);
+    }
+
+    return value;
+  }
+
+  /** Forget a result.
+
+      @return `true` if there was a result with the key.
+  */
+  bool erase (CacheKey const& key)
+  {
+    return getShard (key).erase (key);
+  }
+
+  /** Forget every result.
+  */
+  void clear ()
+  {
+    for (int i = 0; i < m_shards.size (); ++i)
+      m_shards [i]->clear ();
+  }
+
+  /** Retrieve the counts, summed over all shards.
+  */
+  Statistics getStatistics () const
+  {
+    Statistics statistics;
+
+    for (int i = 0; i < m_shards.size (); ++i)
+      m_shards [i]->addStatistics (statistics);
+
+    return statistics;
+  }
+
+#if VF_USE_METRICS
+  void addReports (Metrics::Snapshot& snapshot)
+  {
+    Statistics const s = getStatistics ();
+
+    Metrics::Report& report = snapshot.add ("MemoizationCache", m_name);
+
+    report.addValue ("hits", s.hits);
+    report.addValue ("misses", s.misses);
+    report.addValue ("insertions", s.insertions);
+    report.addValue ("evictions", s.evictions);
+    report.addValue ("entries", s.entries);
+    report.addValue ("bytes", s.bytes);
+  }
+#endif
+
+private:
+  class Shard : vf::Uncopyable
+  {
+  public:
+    explicit Shard (int64 maximumBytes)
+      : m_maximumBytes (maximumBytes)
+      , m_bytes (0)
+      , m_count (0)
+      , m_free (-1)
+      , m_hand (0)
+      , m_buckets (16, -1)
+    {
+    }
+
+    bool find (CacheKey const& key, Value* value)
+    {
+      CriticalSection::ScopedLockType lock (m_mutex);
+
+      int const index = lookup (key);
+
+      if (index != -1)
+      {
+        Entry& entry = m_entries [index];
+        entry.referenced = true;
+        *value = entry.value;
+        ++m_statistics.hits;
+        return true;
+      }
+
+      ++m_statistics.misses;
+      return false;
+    }
+
+    void insert (CacheKey const& key, Value const& value, int64 bytes)
+    {
+      if (bytes > m_maximumBytes)
+        return;
+
+      CriticalSection::ScopedLockType lock (m_mutex);
+
+      int index = lookup (key);
+
+      if (index != -1)
+      {
+        remove (index);
+      }
+
+      while (m_bytes + bytes > m_maximumBytes)
+        evict ();
+
+      if (m_free != -1)
+      {
+        index = m_free;
+        m_free = m_entries [index].next;
+      }
+      else
+      {
+        index = int (m_entries.size ());
+        m_entries.push_back (Entry (key));
+      }
+
+      Entry& entry = m_entries [index];
+      entry.key = key;
+      entry.value = value;
+      entry.bytes = bytes;
+      entry.used = true;
+      entry.referenced = false;
+
+      int& head = m_buckets [bucketOf (key)];
+      entry.next = head;
+      head = index;
+
+      m_bytes += bytes;
+      ++m_count;
+      ++m_statistics.insertions;
+
+      if (m_count > int (m_buckets.size ()))
+        rehash (int (m_buckets.size ()) * 2);
+    }
+
+    bool erase (CacheKey const& key)
+    {
+      CriticalSection::ScopedLockType lock (m_mutex);
+
+      int const index = lookup (key);
+
+      if (index != -1)
+      {
+        remove (index);
+        return true;
+      }
+
+      return false;
+    }
+
+    void clear ()
+    {
+      CriticalSection::ScopedLockType lock (m_mutex);
+
+      m_entries.clear ();
+      m_buckets.assign (16, -1);
+      m_bytes = 0;
+      m_count = 0;
+      m_free = -1;
+      m_hand = 0;
+    }
+
+    void addStatistics (Statistics& statistics) const
+    {
+      CriticalSection::ScopedLockType lock (m_mutex);
+
+      statistics.hits += m_statistics.hits;
+      statistics.misses += m_statistics.misses;
+      statistics.insertions += m_statistics.insertions;
+      statistics.evictions += m_statistics.evictions;
+      statistics.entries += m_count;
+      statistics.bytes += m_bytes;
+    }
+
+  private:
+    struct Entry
+    {
+      explicit Entry (CacheKey const& key_)
+        : key (key_)
+        , bytes (0)
+        , next (-1)
+        , used (false)
+        , referenced (false)
+      {
+      }
+
+      CacheKey key;
+      Value value;
+      int64 bytes;
+      int next;
+      bool used;
+      bool referenced;
+    };
+
+    // The keys are hashes, so their low bits are already well mixed.
+    inline int bucketOf (CacheKey const& key) const
+    {
+      return int (key.getLow () & uint64 (m_buckets.size () - 1));
+    }
+
+    int lookup (CacheKey const& key) const
+    {
+      int index = m_buckets [bucketOf (key)];
+
+      while (index != -1 && m_entries [index].key != key)
+        index = m_entries [index].next;
+
+      return index;
+    }
+
+    // Advance the clock hand to the first result not used since its last
+    // visit, and remove it.
+    void evict ()
+    {
+      for (;;)
+      {
+        if (m_hand >= int (m_entries.size ()))
+          m_hand = 0;
+
+        Entry& entry = m_entries [m_hand++];
+
+        if (entry.used)
+        {
+          if (entry.referenced)
+          {
+            entry.referenced = false;
+          }
+          else
+          {
+            remove (m_hand - 1);
+            ++m_statistics.evictions;
+            break;
+          }
+        }
+      }
+    }
+
+    void remove (int index)
+    {
+      Entry& entry = m_entries [index];
+
+      int* link = &m_buckets [bucketOf (entry.key)];
+      while (*link != index)
+        link = &m_entries [*link].next;
+      *link = entry.next;
+
+      m_bytes -= entry.bytes;
+      --m_count;
+
+      // Release the result now rather than when the slot is reused.
+      entry.value = Value ();
+      entry.used = false;
+      entry.referenced = false;
+      entry.next = m_free;
+      m_free = index;
+    }
+
+    void rehash (int numberOfBuckets)
+    {
+      m_buckets.assign (numberOfBuckets, -1);
+
+      for (int i = 0; i < int (m_entries.size ()); ++i)
+      {
+        Entry& entry = m_entries [i];
+
+        if (entry.used)
+        {
+          int& head = m_buckets [bucketOf (entry.key)];
+          entry.next = head;
+          head = i;
+        }
+      }
+    }
+
+  private:
+    CriticalSection m_mutex;
+    int64 const m_maximumBytes;
+    int64 m_bytes;
+    int m_count;
+    int m_free;
+    int m_hand;
+    std::vector <Entry> m_entries;
+    std::vector <int> m_buckets;
+    Statistics m_statistics;
+  };
+
+  inline Shard& getShard (CacheKey const& key) const
+  {
+    return *m_shards [int (key.getHigh () % uint64 (m_shards.size ()))];
+  }
+
+private:
+  String const m_name;
+  OwnedArray <Shard> m_shards;
+};
+
+#endif
@@ -0,0 +1,491 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_PACKEDLIST_VFHEADER
+#define VF_PACKEDLIST_VFHEADER
+
+/*============================================================================*/
+/**
+  Doubly linked list with its nodes stored in one array.
+
+  This holds copies of its values, like std::list. The nodes live in one
+  array and are linked by index instead of by pointer. Freed nodes are
+  reused before the array grows. After many insertions and removals the
+  order of the array drifts from the order of the list; compact() puts it
+  back, after which traversal reads the array from start to end.
+
+  Each element is identified by a handle, its index in the array. A handle
+  stays valid until the element is erased or compact() is called. Unlike
+  iterators, handles can be stored in other data structures.
+
+  Use PackedList instead of the intrusive List when the list is traversed
+  far more often than it is changed, and the elements are small.
+
+  @tparam Value The type of value. It must be copyable and default
+                constructible.
+
+  @ingroup vf_core
+*/
+template <class Value>
+class PackedList
+{
+public:
+  typedef int size_type;
+  typedef int handle_type;
+
+  typedef Value        value_type;
+  typedef Value&       reference;
+  typedef Value const& const_reference;
+  typedef Value*       pointer;
+  typedef Value const* const_pointer;
+
+private:
+  struct Node
+  {
+    Node ()
+      : next (0)
+      , prev (0)
+    {
+    }
+
+    explicit Node (Value const& value_)
+      : next (0)
+      , prev (0)
+      , value (value_)
+    {
+    }
+
+    int next;
+    int prev;
+    Value value;
+  };
+
+  template <class ListType, class ElemType>
+  class iterator_base : public std::iterator <
+    std::bidirectional_iterator_tag, int>
+  {
+  public:
+    typedef ElemType value_type;
+    typedef ElemType* pointer;
+    typedef ElemType& reference;
+
+    iterator_base (ListType* list = nullptr, int index = 0)
+      : m_list (list)
+      , m_index (index)
+    {
+    }
+
+    template <class OtherListType, class OtherElemType>
+    iterator_base (iterator_base <OtherListType, OtherElemType> const& other)
+      : m_list (other.m_list)
+      , m_index (other.m_index)
+    {
+    }
+
+    template <class OtherListType, class OtherElemType>
+    bool operator== (iterator_base <OtherListType, OtherElemType> const& other) const
+    {
+      return m_index == other.m_index;
+    }
+
+    template <class OtherListType, class OtherElemType>
+    bool operator!= (iterator_base <OtherListType, OtherElemType> const& other) const
+    {
+      return m_index != other.m_index;
+    }
+
+    reference operator* () const
+    {
+      return m_list->m_nodes [m_index].value;
+    }
+
+    pointer operator-> () const
+    {
+      return &m_list->m_nodes [m_index].value;
+    }
+
+    iterator_base& operator++ ()
+    {
+      m_index = m_list->m_nodes [m_index].next;
+      return *this;
+    }
+
+    iterator_base operator++ (int)
+    {
+      iterator_base result (*this);
+      ++*this;
+      return result;
+    }
+
+    iterator_base& operator-- ()
+    {
+      m_index = m_list->m_nodes [m_index].prev;
+      return *this;
+    }
+
+    iterator_base operator-- (int)
+    {
+      iterator_base result (*this);
+      --*this;
+      return result;
+    }
+
+    /** Returns the handle of the element. */
+    handle_type handle () const
+    {
+      return m_index;
+    }
+
+  private:
+    template <class, class>
+    friend class iterator_base;
+    friend class PackedList;
+
+    ListType* m_list;
+    int m_index;
+  };
+
+public:
+  /** A read/write PackedList iterator. */
+  typedef iterator_base <PackedList, Value> iterator;
+
+  /** A read-only PackedList iterator. */
+  typedef iterator_base <PackedList const, Value const> const_iterator;
+
+  /** Create an empty list. */
+  PackedList ()
+  {
+    clear ();
+  }
+
+  /** Returns the number of elements in the list. */
+  size_type size () const
+  {
+    return m_size;
+  }
+
+  /** Determine if the list is empty. */
+  bool empty () const
+  {
+    return m_size == 0;
+  }
+
+  /** Remove all elements and release the array. */
+  void clear ()
+  {
+    m_nodes.assign (1, Node ());
+    m_free = 0;
+    m_size = 0;
+  }
+
+  /** Allocate room for a number of elements ahead of time. */
+  void reserve (size_type numberOfElements)
+  {
+    m_nodes.reserve (numberOfElements + 1);
+  }
+
+  iterator begin ()               { return iterator (this, m_nodes [0].next); }
+  const_iterator begin () const   { return const_iterator (this, m_nodes [0].next); }
+  const_iterator cbegin () const  { return begin (); }
+  iterator end ()                 { return iterator (this, 0); }
+  const_iterator end () const     { return const_iterator (this, 0); }
+  const_iterator cend () const    { return end (); }
+
+  reference front ()              { return m_nodes [m_nodes [0].next].value; }
+  const_reference front () const  { return m_nodes [m_nodes [0].next].value; }
+  reference back ()               { return m_nodes [m_nodes [0].prev].value; }
+  const_reference back () const   { return m_nodes [m_nodes [0].prev].value; }
+
+  /** Obtain the value of an element from its handle. */
+  reference operator[] (handle_type handle)
+  {
+    jassert (handle > 0 && handle < int (m_nodes.size ()));
+    return m_nodes [handle].value;
+  }
+
+  /** Obtain the value of an element from its handle. */
+  const_reference operator[] (handle_type handle) const
+  {
+    jassert (handle > 0 && handle < int (m_nodes.size ()));
+    return m_nodes [handle].value;
+  }
+
+  /** Obtain an iterator from a handle. */
+  iterator iterator_to (handle_type handle)
+  {
+    return iterator (this, handle);
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Insert a value.
+
+      @param pos The location to insert before.
+
+      @param value The value to insert.
+
+      @return An iterator pointing to the new element.
+  */
+  iterator insert (iterator pos, Value const& value)
+  {
+    int const node = allocate (value);
+
+    link (node, pos.m_index);
+
+    ++m_size;
+
+    return iterator (this, node);
+  }
+
+  /** Append a value at the end of the list.
+
+      @return The handle of the new element.
+  */
+  handle_type push_back (Value const& value)
+  {
+    return insert (end (), value).m_index;
+  }
+
+  /** Insert a value at the beginning of the list.
+
+      @return The handle of the new element.
+  */
+  handle_type push_front (Value const& value)
+  {
+    return insert (begin (), value).m_index;
+  }
+
+  void pop_front ()
+  {
+    jassert (! empty ());
+    erase (begin ());
+  }
+
+  void pop_back ()
+  {
+    jassert (! empty ());
+    erase (--end ());
+  }
+
+  /** Remove an element.
+
+      @return An iterator pointing to the element after the one removed.
+  */
+  iterator erase (iterator pos)
+  {
+    int const node = pos.m_index;
+    int const next = m_nodes [node].next;
+
+    unlink (node);
+    release (node);
+
+    --m_size;
+
+    return iterator (this, next);
+  }
+
+  /** Remove the element with a given handle. */
+  void erase (handle_type handle)
+  {
+    erase (iterator (this, handle));
+  }
+
+  /** Remove a range of elements.
+
+      Each node is returned to the free list, so this takes linear time.
+
+      @return An iterator pointing to the element after the ones removed.
+  */
+  iterator erase (iterator first, iterator last)
+  {
+    while (first != last)
+      first = erase (first);
+
+    return last;
+  }
+
+  /** Remove every element for which a predicate returns `true`.
+
+      The list is traversed once.
+
+      @param pred A functor called as `pred (Value&)`.
+
+      @return The number of elements removed.
+  */
+  template <class Predicate>
+  size_type remove_if (Predicate pred)
+  {
+    size_type removed = 0;
+
+    int node = m_nodes [0].next;
+
+    while (node != 0)
+    {
+      int const next = m_nodes [node].next;
+
+      if (pred (m_nodes [node].value))
+      {
+        unlink (node);
+        release (node);
+        --m_size;
+        ++removed;
+      }
+
+      node = next;
+    }
+
+    return removed;
+  }
+
+  /** Move a range of elements to another position in the list, in
+      constant time.
+
+      @invariant pos must not be inside the range.
+
+      @param pos The location to insert before.
+
+      @param first An iterator pointing to the first element to move.
+
+      @param last An iterator pointing after the last element to move.
+  */
+  void splice (iterator pos, iterator first, iterator last)
+  {
+    if (first != last && pos != first && pos != last)
+    {
+      int const firstNode = first.m_index;
+      int const lastNode = m_nodes [last.m_index].prev;
+
+      // Unlink the range.
+      m_nodes [m_nodes [firstNode].prev].next = last.m_index;
+      m_nodes [last.m_index].prev = m_nodes [firstNode].prev;
+
+      // Link it in before pos.
+      int const before = pos.m_index;
+      m_nodes [firstNode].prev = m_nodes [before].prev;
+      m_nodes [m_nodes [before].prev].next = firstNode;
+      m_nodes [lastNode].next = before;
+      m_nodes [before].prev = lastNode;
+    }
+  }
+
+  /** Move one element to another position in the list, in constant time.
+  */
+  void splice (iterator pos, iterator elem)
+  {
+    if (pos != elem)
+    {
+      unlink (elem.m_index);
+      link (elem.m_index, pos.m_index);
+    }
+  }
+
+  /** Store the nodes in list order, with no gaps.
+
+      Afterwards a traversal reads the array sequentially, and the array
+      holds no free nodes. This takes linear time.
+
+      @note All handles and iterators become invalid.
+  */
+  void compact ()
+  {
+    std::vector <Node> nodes;
+    nodes.reserve (m_size + 1);
+    nodes.push_back (Node ());
+
+    for (int node = m_nodes [0].next; node != 0; node = m_nodes [node].next)
+    {
+      int const index = int (nodes.size ());
+
+      nodes.push_back (m_nodes [node]);
+      nodes.back ().prev = index - 1;
+      nodes.back ().next = index + 1;
+    }
+
+    nodes.front ().next = m_size > 0 ? 1 : 0;
+    nodes.front ().prev = m_size;
+    nodes.back ().next = 0;
+
+    m_nodes.swap (nodes);
+    m_free = 0;
+  }
+
+private:
+  int allocate (Value const& value)
+  {
+    int node;
+
+    if (m_free != 0)
+    {
+      node = m_free;
+      m_free = m_nodes [node].next;
+      m_nodes [node].value = value;
+    }
+    else
+    {
+      node = int (m_nodes.size ());
+      m_nodes.push_back (Node (value));
+    }
+
+    return node;
+  }
+
+  void release (int node)
+  {
+    m_nodes [node].value = Value ();
+    m_nodes [node].next = m_free;
+    m_free = node;
+  }
+
+  void link (int node, int before)
+  {
+    int const after = m_nodes [before].prev;
+
+    m_nodes [node].next = before;
+    m_nodes [node].prev = after;
+    m_nodes [after].next = node;
+    m_nodes [before].prev = node;
+  }
+
+  void unlink (int node)
+  {
+    m_nodes [m_nodes [node].prev].next = m_nodes [node].next;
+    m_nodes [m_nodes [node].next].prev = m_nodes [node].prev;
+  }
+
+  // Node 0 is the sentinel: its next is the first element and its
+  // prev is the last. The free list is threaded through next.
+  std::vector <Node> m_nodes;
+  int m_free;
+  size_type m_size;
+};
+
+#endif
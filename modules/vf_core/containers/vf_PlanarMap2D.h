@@ -0,0 +1,484 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_PLANARMAP2D_VFHEADER
+#define VF_PLANARMAP2D_VFHEADER
+
+#include "../memory/vf_AlignedHeapBlock.h"
+
+/*============================================================================*/
+/**
+  A view of evenly spaced elements.
+
+  This presents a row or a column of a map as an array. Successive elements
+  are getStep() elements apart in memory.
+
+  @ingroup vf_core
+*/
+template <class T>
+class StridedView
+{
+public:
+  StridedView (T* data, int size, int step) noexcept
+    : m_data (data)
+    , m_size (size)
+    , m_step (step)
+  {
+  }
+
+  inline int size () const noexcept
+  {
+    return m_size;
+  }
+
+  inline int getStep () const noexcept
+  {
+    return m_step;
+  }
+
+  inline T* getData () const noexcept
+  {
+    return m_data;
+  }
+
+  inline T& operator[] (int index) const noexcept
+  {
+    jassert (isPositiveAndBelow (index, m_size));
+    return m_data [index * m_step];
+  }
+
+private:
+  T* m_data;
+  int m_size;
+  int m_step;
+};
+
+/*============================================================================*/
+/**
+  Arrangements of the elements of a two dimensional plane.
+
+  - Linear stores rows one after the other. Each row is padded to a whole
+    number of cache lines, so every row starts on a cache line and can be
+    processed with aligned SIMD loads.
+
+  - Tiled stores square tiles of (1 << TileShift) elements on a side one
+    after the other, and the rows of each tile within it. Neighbours in both
+    directions are usually in the same tile, which suits filters and
+    transforms that look at a window around each element.
+
+  - ZOrder stores the elements in Morton order, interleaving the bits of
+    the x and y coordinates, so that nearby elements are nearby in memory
+    at every scale. The plane is padded to a power of two square, which
+    wastes memory unless the map is nearly square.
+
+  A layout obeys this concept:
+
+  @code
+
+  struct Layout
+  {
+    // Calculate the arrangement. Plane sizes must be a multiple of
+    // lineMultiple, the fewest elements which fill a whole number of
+    // cache lines, so that every plane starts on a cache line.
+    void setSize (int cols, int rows, int lineMultiple);
+
+    // The number of elements in a plane, including padding.
+    size_t getPlaneSize () const;
+
+    // The position of an element within its plane.
+    size_t getOffset (int x, int y) const;
+  };
+
+  @endcode
+
+  @ingroup vf_core
+*/
+struct Map2DLayout
+{
+  class Linear
+  {
+  public:
+    Linear () : m_stride (0), m_rows (0)
+    {
+    }
+
+    void setSize (int cols, int rows, int lineMultiple)
+    {
+      m_stride = roundUp (cols, lineMultiple);
+      m_rows = rows;
+    }
+
+    inline size_t getPlaneSize () const noexcept
+    {
+      return size_t (m_stride) * m_rows;
+    }
+
+    inline size_t getOffset (int x, int y) const noexcept
+    {
+      return size_t (y) * m_stride + x;
+    }
+
+    /** The distance in elements from one row to the next. */
+    inline int getRowStride () const noexcept
+    {
+      return m_stride;
+    }
+
+  private:
+    int m_stride;
+    int m_rows;
+  };
+
+  //----------------------------------------------------------------------------
+
+  template <int TileShift = 3>
+  class Tiled
+  {
+  public:
+    enum
+    {
+      tileSize = 1 << TileShift,
+      tileMask = tileSize - 1
+    };
+
+    Tiled () : m_tilesAcross (0), m_planeSize (0)
+    {
+    }
+
+    void setSize (int cols, int rows, int lineMultiple)
+    {
+      m_tilesAcross = (cols + tileMask) >> TileShift;
+      int const tilesDown = (rows + tileMask) >> TileShift;
+
+      m_planeSize = roundUp (size_t (m_tilesAcross) * tilesDown * tileSize * tileSize,
+                             size_t (lineMultiple));
+    }
+
+    inline size_t getPlaneSize () const noexcept
+    {
+      return m_planeSize;
+    }
+
+    inline size_t getOffset (int x, int y) const noexcept
+    {
+      size_t const tile = size_t (y >> TileShift) * m_tilesAcross + (x >> TileShift);
+
+      return (tile << (2 * TileShift)) + ((y & tileMask) << TileShift) + (x & tileMask);
+    }
+
+  private:
+    int m_tilesAcross;
+    size_t m_planeSize;
+  };
+
+  //----------------------------------------------------------------------------
+
+  class ZOrder
+  {
+  public:
+    ZOrder () : m_planeSize (0)
+    {
+    }
+
+    void setSize (int cols, int rows, int lineMultiple)
+    {
+      jassert (cols <= 65536 && rows <= 65536);
+
+      size_t side = 1;
+      while (side < size_t (jmax (cols, rows)))
+        side *= 2;
+
+      m_planeSize = roundUp (side * side, size_t (lineMultiple));
+    }
+
+    inline size_t getPlaneSize () const noexcept
+    {
+      return m_planeSize;
+    }
+
+    inline size_t getOffset (int x, int y) const noexcept
+    {
+      return size_t (spread (uint32 (x))) | (size_t (spread (uint32 (y))) << 1);
+    }
+
+  private:
+    // Move the low 16 bits of v to the even bit positions.
+    static inline uint32 spread (uint32 v) noexcept
+    {
+      v = (v | (v << 8)) & 0x00ff00ff;
+      v = (v | (v << 4)) & 0x0f0f0f0f;
+      v = (v | (v << 2)) & 0x33333333;
+      v = (v | (v << 1)) & 0x55555555;
+      return v;
+    }
+
+    size_t m_planeSize;
+  };
+
+private:
+  template <class Integer>
+  static inline Integer roundUp (Integer value, Integer multiple) noexcept
+  {
+    return ((value + multiple - 1) / multiple) * multiple;
+  }
+};
+
+/*============================================================================*/
+/**
+  Two dimensional array with several channels stored as separate planes.
+
+  Where Map2D stores one structure per element, this stores each field of
+  the structure in a plane of its own. The values of one channel are then
+  contiguous, so a loop over a channel reads only the data it needs and can
+  be vectorized. For example, a distance transform keeps the distance and
+  the two coordinates of the nearest point in three channels:
+
+  @code
+
+  PlanarMap2D <float, 3> map (width, height, true);
+
+  StridedView <float> distances = map.getRow (0, y);
+
+  for (int x = 0; x < distances.size (); ++x)
+    distances [x] = ...;
+
+  @endcode
+
+  Every plane starts on a cache line. The Layout decides how the elements
+  of a plane are arranged, see Map2DLayout. Rows and columns can be viewed
+  with getRow() and getColumn() when the layout is Linear.
+
+  Copies of the map share the same elements. T must be a plain type, since
+  no constructors or destructors are run.
+
+  @ingroup vf_core
+*/
+template <class T, int Channels, class Layout = Map2DLayout::Linear>
+class PlanarMap2D
+{
+public:
+  typedef T Type;
+
+  enum
+  {
+    numberOfChannels = Channels
+  };
+
+  /** Creates a null map.
+  */
+  PlanarMap2D ()
+  {
+  }
+
+  /** Create a map with the specified size.
+
+      If fillMemoryWithZeros is true, the memory is obtained already zero
+      filled from the system, see AlignedHeapBlock.
+  */
+  PlanarMap2D (int width, int height, bool fillMemoryWithZeros = false)
+    : m_data (new Data (width, height, fillMemoryWithZeros))
+  {
+  }
+
+  /** Creates a shared reference to another map's data.
+  */
+  PlanarMap2D (PlanarMap2D const& other)
+    : m_data (other.m_data)
+  {
+  }
+
+  /** Set this as a shared reference to another map's data.
+  */
+  PlanarMap2D& operator= (PlanarMap2D const& other)
+  {
+    m_data = other.m_data;
+    return *this;
+  }
+
+  /** Returns true if the map is null.
+  */
+  bool isNull () const noexcept
+  {
+    return m_data == nullptr;
+  }
+
+  /** Returns true if the map is not null.
+  */
+  bool isValid () const noexcept
+  {
+    return m_data != nullptr;
+  }
+
+  /** Get the number of rows.
+  */
+  inline int getRows () const noexcept
+  {
+    return m_data->getRows ();
+  }
+
+  /** Get the number of columns.
+  */
+  inline int getCols () const noexcept
+  {
+    return m_data->getCols ();
+  }
+
+  /** Get the layout of each plane.
+  */
+  inline Layout const& getLayout () const noexcept
+  {
+    return m_data->getLayout ();
+  }
+
+  /** Get a pointer to the start of a channel's plane.
+
+      The plane holds Layout::getPlaneSize() elements, including padding.
+  */
+  inline T* getChannel (int channel) const noexcept
+  {
+    return m_data->getChannel (channel);
+  }
+
+  /** Access an element.
+  */
+  inline T& get (int channel, int x, int y) const noexcept
+  {
+    return m_data->get (channel, x, y);
+  }
+
+  /** Access an element.
+  */
+  inline T& operator() (int channel, int x, int y) const noexcept
+  {
+    return get (channel, x, y);
+  }
+
+  /** View a row of one channel.
+
+      The elements are contiguous and the first is aligned to a cache line.
+      This requires the Linear layout.
+  */
+  StridedView <T> getRow (int channel, int y) const noexcept
+  {
+    jassert (isPositiveAndBelow (y, getRows ()));
+
+    T* const row = getChannel (channel) + size_t (y) * getLayout ().getRowStride ();
+
+    return StridedView <T> (row, getCols (), 1);
+  }
+
+  /** View a column of one channel.
+
+      This requires the Linear layout.
+  */
+  StridedView <T> getColumn (int channel, int x) const noexcept
+  {
+    jassert (isPositiveAndBelow (x, getCols ()));
+
+    return StridedView <T> (&get (channel, x, 0), getRows (), getLayout ().getRowStride ());
+  }
+
+  /** Initialize all elements of one channel with a value.
+  */
+  void reset (int channel, T value) const noexcept
+  {
+    T* const plane = getChannel (channel);
+
+    std::fill (plane, plane + getLayout ().getPlaneSize (), value);
+  }
+
+  /** Initialize all elements of every channel with a value.
+  */
+  void reset (T value) const noexcept
+  {
+    for (int channel = 0; channel < Channels; ++channel)
+      reset (channel, value);
+  }
+
+private:
+  class Data : public ReferenceCountedObject
+  {
+  public:
+    typedef ReferenceCountedObjectPtr <Data> Ptr;
+
+    Data (int width, int height, bool fillMemoryWithZeros)
+      : m_rows (height)
+      , m_cols (width)
+    {
+      m_layout.setSize (width, height, Memory::cacheLineElementMultiple <T> ());
+
+      m_planeSize = m_layout.getPlaneSize ();
+
+      m_block.allocate (m_planeSize * Channels, fillMemoryWithZeros);
+    }
+
+    inline int getRows () const noexcept
+    {
+      return m_rows;
+    }
+
+    inline int getCols () const noexcept
+    {
+      return m_cols;
+    }
+
+    inline Layout const& getLayout () const noexcept
+    {
+      return m_layout;
+    }
+
+    inline T* getChannel (int channel) const noexcept
+    {
+      jassert (isPositiveAndBelow (channel, int (Channels)));
+
+      return m_block.getData () + channel * m_planeSize;
+    }
+
+    inline T& get (int channel, int x, int y) const noexcept
+    {
+      jassert (isPositiveAndBelow (x, m_cols) && isPositiveAndBelow (y, m_rows));
+
+      return getChannel (channel) [m_layout.getOffset (x, y)];
+    }
+
+  private:
+    int const m_rows;
+    int const m_cols;
+    Layout m_layout;
+    size_t m_planeSize;
+    AlignedHeapBlock <T> m_block;
+  };
+
+  typename Data::Ptr m_data;
+};
+
+#endif
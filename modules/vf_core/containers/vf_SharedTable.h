@@ -35,7 +35,8 @@
 
 /** Handle to a reference counted fixed size table.
 
-    @note Currently, ElementType must be an aggregate of POD.
+    Entries may be of any copyable type. For a table which is edited while
+    other threads read it, see VersionedSharedTable.
 
     @tparam ElementType The type of element.
     
@@ -57,11 +58,10 @@ public:
 
   /** Creates a table with the specified number of entries.
 
-      The entries are uninitialized.
+      The entries are default constructed, which leaves plain data
+      uninitialized.
 
       @param numEntries The number of entries in the table.
-
-      @todo Initialize the data if ElementType is not POD.
   */
   explicit SharedTable (int numEntries)
     : m_data (new Data (numEntries))
@@ -174,22 +174,37 @@ private:
   public:
     typedef ReferenceCountedObjectPtr <Data> Ptr;
 
-    explicit Data (int numEntries)
+    explicit Data (int numEntries, ElementType const* source = nullptr)
       : m_numEntries (numEntries)
       , m_table (numEntries)
     {
+      int i = 0;
+
+      try
+      {
+        for (; i < m_numEntries; ++i)
+        {
+          if (source != nullptr)
+            new (m_table + i) ElementType (source [i]);
+          else
+            new (m_table + i) ElementType;
+        }
+      }
+      catch (...)
+      {
+        destroyEntries (i);
+        throw;
+      }
     }
 
-    inline Data* clone () const
+    ~Data ()
     {
-      Data* data = new Data (m_numEntries);
-
-      memcpy (
-        data->m_table.getData (),
-        m_table.getData (),
-        m_numEntries * sizeof (ElementType));
+      destroyEntries (m_numEntries);
+    }
 
-      return data;
+    inline Data* clone () const
+    {
+      return new Data (m_numEntries, m_table);
     }
 
     inline int getNumEntries () const
@@ -204,6 +219,12 @@ private:
     }
 
   private:
+    void destroyEntries (int count) noexcept
+    {
+      for (int i = count; --i >= 0;)
+        m_table [i].~ElementType ();
+    }
+
     int const m_numEntries;
     HeapBlock <ElementType> const m_table;
   };
@@ -0,0 +1,687 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_SORTEDLOOKUPLAYOUT_VFHEADER
+#define VF_SORTEDLOOKUPLAYOUT_VFHEADER
+
+#include "../math/vf_MurmurHash.h"
+
+/*============================================================================*/
+/**
+  Prepared key layouts for SortedLookupTable.
+
+  A layout receives the keys of the table in ascending order when the table
+  is prepared, arranges them in whatever way makes its lookups fast, and
+  afterwards maps a key to the position of its value. The table stores its
+  values in the order the layout chooses, so a lookup touches one key array
+  and then one value.
+
+  - Sorted keeps the keys in order and uses a binary search. It has no
+    overhead and is the default.
+
+  - Eytzinger stores the keys in breadth-first order of an implicit binary
+    tree. The first levels of the tree share a few cache lines, and the
+    descent is branch free, which makes it much faster than a binary search
+    once the table no longer fits in the cache.
+
+  - BTree groups the keys into blocks of 16, arranged as an implicit search
+    tree with 17 children per block. Each block is searched by comparing all
+    of its keys at once, with SSE2 for `int` keys, so a lookup visits about
+    a quarter as many cache lines as the Eytzinger layout.
+
+  - PerfectHash builds a static perfect hash with the hash and displace
+    method. A lookup costs two hashes and exactly one probe, independent of
+    the size of the table. Keys must be supported by Murmur::HashFunction and
+    be default constructible.
+
+  Every layout requires the keys to be distinct.
+
+  Each layout can also search for a batch of keys at once. The searches of a
+  group of keys advance together, one step at a time, and every step first
+  prefetches the memory that all of them will touch next. The cache misses
+  of the group then overlap instead of following one another.
+
+  A layout obeys this concept:
+
+  @code
+
+  template <class Key>
+  struct Layout
+  {
+    // Arrange the sorted, distinct keys. On return, element i of order
+    // holds the index into sortedKeys of the value to store at position i.
+    void build (std::vector <Key> const& sortedKeys, std::vector <int>& order);
+
+    // Return the position of the key, or -1 if it is missing.
+    int find (Key const& key) const;
+
+    // Store the position of each key, or -1 if it is missing.
+    void findMany (Key const* keys, int numberOfKeys, int* positions) const;
+  };
+
+  @endcode
+
+  @ingroup vf_core
+*/
+struct SortedLookupLayout
+{
+  enum
+  {
+    keysPerBlock = 16,
+    keysPerGroup = 16
+  };
+
+  /** Hint the processor to fetch memory into the cache.
+  */
+  static inline void prefetch (void const* address)
+  {
+#if defined (__GNUC__)
+    __builtin_prefetch (address);
+#elif VF_USE_SSE2
+    _mm_prefetch (static_cast <char const*> (address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  /** Keys in ascending order, searched with a binary search.
+  */
+  template <class Key>
+  class Sorted
+  {
+  public:
+    Sorted () : m_size (0), m_keys (keysPerBlock)
+    {
+    }
+
+    void build (std::vector <Key> const& sortedKeys, std::vector <int>& order)
+    {
+      m_size = int (sortedKeys.size ());
+
+      // Pad with the largest key so the final block of a batched
+      // search can always read keysPerBlock keys.
+      Key const pad = m_size > 0 ? sortedKeys.back () : Key ();
+
+      m_keys = sortedKeys;
+      m_keys.insert (m_keys.end (), int (keysPerBlock), pad);
+
+      setIdentity (order, m_size);
+    }
+
+    int find (Key const& key) const
+    {
+      typename std::vector <Key>::const_iterator const end =
+        m_keys.begin () + m_size;
+
+      typename std::vector <Key>::const_iterator iter =
+        std::lower_bound (m_keys.begin (), end, key);
+
+      if (iter != end && !(key < *iter))
+        return int (iter - m_keys.begin ());
+
+      return -1;
+    }
+
+    void findMany (Key const* keys, int numberOfKeys, int* positions) const
+    {
+      Key const* const sorted = &m_keys [0];
+
+      for (int first = 0; first < numberOfKeys; first += keysPerGroup)
+      {
+        int const count = jmin (int (keysPerGroup), numberOfKeys - first);
+
+        Key const* const key = keys + first;
+
+        // The first key not less than key [i] is always in
+        // [base [i], base [i] + length].
+        int base [keysPerGroup];
+        for (int i = 0; i < count; ++i)
+          base [i] = 0;
+
+        // Every search halves the same length, so they stay in step.
+        int length = m_size;
+        while (length > keysPerBlock)
+        {
+          int const half = length / 2;
+
+          for (int i = 0; i < count; ++i)
+            prefetch (sorted + base [i] + half);
+
+          for (int i = 0; i < count; ++i)
+            base [i] = (sorted [base [i] + half] < key [i]) ? base [i] + half : base [i];
+
+          length -= half;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+          int const position = base [i] + countLess (sorted + base [i], key [i]);
+
+          if (position < m_size && !(key [i] < sorted [position]))
+            positions [first + i] = position;
+          else
+            positions [first + i] = -1;
+        }
+      }
+    }
+
+  private:
+    int m_size;
+    std::vector <Key> m_keys;
+  };
+
+  //----------------------------------------------------------------------------
+  /** Keys in breadth-first order of an implicit binary search tree.
+  */
+  template <class Key>
+  class Eytzinger
+  {
+  public:
+    Eytzinger () : m_size (0), m_levels (0), m_keys (1)
+    {
+    }
+
+    void build (std::vector <Key> const& sortedKeys, std::vector <int>& order)
+    {
+      m_size = int (sortedKeys.size ());
+
+      m_levels = 0;
+      for (int64 k = 1; k <= m_size; k *= 2)
+        ++m_levels;
+
+      // Node k has children 2k and 2k+1. Slot 0 is unused.
+      m_keys.assign (m_size + 1, Key ());
+      order.resize (m_size);
+
+      int next = 0;
+      fill (sortedKeys, order, next, 1);
+    }
+
+    int find (Key const& key) const
+    {
+      Key const* const tree = &m_keys [0];
+
+      // Go right while the node is less than the key. This ends below
+      // a leaf, at the path that leads to the first key not less.
+      int k = 1;
+      while (k <= m_size)
+        k = 2 * k + (tree [k] < key ? 1 : 0);
+
+      return positionOf (k, key);
+    }
+
+    void findMany (Key const* keys, int numberOfKeys, int* positions) const
+    {
+      Key const* const tree = &m_keys [0];
+
+      for (int first = 0; first < numberOfKeys; first += keysPerGroup)
+      {
+        int const count = jmin (int (keysPerGroup), numberOfKeys - first);
+
+        Key const* const key = keys + first;
+
+        int k [keysPerGroup];
+        for (int i = 0; i < count; ++i)
+          k [i] = 1;
+
+        for (int level = 0; level < m_levels; ++level)
+        {
+          for (int i = 0; i < count; ++i)
+          {
+            if (k [i] <= m_size)
+            {
+              k [i] = 2 * k [i] + (tree [k [i]] < key [i] ? 1 : 0);
+
+              // The sixteen descendants four levels down are adjacent.
+              if (16 * int64 (k [i]) <= m_size)
+                prefetch (tree + 16 * k [i]);
+            }
+          }
+        }
+
+        for (int i = 0; i < count; ++i)
+          positions [first + i] = positionOf (k [i], key [i]);
+      }
+    }
+
+  private:
+    int positionOf (int k, Key const& key) const
+    {
+      // Undo the final right turns and the last left turn.
+      while ((k & 1) != 0)
+        k >>= 1;
+      k >>= 1;
+
+      if (k != 0 && !(key < m_keys [k]))
+        return k - 1;
+
+      return -1;
+    }
+
+    void fill (std::vector <Key> const& sortedKeys,
+               std::vector <int>& order,
+               int& next,
+               int k)
+    {
+      if (k <= m_size)
+      {
+        fill (sortedKeys, order, next, 2 * k);
+
+        m_keys [k] = sortedKeys [next];
+        order [k - 1] = next;
+        ++next;
+
+        fill (sortedKeys, order, next, 2 * k + 1);
+      }
+    }
+
+  private:
+    int m_size;
+    int m_levels;
+    std::vector <Key> m_keys;
+  };
+
+  //----------------------------------------------------------------------------
+  /** Blocks of keys in an implicit search tree, searched with SIMD compares.
+  */
+  template <class Key>
+  class BTree
+  {
+  public:
+    BTree () : m_blocks (0)
+    {
+    }
+
+    void build (std::vector <Key> const& sortedKeys, std::vector <int>& order)
+    {
+      int const size = int (sortedKeys.size ());
+
+      m_blocks = (size + keysPerBlock - 1) / keysPerBlock;
+
+      // The unused slots of the last block are padded with the largest key
+      // so that comparisons stay meaningful. They have no position.
+      Key const pad = size > 0 ? sortedKeys.back () : Key ();
+
+      m_keys.assign (m_blocks * keysPerBlock, pad);
+      m_positions.assign (m_blocks * keysPerBlock, -1);
+
+      int next = 0;
+      fill (sortedKeys, next, 0);
+
+      setIdentity (order, size);
+    }
+
+    int find (Key const& key) const
+    {
+      int candidate = -1;
+
+      // Block k has children k * (keysPerBlock + 1) + 1 + i.
+      int k = 0;
+      while (k < m_blocks)
+      {
+        int const i = countLess (&m_keys [k * keysPerBlock], key);
+
+        if (i < keysPerBlock)
+          candidate = k * keysPerBlock + i;
+
+        k = k * (keysPerBlock + 1) + 1 + i;
+      }
+
+      return positionOf (candidate, key);
+    }
+
+    void findMany (Key const* keys, int numberOfKeys, int* positions) const
+    {
+      for (int first = 0; first < numberOfKeys; first += keysPerGroup)
+      {
+        int const count = jmin (int (keysPerGroup), numberOfKeys - first);
+
+        Key const* const key = keys + first;
+
+        int k [keysPerGroup];
+        int candidate [keysPerGroup];
+        for (int i = 0; i < count; ++i)
+        {
+          k [i] = 0;
+          candidate [i] = -1;
+        }
+
+        // Leaves are at most one level apart, so the searches
+        // finish within one step of each other.
+        for (bool active = m_blocks > 0; active;)
+        {
+          active = false;
+
+          for (int i = 0; i < count; ++i)
+          {
+            if (k [i] < m_blocks)
+            {
+              int const j = countLess (&m_keys [k [i] * keysPerBlock], key [i]);
+
+              if (j < keysPerBlock)
+                candidate [i] = k [i] * keysPerBlock + j;
+
+              k [i] = k [i] * (keysPerBlock + 1) + 1 + j;
+
+              if (k [i] < m_blocks)
+              {
+                prefetch (&m_keys [k [i] * keysPerBlock]);
+                active = true;
+              }
+            }
+          }
+        }
+
+        for (int i = 0; i < count; ++i)
+          positions [first + i] = positionOf (candidate [i], key [i]);
+      }
+    }
+
+  private:
+    int positionOf (int candidate, Key const& key) const
+    {
+      if (candidate != -1 && !(key < m_keys [candidate]))
+        return m_positions [candidate];
+
+      return -1;
+    }
+
+    void fill (std::vector <Key> const& sortedKeys, int& next, int k)
+    {
+      if (k < m_blocks)
+      {
+        int const size = int (sortedKeys.size ());
+
+        for (int i = 0; i < keysPerBlock; ++i)
+        {
+          fill (sortedKeys, next, k * (keysPerBlock + 1) + 1 + i);
+
+          if (next < size)
+          {
+            m_keys [k * keysPerBlock + i] = sortedKeys [next];
+            m_positions [k * keysPerBlock + i] = next;
+            ++next;
+          }
+        }
+
+        fill (sortedKeys, next, k * (keysPerBlock + 1) + 1 + keysPerBlock);
+      }
+    }
+
+  private:
+    int m_blocks;
+    std::vector <Key> m_keys;
+    std::vector <int> m_positions;
+  };
+
+  //----------------------------------------------------------------------------
+  /** Static perfect hash table, built with hash and displace.
+  */
+  template <class Key>
+  class PerfectHash
+  {
+  public:
+    enum
+    {
+      keysPerBucket = 4,
+      maximumSeeds = 1 << 20
+    };
+
+    PerfectHash () : m_buckets (1), m_slots (1), m_seeds (1)
+    {
+    }
+
+    void build (std::vector <Key> const& sortedKeys, std::vector <int>& order)
+    {
+      int const size = int (sortedKeys.size ());
+
+      // One slot in five stays empty, which keeps the seed search short.
+      m_buckets = uint32 (size / keysPerBucket + 1);
+      m_slots.assign (size + size / 4 + 1, Slot ());
+      m_seeds.assign (m_buckets, 0);
+
+      // Group the keys by their bucket, largest buckets first.
+      std::vector <std::pair <int, int> > buckets (size);
+      std::vector <int> bucketSize (m_buckets, 0);
+
+      for (int i = 0; i < size; ++i)
+      {
+        int const bucket = int (bucketOf (sortedKeys [i]));
+        buckets [i] = std::make_pair (bucket, i);
+        ++bucketSize [bucket];
+      }
+
+      std::sort (buckets.begin (), buckets.end (), LargestBucketFirst (bucketSize));
+
+      std::vector <uint32> slots;
+
+      for (int first = 0; first < size;)
+      {
+        int const bucket = buckets [first].first;
+        int const last = first + bucketSize [bucket];
+
+        // Find a seed that sends every key of the bucket to a distinct
+        // empty slot.
+        uint32 seed = 1;
+        for (;;)
+        {
+          if (seed == uint32 (maximumSeeds))
+            Throw (Error().fail (__FILE__, __LINE__));
+
+          if (tryPlace (sortedKeys, buckets, first, last, seed, slots))
+            break;
+
+          ++seed;
+        }
+
+        m_seeds [bucket] = seed;
+
+        for (int i = first; i < last; ++i)
+        {
+          int const position = buckets [i].second;
+          m_slots [slots [i - first]].key = sortedKeys [position];
+          m_slots [slots [i - first]].position = position;
+        }
+
+        first = last;
+      }
+
+      setIdentity (order, size);
+    }
+
+    int find (Key const& key) const
+    {
+      uint32 const seed = m_seeds [bucketOf (key)];
+
+      Slot const& slot = m_slots [slotOf (key, seed)];
+
+      if (slot.position != -1 && !(key < slot.key) && !(slot.key < key))
+        return slot.position;
+
+      return -1;
+    }
+
+    void findMany (Key const* keys, int numberOfKeys, int* positions) const
+    {
+      for (int first = 0; first < numberOfKeys; first += keysPerGroup)
+      {
+        int const count = jmin (int (keysPerGroup), numberOfKeys - first);
+
+        Key const* const key = keys + first;
+
+        // Fetch the seeds, then the slots, for the whole group.
+        uint32 index [keysPerGroup];
+
+        for (int i = 0; i < count; ++i)
+        {
+          index [i] = bucketOf (key [i]);
+          prefetch (&m_seeds [index [i]]);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+          index [i] = slotOf (key [i], m_seeds [index [i]]);
+          prefetch (&m_slots [index [i]]);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+          Slot const& slot = m_slots [index [i]];
+
+          if (slot.position != -1 && !(key [i] < slot.key) && !(slot.key < key [i]))
+            positions [first + i] = slot.position;
+          else
+            positions [first + i] = -1;
+        }
+      }
+    }
+
+  private:
+    struct Slot
+    {
+      Slot () : key (), position (-1)
+      {
+      }
+
+      Key key;
+      int position;
+    };
+
+    struct LargestBucketFirst
+    {
+      explicit LargestBucketFirst (std::vector <int> const& bucketSize)
+        : m_bucketSize (bucketSize)
+      {
+      }
+
+      bool operator() (std::pair <int, int> const& lhs,
+                       std::pair <int, int> const& rhs) const
+      {
+        int const lhsSize = m_bucketSize [lhs.first];
+        int const rhsSize = m_bucketSize [rhs.first];
+
+        if (lhsSize != rhsSize)
+          return lhsSize > rhsSize;
+
+        return lhs < rhs;
+      }
+
+    private:
+      std::vector <int> const& m_bucketSize;
+    };
+
+    bool tryPlace (std::vector <Key> const& sortedKeys,
+                   std::vector <std::pair <int, int> > const& buckets,
+                   int first,
+                   int last,
+                   uint32 seed,
+                   std::vector <uint32>& slots) const
+    {
+      slots.clear ();
+
+      for (int i = first; i < last; ++i)
+      {
+        uint32 const slot = slotOf (sortedKeys [buckets [i].second], seed);
+
+        if (m_slots [slot].position != -1)
+          return false;
+
+        if (std::find (slots.begin (), slots.end (), slot) != slots.end ())
+          return false;
+
+        slots.push_back (slot);
+      }
+
+      return true;
+    }
+
+    inline uint32 bucketOf (Key const& key) const
+    {
+      return Murmur::HashFunction <Key> (0) (key) % m_buckets;
+    }
+
+    inline uint32 slotOf (Key const& key, uint32 seed) const
+    {
+      return Murmur::HashFunction <Key> (seed) (key) % uint32 (m_slots.size ());
+    }
+
+  private:
+    uint32 m_buckets;
+    std::vector <Slot> m_slots;
+    std::vector <uint32> m_seeds;
+  };
+
+private:
+  static void setIdentity (std::vector <int>& order, int size)
+  {
+    order.resize (size);
+
+    for (int i = 0; i < size; ++i)
+      order [i] = i;
+  }
+
+  // Count the keys of a block which are less than key.
+  template <class Key>
+  static int countLess (Key const* block, Key const& key)
+  {
+    int count = 0;
+    for (int i = 0; i < keysPerBlock; ++i)
+      count += (block [i] < key) ? 1 : 0;
+    return count;
+  }
+
+#if VF_USE_SSE2
+  static int countLess (int const* block, int const& key)
+  {
+    __m128i const k = _mm_set1_epi32 (key);
+    __m128i const* const p = reinterpret_cast <__m128i const*> (block);
+
+    __m128i const a = _mm_cmplt_epi32 (_mm_loadu_si128 (p + 0), k);
+    __m128i const b = _mm_cmplt_epi32 (_mm_loadu_si128 (p + 1), k);
+    __m128i const c = _mm_cmplt_epi32 (_mm_loadu_si128 (p + 2), k);
+    __m128i const d = _mm_cmplt_epi32 (_mm_loadu_si128 (p + 3), k);
+
+    // Narrow the lanes to bytes, so each key that compared less sets
+    // one bit of the mask.
+    int mask = _mm_movemask_epi8 (_mm_packs_epi16 (
+      _mm_packs_epi32 (a, b), _mm_packs_epi32 (c, d)));
+
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1)
+      ++count;
+    return count;
+  }
+#endif
+};
+
+#endif
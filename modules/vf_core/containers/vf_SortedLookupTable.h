@@ -33,6 +33,8 @@
 #ifndef VF_SORTEDLOOKUPTABLE_VFHEADER
 #define VF_SORTEDLOOKUPTABLE_VFHEADER
 
+#include "vf_SortedLookupLayout.h"
+
 //==============================================================================
 /**
   Sorted map for fast lookups.
@@ -57,8 +59,25 @@
   To use the table, reserve space with reserveSpaceForValues() if the number
   of elements is known ahead of time. Then, call insert() for  all the your
   elements. Call prepareForLookups() once then call lookupValueByKey () 
+
+  Layout chooses how the keys are arranged for lookups. The default keeps
+  them sorted; for large tables, the other layouts in SortedLookupLayout
+  touch fewer cache lines per lookup:
+
+  @code
+
+  SortedLookupTable <Schema, SortedLookupLayout::Eytzinger> table;
+
+  @endcode
+
+  The key of each value is retrieved once, by prepareForLookups(). Lookups
+  only compare keys stored by the layout.
+
+  When many keys are resolved at once, lookupMany() overlaps the cache misses
+  of their searches, and it can spread a large batch over a ParallelFor.
 */
-template <class SchemaType>
+template <class SchemaType,
+          template <class> class Layout = SortedLookupLayout::Sorted>
 class SortedLookupTable
 {
 private:
@@ -68,31 +87,15 @@ private:
   typedef std::vector <ValueType> values_t;
 
   values_t m_values;
+  Layout <KeyType> m_layout;
 
 private:
   struct SortCompare
   {
-    bool operator() (ValueType const& lhs, ValueType const& rhs) const
-    {
-      return SchemaType().getKey (lhs) < SchemaType().getKey (rhs);
-    }
-  };
-
-  struct FindCompare
-  {
-    bool operator () (ValueType const& lhs, ValueType const& rhs)
-    {
-      return SchemaType().getKey (lhs) < SchemaType().getKey (rhs);
-    }
-
-    bool operator () (KeyType const& key, ValueType const& rhs)
-    {
-      return key < SchemaType().getKey (rhs);
-    }
-
-    bool operator() (ValueType const& lhs, KeyType const& key)
+    bool operator() (std::pair <KeyType, int> const& lhs,
+                     std::pair <KeyType, int> const& rhs) const
     {
-      return SchemaType().getKey (lhs) < key;
+      return lhs.first < rhs.first;
     }
   };
 
@@ -129,7 +132,33 @@ public:
   */
   void prepareForLookups ()
   {
-    std::sort (m_values.begin (), m_values.end (), SortCompare ());
+    int const size = int (m_values.size ());
+
+    // Sort the keys along with the index of their value.
+    std::vector <std::pair <KeyType, int> > entries;
+    entries.reserve (size);
+
+    SchemaType schema;
+    for (int i = 0; i < size; ++i)
+      entries.push_back (std::make_pair (schema.getKey (m_values [i]), i));
+
+    std::sort (entries.begin (), entries.end (), SortCompare ());
+
+    std::vector <KeyType> sortedKeys;
+    sortedKeys.reserve (size);
+    for (int i = 0; i < size; ++i)
+      sortedKeys.push_back (entries [i].first);
+
+    std::vector <int> order;
+    m_layout.build (sortedKeys, order);
+
+    // Store the values in the order chosen by the layout.
+    values_t values;
+    values.reserve (size);
+    for (int i = 0; i < size; ++i)
+      values.push_back (m_values [entries [order [i]].second]);
+
+    m_values.swap (values);
   }
 
   /** Find the value for a key.
@@ -149,12 +178,11 @@ public:
   {
     bool found;
 
-    std::pair <typename values_t::iterator, typename values_t::iterator> result =
-      std::equal_range (m_values.begin (), m_values.end (), key, FindCompare ());
+    int const position = m_layout.find (key);
 
-    if (result.first != result.second)
+    if (position != -1)
     {
-      *pFoundValue = *result.first;
+      *pFoundValue = m_values [position];
       found = true;
     }
     else
@@ -164,6 +192,108 @@ public:
 
     return found;
   }
+
+  /** Find the values for a batch of keys.
+
+      This produces the same results as calling lookupValueByKey() for each
+      key, but the searches proceed in interleaved groups so that their
+      memory accesses overlap.
+
+      @invariant You must call prepareForLookups() once, after all
+                 insertions, before calling this function.
+
+      @param keys         The keys to locate.
+      @param numberOfKeys The number of keys.
+      @param values       Receives the value of each key that was found.
+                          The values of missing keys are left unchanged.
+      @param found        If not null, receives `true` for each key that
+                          was found and `false` for the others.
+      @return The number of keys that were found.
+  */
+  int lookupMany (KeyType const* keys,
+                  int numberOfKeys,
+                  ValueType* values,
+                  bool* found = 0)
+  {
+    int numberFound = 0;
+
+    int positions [lookupsPerBatch];
+
+    for (int first = 0; first < numberOfKeys; first += lookupsPerBatch)
+    {
+      int const count = jmin (int (lookupsPerBatch), numberOfKeys - first);
+
+      m_layout.findMany (keys + first, count, positions);
+
+      for (int i = 0; i < count; ++i)
+      {
+        if (positions [i] != -1)
+          SortedLookupLayout::prefetch (&m_values [positions [i]]);
+      }
+
+      for (int i = 0; i < count; ++i)
+      {
+        bool const isFound = positions [i] != -1;
+
+        if (isFound)
+        {
+          values [first + i] = m_values [positions [i]];
+          ++numberFound;
+        }
+
+        if (found != 0)
+          found [first + i] = isFound;
+      }
+    }
+
+    return numberFound;
+  }
+
+  /** Find the values for a batch of keys in parallel.
+
+      The keys are split into chunks which are looked up with lookupMany()
+      on the threads of a ParallelFor. Small batches are not worth it.
+
+      @param parallelFor The ParallelFor to run the chunks on.
+      @return The number of keys that were found.
+  */
+  template <class ParallelForType>
+  int lookupMany (KeyType const* keys,
+                  int numberOfKeys,
+                  ValueType* values,
+                  bool* found,
+                  ParallelForType& parallelFor)
+  {
+    Atomic <int> numberFound;
+
+    int const numberOfChunks = (numberOfKeys + lookupsPerChunk - 1) / lookupsPerChunk;
+
+    parallelFor.loop (numberOfChunks, &SortedLookupTable::lookupChunk,
+      this, keys, numberOfKeys, values, found, &numberFound);
+
+    return numberFound.get ();
+  }
+
+private:
+  enum
+  {
+    lookupsPerBatch = 256,
+    lookupsPerChunk = 16384
+  };
+
+  void lookupChunk (KeyType const* keys,
+                    int numberOfKeys,
+                    ValueType* values,
+                    bool* found,
+                    Atomic <int>* numberFound,
+                    int chunkIndex)
+  {
+    int const first = chunkIndex * lookupsPerChunk;
+    int const count = jmin (int (lookupsPerChunk), numberOfKeys - first);
+
+    *numberFound += lookupMany (keys + first, count, values + first,
+                                found != 0 ? found + first : 0);
+  }
 };
 
 #endif
@@ -0,0 +1,472 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_VERSIONEDSHAREDTABLE_VFHEADER
+#define VF_VERSIONEDSHAREDTABLE_VFHEADER
+
+#include "../memory/vf_AtomicCounter.h"
+#include "../memory/vf_CacheLine.h"
+#include "../threads/vf_SpinDelay.h"
+
+/*============================================================================*/
+/**
+  Fixed size table with copy-on-write versions.
+
+  This is for tables that one thread edits while others read them. An
+  audio thread that reads a lookup table which the GUI changes is one
+  example. Readers never wait for a lock, and they never see a partly
+  edited table.
+
+  The entries are stored in chunks of 2^ChunkBits entries. A version of the
+  table is a list of references to chunks. Writers make changes through an
+  Edit. The Edit shares the chunks of the published version and copies a
+  chunk only the first time one of its entries is changed. publish() swaps
+  the edited version in with an atomic store. Each Snapshot that is taken
+  afterwards sees the new version.
+
+  A Snapshot is a short lived reading section. Taking one costs two atomic
+  operations and does not allocate. A publish waits for the Snapshot
+  objects that were taken before it, then releases the old version on the
+  writing thread. This way the readers never free memory. Keep a Snapshot
+  only for the duration of one access, such as one audio callback.
+
+  Entries may be of any copyable type. They are default constructed, which
+  leaves plain data uninitialized as in SharedTable.
+
+  @code
+
+  VersionedSharedTable <float> table (1024);
+
+  // Writer
+  VersionedSharedTable <float>::Edit edit (table);
+  edit.set (10, 0.5f);
+  table.publish (edit);
+
+  // Reader
+  VersionedSharedTable <float>::Snapshot snapshot (table);
+  float value = snapshot [10];
+
+  @endcode
+
+  @tparam ElementType The type of element.
+  @tparam ChunkBits   The base 2 logarithm of the entries per chunk.
+
+  @ingroup vf_core
+*/
+template <class ElementType, int ChunkBits = 6>
+class VersionedSharedTable : Uncopyable
+{
+private:
+  class Version;
+
+public:
+  typedef ElementType Entry;
+
+  enum
+  {
+    entriesPerChunk = 1 << ChunkBits
+  };
+
+  /** Create a table with the specified number of entries.
+
+      The table starts with version number zero.
+  */
+  explicit VersionedSharedTable (int numEntries)
+    : m_current (new Version (numEntries))
+  {
+    m_current.get ()->incReferenceCount ();
+  }
+
+  /** Destroy the table.
+
+      @invariant No Snapshot or Edit of this table may exist.
+  */
+  ~VersionedSharedTable ()
+  {
+    m_current.get ()->decReferenceCount ();
+  }
+
+  /** Returns the number of the most recently published version.
+  */
+  int getVersion () const noexcept
+  {
+    return m_number.get ();
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Read access to the published version of a table.
+
+      The version stays the same for the lifetime of the Snapshot, even if a
+      new version is published in the meantime.
+  */
+  class Snapshot : Uncopyable
+  {
+  public:
+    explicit Snapshot (VersionedSharedTable const& table) noexcept
+      : m_table (table)
+      , m_slot (table.enterRead ())
+      , m_version (table.m_current.get ())
+    {
+    }
+
+    ~Snapshot () noexcept
+    {
+      m_table.leaveRead (m_slot);
+    }
+
+    /** Returns the number of the version being read.
+    */
+    int getVersion () const noexcept
+    {
+      return m_version->getNumber ();
+    }
+
+    /** Return the number of entries in the table.
+    */
+    inline int getNumEntries () const noexcept
+    {
+      return m_version->getNumEntries ();
+    }
+
+    /** Retrieve a table entry.
+
+        @param index The index of the entry, from 0 to getNumEntries ().
+    */
+    inline ElementType const& operator[] (int index) const noexcept
+    {
+      return m_version->getReference (index);
+    }
+
+  private:
+    VersionedSharedTable const& m_table;
+    int const m_slot;
+    Version const* const m_version;
+  };
+
+  //----------------------------------------------------------------------------
+
+  /** A private, modifiable copy of the published version.
+
+      Changes made through the Edit are visible only through the Edit until
+      they are published. An Edit may be used from only one thread at a time.
+
+      Each Edit starts from the version that was published when it was
+      created. If two Edit objects exist at the same time, the one published
+      last replaces the whole table, discarding the changes published by the
+      other one.
+  */
+  class Edit : Uncopyable
+  {
+  public:
+    /** Start editing the published version of a table.
+    */
+    explicit Edit (VersionedSharedTable& table)
+      : m_table (table)
+    {
+      CriticalSection::ScopedLockType lock (table.m_writeMutex);
+
+      m_version = new Version (*table.m_current.get ());
+    }
+
+    /** Return the number of entries in the table.
+    */
+    inline int getNumEntries () const noexcept
+    {
+      return m_version->getNumEntries ();
+    }
+
+    /** Retrieve a table entry for reading.
+    */
+    inline ElementType const& operator[] (int index) const noexcept
+    {
+      return m_version->getReference (index);
+    }
+
+    /** Retrieve a table entry for writing.
+
+        If the chunk holding the entry is shared with another version, the
+        chunk is copied first.
+    */
+    ElementType& getModifiable (int index)
+    {
+      return m_version->getModifiableReference (index);
+    }
+
+    /** Change a table entry.
+    */
+    void set (int index, ElementType const& value)
+    {
+      getModifiable (index) = value;
+    }
+
+  private:
+    friend class VersionedSharedTable;
+
+    VersionedSharedTable& m_table;
+    typename Version::Ptr m_version;
+  };
+
+  //----------------------------------------------------------------------------
+
+  /** Make the changes in an Edit visible to readers.
+
+      The Edit's version becomes the published version. The Edit then
+      continues from it, so more changes can be made and published.
+
+      This waits until every Snapshot taken before the publish is destroyed.
+      Then the previous version is released. Chunks that the new version
+      still uses are kept.
+
+      @return The number of the new version.
+  */
+  int publish (Edit& edit)
+  {
+    jassert (&edit.m_table == this);
+
+    CriticalSection::ScopedLockType lock (m_writeMutex);
+
+    Version* const version = edit.m_version;
+
+    version->setNumber (m_current.get ()->getNumber () + 1);
+    version->incReferenceCount ();
+
+    Version* const previous = m_current.exchange (version);
+
+    m_number = version->getNumber ();
+
+    synchronize ();
+
+    previous->decReferenceCount ();
+
+    edit.m_version = new Version (*version);
+
+    return version->getNumber ();
+  }
+
+private:
+  //----------------------------------------------------------------------------
+
+  class Chunk : public ReferenceCountedObject
+  {
+  public:
+    typedef ReferenceCountedObjectPtr <Chunk> Ptr;
+
+    explicit Chunk (int numEntries, ElementType const* source = nullptr)
+      : m_numEntries (numEntries)
+      , m_entries (numEntries)
+    {
+      int i = 0;
+
+      try
+      {
+        for (; i < m_numEntries; ++i)
+        {
+          if (source != nullptr)
+            new (m_entries + i) ElementType (source [i]);
+          else
+            new (m_entries + i) ElementType;
+        }
+      }
+      catch (...)
+      {
+        destroyEntries (i);
+        throw;
+      }
+    }
+
+    ~Chunk ()
+    {
+      destroyEntries (m_numEntries);
+    }
+
+    inline int getNumEntries () const noexcept
+    {
+      return m_numEntries;
+    }
+
+    inline ElementType* getEntries () const noexcept
+    {
+      return m_entries;
+    }
+
+  private:
+    void destroyEntries (int count) noexcept
+    {
+      for (int i = count; --i >= 0;)
+        m_entries [i].~ElementType ();
+    }
+
+    int const m_numEntries;
+    HeapBlock <ElementType> const m_entries;
+  };
+
+  //----------------------------------------------------------------------------
+
+  class Version : public ReferenceCountedObject
+  {
+  public:
+    typedef ReferenceCountedObjectPtr <Version> Ptr;
+
+    explicit Version (int numEntries)
+      : m_number (0)
+      , m_numEntries (numEntries)
+      , m_numChunks ((numEntries + entriesPerChunk - 1) >> ChunkBits)
+      , m_chunks (m_numChunks, true)
+    {
+      for (int i = 0; i < m_numChunks; ++i)
+      {
+        int const count = jmin (int (entriesPerChunk), m_numEntries - (i << ChunkBits));
+
+        setChunk (i, new Chunk (count));
+      }
+    }
+
+    /** Share the chunks of another version. */
+    explicit Version (Version const& other)
+      : ReferenceCountedObject ()
+      , m_number (other.m_number)
+      , m_numEntries (other.m_numEntries)
+      , m_numChunks (other.m_numChunks)
+      , m_chunks (m_numChunks, true)
+    {
+      for (int i = 0; i < m_numChunks; ++i)
+        setChunk (i, other.m_chunks [i]);
+    }
+
+    ~Version ()
+    {
+      for (int i = 0; i < m_numChunks; ++i)
+        setChunk (i, nullptr);
+    }
+
+    inline int getNumber () const noexcept
+    {
+      return m_number;
+    }
+
+    inline void setNumber (int number) noexcept
+    {
+      m_number = number;
+    }
+
+    inline int getNumEntries () const noexcept
+    {
+      return m_numEntries;
+    }
+
+    inline ElementType const& getReference (int index) const noexcept
+    {
+      jassert (isPositiveAndBelow (index, m_numEntries));
+
+      return m_chunks [index >> ChunkBits]->getEntries () [index & (entriesPerChunk - 1)];
+    }
+
+    ElementType& getModifiableReference (int index)
+    {
+      jassert (isPositiveAndBelow (index, m_numEntries));
+
+      int const chunkIndex = index >> ChunkBits;
+
+      Chunk* chunk = m_chunks [chunkIndex];
+
+      // Copy on first write.
+      if (chunk->getReferenceCount () > 1)
+      {
+        chunk = new Chunk (chunk->getNumEntries (), chunk->getEntries ());
+
+        setChunk (chunkIndex, chunk);
+      }
+
+      return chunk->getEntries () [index & (entriesPerChunk - 1)];
+    }
+
+  private:
+    void setChunk (int chunkIndex, Chunk* chunk) noexcept
+    {
+      if (chunk != nullptr)
+        chunk->incReferenceCount ();
+
+      if (m_chunks [chunkIndex] != nullptr)
+        m_chunks [chunkIndex]->decReferenceCount ();
+
+      m_chunks [chunkIndex] = chunk;
+    }
+
+    int m_number;
+    int const m_numEntries;
+    int const m_numChunks;
+    HeapBlock <Chunk*> const m_chunks;
+  };
+
+  //----------------------------------------------------------------------------
+
+  // Readers register in the reader counter selected by the epoch. To retire
+  // a version, the writer flips the epoch and waits for the old counter to
+  // drain, twice, so that both counters have been empty at some point since
+  // the new version was stored.
+  //
+  int enterRead () const noexcept
+  {
+    int const slot = m_epoch.get () & 1;
+
+    m_readers [slot]->addref ();
+
+    return slot;
+  }
+
+  void leaveRead (int slot) const noexcept
+  {
+    m_readers [slot]->release ();
+  }
+
+  void synchronize ()
+  {
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      int const slot = (++m_epoch - 1) & 1;
+
+      SpinDelay delay;
+
+      while (m_readers [slot]->isSignaled ())
+        delay.pause ();
+    }
+  }
+
+  CriticalSection m_writeMutex;
+  Atomic <Version*> m_current;
+  Atomic <int> m_number;
+  Atomic <int> m_epoch;
+  mutable CacheLine::Padded <AtomicCounter> m_readers [2];
+};
+
+#endif
@@ -34,26 +34,81 @@
 
 /*============================================================================*/
 // Type-independent portion of Counter
+//
+// Counters are pushed on to the front of a list that is never shortened,
+// so it can be walked at any time without a lock.
+//
 class LeakCheckedBase::CounterBase::Singleton
+#if VF_USE_METRICS
+  : public Metrics::Source
+#endif
 {
 public:
+  Singleton ()
+  {
+#if VF_USE_METRICS
+    Metrics::add (this);
+#endif
+  }
+
+  ~Singleton ()
+  {
+#if VF_USE_METRICS
+    Metrics::remove (this);
+#endif
+  }
+
   void push_back (CounterBase* counter)
   {
-    m_list.push_front (counter);
+    do
+    {
+      counter->m_next = m_head.get ();
+    }
+    while (!m_head.compareAndSet (counter, counter->m_next));
   }
 
   void detectAllLeaks ()
   {
-    for (;;)
+    for (CounterBase* counter = m_head.get (); counter != nullptr; counter = counter->m_next)
+      counter->detectLeaks ();
+  }
+
+  void getStatistics (std::vector <Statistics>& statistics)
+  {
+    statistics.clear ();
+
+    for (CounterBase* counter = m_head.get (); counter != nullptr; counter = counter->m_next)
     {
-      CounterBase* counter = m_list.pop_front ();
+      statistics.push_back (Statistics ());
+      counter->getStatistics (statistics.back ());
+    }
+  }
 
-      if (!counter)
-        break;
-    
-      counter->detectLeaks ();
+#if VF_USE_METRICS
+  void addReports (Metrics::Snapshot& snapshot)
+  {
+    static char const* const stackKeys [numberOfStacks] =
+      { "stack0", "stack1", "stack2", "stack3" };
+
+    std::vector <Statistics> statistics;
+
+    getStatistics (statistics);
+
+    for (std::size_t i = 0; i < statistics.size (); ++i)
+    {
+      Statistics const& s = statistics [i];
+
+      Metrics::Report& report = snapshot.add ("LeakChecked", s.className);
+
+      report.addValue ("count", s.count);
+      report.addValue ("peak", s.peak);
+      report.addValue ("bytes", s.bytes);
+
+      for (int j = 0; j < s.stacks.size (); ++j)
+        report.addText (stackKeys [j], s.stacks [j]);
     }
   }
+#endif
 
   static Singleton& getInstance ()
   {
@@ -62,13 +117,19 @@ public:
     return instance;
   }
 
+  static int volatile s_samplingInterval;
+
 private:
-  LockFreeStack <CounterBase> m_list;
+  AtomicPointer <CounterBase> m_head;
 };
 
+int volatile LeakCheckedBase::CounterBase::Singleton::s_samplingInterval = 0;
+
 //------------------------------------------------------------------------------
 
 LeakCheckedBase::CounterBase::CounterBase ()
+  : m_next (nullptr)
+  , m_nextStack (0)
 {
   Singleton::getInstance().push_back (this);
 }
@@ -94,6 +155,55 @@ void LeakCheckedBase::CounterBase::detectLeaks ()
   }
 }
 
+// Called when the count may have passed the peak.
+//
+void LeakCheckedBase::CounterBase::raisePeak (int count)
+{
+  for (;;)
+  {
+    int const peak = m_peak.get ();
+
+    if (count <= peak)
+      break;
+
+    if (m_peak.compareAndSetBool (count, peak))
+    {
+      int const interval = Singleton::s_samplingInterval;
+
+      if (interval > 0 && (count % interval) == 0)
+      {
+        String const stack (SystemStats::getStackBacktrace ());
+
+        SpinLock::ScopedLockType lock (m_stacksLock);
+
+        m_stacks [m_nextStack] = stack;
+        m_nextStack = (m_nextStack + 1) % numberOfStacks;
+      }
+
+      break;
+    }
+  }
+}
+
+void LeakCheckedBase::CounterBase::getStatistics (Statistics& statistics)
+{
+  statistics.className = getClassName ();
+  statistics.count = m_count.get ();
+  statistics.peak = m_peak.get ();
+  statistics.bytes = int64 (statistics.count) * getObjectSize ();
+
+  SpinLock::ScopedLockType lock (m_stacksLock);
+
+  // Most recent first.
+  for (int i = 1; i <= numberOfStacks; ++i)
+  {
+    String const& stack = m_stacks [(m_nextStack + numberOfStacks - i) % numberOfStacks];
+
+    if (stack.isNotEmpty ())
+      statistics.stacks.add (stack);
+  }
+}
+
 //------------------------------------------------------------------------------
 
 void LeakCheckedBase::detectAllLeaks ()
@@ -101,4 +211,14 @@ void LeakCheckedBase::detectAllLeaks ()
   CounterBase::detectAllLeaks ();
 }
 
+void LeakCheckedBase::getStatistics (std::vector <Statistics>& statistics)
+{
+  CounterBase::Singleton::getInstance().getStatistics (statistics);
+}
+
+void LeakCheckedBase::setSamplingInterval (int interval)
+{
+  CounterBase::Singleton::s_samplingInterval = jmax (0, interval);
+}
+
 #endif
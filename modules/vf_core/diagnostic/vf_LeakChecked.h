@@ -36,21 +36,51 @@
 #include "vf_Error.h"
 #include "vf_Throw.h"
 #include "../memory/vf_StaticObject.h"
-#include "../containers/vf_LockFreeStack.h"
 
 //
 // Derived classes are automatically leak-checked on exit
 //
+// The counters are cheap enough to leave on in release builds, where they
+// also tell how many objects of each class are alive at any time, and can
+// sample the call stacks of allocations that push a class to a new peak.
+//
 
 #if VF_USE_LEAKCHECKED
 
 class LeakCheckedBase
 {
 public:
+  /** Live object counts for one class. */
+  struct Statistics
+  {
+    char const* className;
+    int count;
+    int peak;
+    int64 bytes;
+
+    /** The most recently sampled allocation call stacks. */
+    StringArray stacks;
+  };
+
   static void detectAllLeaks ();
 
+  /** Retrieve the counts of every class that was ever instantiated.
+
+      This may be called at any time. When VF_USE_METRICS is set the same
+      counts are also reported through Metrics, with the kind "LeakChecked".
+  */
+  static void getStatistics (std::vector <Statistics>& statistics);
+
+  /** Set how often allocation call stacks are sampled.
+
+      A call stack is captured each time the live count of a class reaches
+      a new peak which is a multiple of the interval, so only classes that
+      keep growing are sampled. The default of zero turns sampling off.
+  */
+  static void setSamplingInterval (int interval);
+
 protected:
-  class CounterBase : public LockFreeStack <CounterBase>::Node
+  class CounterBase
   {
   public:
     CounterBase ();
@@ -59,7 +89,12 @@ protected:
 
     inline int increment ()
     {
-      return ++m_count;
+      int const count = ++m_count;
+
+      if (count > m_peak.get ())
+        raisePeak (count);
+
+      return count;
     }
 
     inline int decrement ()
@@ -69,17 +104,35 @@ protected:
 
     virtual char const* getClassName () const = 0;
 
+    virtual int getObjectSize () const = 0;
+
     static void detectAllLeaks ();
 
   private:
+    friend class LeakCheckedBase;
+
+    enum
+    {
+      numberOfStacks = 4
+    };
+
     void detectLeaks ();
 
+    void raisePeak (int count);
+
+    void getStatistics (Statistics& statistics);
+
     virtual void checkPureVirtual () const = 0;
 
   protected:
     class Singleton;
 
+    CounterBase* m_next;
     Atomic <int> m_count;
+    Atomic <int> m_peak;
+    SpinLock m_stacksLock;
+    int m_nextStack;
+    String m_stacks [numberOfStacks];
   };
 };
 
@@ -134,6 +187,12 @@ private:
       return getLeakCheckedName ();
     }
 
+    // Objects of derived classes may be larger.
+    int getObjectSize () const
+    {
+      return sizeof (Object);
+    }
+
     void checkPureVirtual () const { }
   };
 
@@ -141,7 +200,8 @@ private:
   /* Due to a bug in Visual Studio 10 and earlier, the string returned by
      typeid().name() will appear to leak on exit. Therefore, we should
      only call this function when there's an actual leak, or else there
-     will be spurious leak notices at exit.
+     will be spurious leak notices at exit. Asking for statistics also
+     calls it.
   */
   static const char* getLeakCheckedName ()
   {
@@ -168,6 +228,20 @@ private:
 
 class LeakCheckedBase
 {
+public:
+  struct Statistics
+  {
+    char const* className;
+    int count;
+    int peak;
+    int64 bytes;
+    StringArray stacks;
+  };
+
+  static void getStatistics (std::vector <Statistics>& statistics) { statistics.clear (); }
+
+  static void setSamplingInterval (int) { }
+
 private:
   friend class PerformedAtExit;
 
@@ -0,0 +1,323 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+class Metrics::State : Uncopyable
+{
+public:
+  void add (Source* source)
+  {
+    CriticalSection::ScopedLockType lock (m_mutex);
+
+    m_sources.push_back (*source);
+  }
+
+  void remove (Source* source)
+  {
+    CriticalSection::ScopedLockType lock (m_mutex);
+
+    m_sources.erase (m_sources.iterator_to (*source));
+  }
+
+  void getSnapshot (Snapshot& snapshot)
+  {
+    CriticalSection::ScopedLockType lock (m_mutex);
+
+    for (List <Source>::iterator iter = m_sources.begin ();
+         iter != m_sources.end (); ++iter)
+    {
+      iter->addReports (snapshot);
+    }
+  }
+
+  static State& getInstance ()
+  {
+    static State instance;
+
+    return instance;
+  }
+
+private:
+  CriticalSection m_mutex;
+  List <Source> m_sources;
+};
+
+//------------------------------------------------------------------------------
+
+int volatile Metrics::s_enabled = 0;
+
+void Metrics::enable (bool shouldBeEnabled)
+{
+  s_enabled = shouldBeEnabled ? 1 : 0;
+}
+
+void Metrics::add (Source* source)
+{
+  State::getInstance ().add (source);
+}
+
+void Metrics::remove (Source* source)
+{
+  State::getInstance ().remove (source);
+}
+
+void Metrics::getSnapshot (Snapshot& snapshot)
+{
+  State::getInstance ().getSnapshot (snapshot);
+}
+
+//------------------------------------------------------------------------------
+
+Metrics::Histogram::Summary::Summary ()
+  : count (0)
+  , sum (0)
+  , max (0)
+  , p50 (0)
+  , p99 (0)
+  , p999 (0)
+{
+}
+
+Metrics::Histogram::Histogram ()
+{
+}
+
+void Metrics::Histogram::record (int64 value)
+{
+  value = jmax (int64 (0), value);
+
+  ++m_buckets [getBucket (value)];
+  ++m_count;
+  m_sum += value;
+
+  for (;;)
+  {
+    int64 const max = m_max.get ();
+
+    if (value <= max || m_max.compareAndSetBool (value, max))
+      break;
+  }
+}
+
+Metrics::Histogram::Summary Metrics::Histogram::getSummary () const
+{
+  Summary summary;
+
+  int64 buckets [numberOfBuckets];
+
+  for (int i = 0; i < numberOfBuckets; ++i)
+  {
+    buckets [i] = m_buckets [i].get ();
+    summary.count += buckets [i];
+  }
+
+  summary.sum = m_sum.get ();
+  summary.max = m_max.get ();
+
+  if (summary.count > 0)
+  {
+    int64* const percentiles [] = { &summary.p50, &summary.p99, &summary.p999 };
+    double const fractions [] = { 0.5, 0.99, 0.999 };
+
+    for (int p = 0; p < 3; ++p)
+    {
+      int64 const target = jmax (int64 (1), int64 (std::ceil (summary.count * fractions [p])));
+      int64 total = 0;
+
+      for (int i = 0; i < numberOfBuckets; ++i)
+      {
+        total += buckets [i];
+
+        if (total >= target)
+        {
+          *percentiles [p] = jmin (getUpperBound (i), summary.max);
+          break;
+        }
+      }
+    }
+  }
+
+  return summary;
+}
+
+// Bucket 0 holds zero, bucket n holds [2^(n-1), 2^n).
+//
+int Metrics::Histogram::getBucket (int64 value)
+{
+  int bucket = 0;
+
+  while (value > 0 && bucket < numberOfBuckets - 1)
+  {
+    value >>= 1;
+    ++bucket;
+  }
+
+  return bucket;
+}
+
+int64 Metrics::Histogram::getUpperBound (int bucket)
+{
+  return (int64 (1) << bucket) - 1;
+}
+
+//------------------------------------------------------------------------------
+
+Metrics::Report::Report (char const* kind, String const& name)
+  : m_kind (kind)
+  , m_name (name)
+{
+}
+
+char const* Metrics::Report::getKind () const
+{
+  return m_kind;
+}
+
+String const& Metrics::Report::getName () const
+{
+  return m_name;
+}
+
+void Metrics::Report::addValue (char const* key, int64 value)
+{
+  Item <int64> item = { key, value };
+  m_values.push_back (item);
+}
+
+void Metrics::Report::addText (char const* key, String const& text)
+{
+  Item <String> item = { key, text };
+  m_texts.push_back (item);
+}
+
+void Metrics::Report::addHistogram (char const* key, Histogram const& histogram)
+{
+  Item <Histogram::Summary> item = { key, histogram.getSummary () };
+  m_histograms.push_back (item);
+}
+
+int64 Metrics::Report::getValue (char const* key) const
+{
+  for (std::size_t i = 0; i < m_values.size (); ++i)
+  {
+    if (strcmp (m_values [i].key, key) == 0)
+      return m_values [i].value;
+  }
+
+  return 0;
+}
+
+String Metrics::Report::getText (char const* key) const
+{
+  for (std::size_t i = 0; i < m_texts.size (); ++i)
+  {
+    if (strcmp (m_texts [i].key, key) == 0)
+      return m_texts [i].value;
+  }
+
+  return String::empty;
+}
+
+Metrics::Histogram::Summary const* Metrics::Report::getHistogram (char const* key) const
+{
+  for (std::size_t i = 0; i < m_histograms.size (); ++i)
+  {
+    if (strcmp (m_histograms [i].key, key) == 0)
+      return &m_histograms [i].value;
+  }
+
+  return nullptr;
+}
+
+void Metrics::Report::writeJson (OutputStream& stream) const
+{
+  stream << "{\"kind\":\"" << m_kind << "\",\"name\":"
+         << JSON::toString (var (m_name));
+
+  for (std::size_t i = 0; i < m_values.size (); ++i)
+    stream << ",\"" << m_values [i].key << "\":" << String (m_values [i].value);
+
+  for (std::size_t i = 0; i < m_texts.size (); ++i)
+    stream << ",\"" << m_texts [i].key << "\":" << JSON::toString (var (m_texts [i].value));
+
+  for (std::size_t i = 0; i < m_histograms.size (); ++i)
+  {
+    Histogram::Summary const& h = m_histograms [i].value;
+
+    stream << ",\"" << m_histograms [i].key << "\":{"
+           << "\"count\":" << String (h.count)
+           << ",\"sum\":" << String (h.sum)
+           << ",\"max\":" << String (h.max)
+           << ",\"p50\":" << String (h.p50)
+           << ",\"p99\":" << String (h.p99)
+           << ",\"p999\":" << String (h.p999)
+           << "}";
+  }
+
+  stream << "}";
+}
+
+//------------------------------------------------------------------------------
+
+Metrics::Snapshot::Snapshot ()
+{
+}
+
+Metrics::Report& Metrics::Snapshot::add (char const* kind, String const& name)
+{
+  return *m_reports.add (new Report (kind, name));
+}
+
+int Metrics::Snapshot::size () const
+{
+  return m_reports.size ();
+}
+
+Metrics::Report const& Metrics::Snapshot::operator[] (int index) const
+{
+  return *m_reports [index];
+}
+
+void Metrics::Snapshot::writeJson (OutputStream& stream) const
+{
+  stream << "[\n";
+
+  for (int i = 0; i < m_reports.size (); ++i)
+  {
+    if (i > 0)
+      stream << ",\n";
+
+    m_reports [i]->writeJson (stream);
+  }
+
+  stream << "\n]\n";
+  stream.flush ();
+}
@@ -0,0 +1,280 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_METRICS_VFHEADER
+#define VF_METRICS_VFHEADER
+
+#include "../containers/vf_List.h"
+
+/*============================================================================*/
+/**
+  Run time measurements reported by live objects.
+
+  Objects which collect measurements derive from Metrics::Source and add
+  themselves to the registry for their lifetime. A Snapshot asks every
+  registered source for its current values, producing one Report per
+  source, which can be examined directly or written out as JSON:
+
+  @code
+
+  Metrics::enable (true);
+
+  // ...
+
+  Metrics::Snapshot snapshot;
+  Metrics::getSnapshot (snapshot);
+
+  for (int i = 0; i < snapshot.size (); ++i)
+  {
+    Metrics::Report const& report = snapshot [i];
+
+    if (report.getValue ("depth") > 100)
+      DBG (report.getName () << " is backing up");
+  }
+
+  @endcode
+
+  Instrumentation is compiled in when VF_USE_METRICS is set, and collects
+  nothing until enable() is called. While it is disabled, instrumented code
+  pays for a single load and branch.
+
+  @ingroup vf_core
+*/
+class Metrics
+{
+public:
+  class Histogram;
+  class Report;
+  class Snapshot;
+  class Source;
+
+  /** Start or stop collecting measurements.
+  */
+  static void enable (bool shouldBeEnabled);
+
+  /** Determine if measurements are being collected.
+  */
+  static inline bool isEnabled ()
+  {
+    return s_enabled != 0;
+  }
+
+  /** Register a source.
+
+      Call this once the source is ready to report, usually at the end of
+      its constructor.
+  */
+  static void add (Source* source);
+
+  /** Unregister a source.
+
+      This waits for a snapshot in progress, so the source may be destroyed
+      once it returns. Call it at the beginning of the destructor.
+  */
+  static void remove (Source* source);
+
+  /** Collect a report from every registered source.
+  */
+  static void getSnapshot (Snapshot& snapshot);
+
+private:
+  class State;
+
+  // Deliberately not atomic, see Trace.
+  static int volatile s_enabled;
+};
+
+//------------------------------------------------------------------------------
+
+/** A distribution of non-negative values.
+
+    Values are counted in buckets whose bounds are powers of two, so
+    percentiles are accurate to within a factor of two. Recording is
+    lock-free and may be done from any number of threads.
+
+    @ingroup vf_core
+*/
+class Metrics::Histogram : Uncopyable
+{
+public:
+  enum
+  {
+    numberOfBuckets = 48
+  };
+
+  /** Values calculated from a Histogram.
+  */
+  struct Summary
+  {
+    Summary ();
+
+    int64 count;
+    int64 sum;
+    int64 max;
+
+    /** Upper bounds for the percentiles. */
+    int64 p50;
+    int64 p99;
+    int64 p999;
+  };
+
+  Histogram ();
+
+  /** Count a value. Negative values are counted as zero.
+  */
+  void record (int64 value);
+
+  /** Calculate the summary.
+
+      This may be called while other threads are recording.
+  */
+  Summary getSummary () const;
+
+private:
+  static int getBucket (int64 value);
+  static int64 getUpperBound (int bucket);
+
+  Atomic <int64> m_buckets [numberOfBuckets];
+  Atomic <int64> m_count;
+  Atomic <int64> m_sum;
+  Atomic <int64> m_max;
+};
+
+//------------------------------------------------------------------------------
+
+/** The measurements of one Source at the time of a Snapshot.
+
+    Keys must be string literals.
+
+    @ingroup vf_core
+*/
+class Metrics::Report : Uncopyable
+{
+public:
+  Report (char const* kind, String const& name);
+
+  /** The type of object, for example "CallQueue". */
+  char const* getKind () const;
+
+  /** The name given to the object, which need not be unique. */
+  String const& getName () const;
+
+  /** Add a measurement. */
+  /** @{ */
+  void addValue (char const* key, int64 value);
+  void addText (char const* key, String const& text);
+  void addHistogram (char const* key, Histogram const& histogram);
+  /** @} */
+
+  /** Retrieve a measurement.
+
+      @return The value, or zero if there is no value with the key.
+  */
+  int64 getValue (char const* key) const;
+
+  /** Retrieve a text measurement.
+
+      @return The text, or an empty string if there is none with the key.
+  */
+  String getText (char const* key) const;
+
+  /** Retrieve a histogram summary.
+
+      @return The summary, or nullptr if there is none with the key.
+  */
+  Histogram::Summary const* getHistogram (char const* key) const;
+
+  /** Write the report as a JSON object.
+  */
+  void writeJson (OutputStream& stream) const;
+
+private:
+  template <class Value>
+  struct Item
+  {
+    char const* key;
+    Value value;
+  };
+
+  char const* const m_kind;
+  String const m_name;
+  std::vector <Item <int64> > m_values;
+  std::vector <Item <String> > m_texts;
+  std::vector <Item <Histogram::Summary> > m_histograms;
+};
+
+//------------------------------------------------------------------------------
+
+/** The reports of all sources at one point in time.
+
+    @ingroup vf_core
+*/
+class Metrics::Snapshot : Uncopyable
+{
+public:
+  Snapshot ();
+
+  /** Add a report. This is called by sources. */
+  Report& add (char const* kind, String const& name);
+
+  int size () const;
+
+  Report const& operator[] (int index) const;
+
+  /** Write every report as a JSON array.
+  */
+  void writeJson (OutputStream& stream) const;
+
+private:
+  OwnedArray <Report> m_reports;
+};
+
+//------------------------------------------------------------------------------
+
+/** An object which reports measurements.
+
+    @ingroup vf_core
+*/
+class Metrics::Source : public List <Source>::Node
+{
+public:
+  virtual ~Source () { }
+
+  /** Add the current measurements to a snapshot.
+
+      This is called from the thread taking the snapshot, and must be safe
+      to call while the measurements are being updated.
+  */
+  virtual void addReports (Snapshot& snapshot) = 0;
+};
+
+#endif
@@ -0,0 +1,286 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+struct Trace::Event
+{
+  int64 ticks;
+  char const* name;
+  char phase;
+};
+
+//------------------------------------------------------------------------------
+
+// The events of one thread. Only the owning thread writes. Readers
+// use the count to find out which events are complete and which
+// might have been overwritten while they were being read.
+//
+class Trace::ThreadBuffer : Uncopyable
+{
+public:
+  ThreadBuffer (int threadId, String const& threadName)
+    : m_next (nullptr)
+    , m_threadId (threadId)
+    , m_threadName (threadName)
+    , m_written (0)
+    , m_events (eventsPerThread)
+  {
+  }
+
+  void record (char const* name, char phase)
+  {
+    Event& event = m_events [int (m_written & (eventsPerThread - 1))];
+
+    event.ticks = Time::getHighResolutionTicks ();
+    event.name = name;
+    event.phase = phase;
+
+    ++m_written;
+
+    m_count.set (m_written);
+  }
+
+  // Copies the events which are still intact.
+  //
+  void copyEvents (std::vector <Event>& events) const
+  {
+    int64 const end = m_count.get ();
+    int64 const begin = jmax (int64 (0), end - eventsPerThread);
+
+    events.clear ();
+    events.reserve (int (end - begin));
+
+    for (int64 i = begin; i < end; ++i)
+      events.push_back (m_events [int (i & (eventsPerThread - 1))]);
+
+    // Drop what the owner overwrote while we were copying, and the slot
+    // it may be part way through writing, which is not yet counted.
+    int const overwritten = int (jmin (int64 (eventsPerThread),
+      m_count.get () - eventsPerThread - begin + 1));
+
+    if (overwritten > 0)
+      events.erase (events.begin (), events.begin () + jmin (overwritten, int (events.size ())));
+  }
+
+  ThreadBuffer* m_next;
+  int const m_threadId;
+  String const m_threadName;
+
+private:
+  int64 m_written;
+  Atomic <int64> m_count;
+  HeapBlock <Event> m_events;
+};
+
+//------------------------------------------------------------------------------
+
+class Trace::State : Uncopyable
+{
+public:
+  State ()
+    : m_startTicks (Time::getHighResolutionTicks ())
+    , m_nextThreadId (0)
+  {
+  }
+
+  ~State ()
+  {
+    ThreadBuffer* buffer = m_buffers.get ();
+
+    while (buffer != nullptr)
+    {
+      ThreadBuffer* const next = buffer->m_next;
+      delete buffer;
+      buffer = next;
+    }
+  }
+
+  ThreadBuffer& getThreadBuffer ()
+  {
+    ThreadBuffer*& buffer = m_threadBuffer.get ();
+
+    if (buffer == nullptr)
+      buffer = createThreadBuffer ();
+
+    return *buffer;
+  }
+
+  char const* intern (String const& name)
+  {
+    CriticalSection::ScopedLockType lock (m_mutex);
+
+    for (int i = 0; i < m_names.size (); ++i)
+    {
+      if (name == static_cast <char const*> (m_names [i]->getData ()))
+        return static_cast <char const*> (m_names [i]->getData ());
+    }
+
+    char const* const utf8 = name.toUTF8 ();
+
+    MemoryBlock* const block = new MemoryBlock (utf8, strlen (utf8) + 1);
+
+    m_names.add (block);
+
+    return static_cast <char const*> (block->getData ());
+  }
+
+  void writeChromeTrace (OutputStream& stream)
+  {
+    stream << "{\"traceEvents\":[\n";
+
+    bool first = true;
+
+    std::vector <Event> events;
+
+    for (ThreadBuffer* buffer = m_buffers.get ();
+         buffer != nullptr;
+         buffer = buffer->m_next)
+    {
+      String const tid (buffer->m_threadId);
+
+      writeSeparator (stream, first);
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << escape (buffer->m_threadName) << "\"}}";
+
+      buffer->copyEvents (events);
+
+      // An end whose begin was overwritten can't be shown.
+      int depth = 0;
+
+      for (std::size_t i = 0; i < events.size (); ++i)
+      {
+        Event const& event = events [i];
+
+        if (event.phase == 'B')
+          ++depth;
+        else if (depth > 0)
+          --depth;
+        else
+          continue;
+
+        double const micros = Time::highResolutionTicksToSeconds (
+          event.ticks - m_startTicks) * 1000000;
+
+        writeSeparator (stream, first);
+        stream << "{\"name\":\"" << escape (event.name) << "\",\"ph\":\""
+               << String::charToString (event.phase) << "\",\"ts\":" << String (micros)
+               << ",\"pid\":1,\"tid\":" << tid << "}";
+      }
+    }
+
+    stream << "\n]}\n";
+    stream.flush ();
+  }
+
+  static State& getInstance ()
+  {
+    static State instance;
+
+    return instance;
+  }
+
+private:
+  // New buffers are pushed on to the front of a list that is never
+  // shortened, so writers of the trace can walk it without a lock.
+  //
+  ThreadBuffer* createThreadBuffer ()
+  {
+    int const threadId = ++m_nextThreadId;
+
+    Thread* const thread = Thread::getCurrentThread ();
+
+    String const threadName = (thread != nullptr) ?
+      thread->getThreadName () : (String ("Thread ") + String (threadId));
+
+    ThreadBuffer* const buffer = new ThreadBuffer (threadId, threadName);
+
+    do
+    {
+      buffer->m_next = m_buffers.get ();
+    }
+    while (!m_buffers.compareAndSet (buffer, buffer->m_next));
+
+    return buffer;
+  }
+
+  static void writeSeparator (OutputStream& stream, bool& first)
+  {
+    if (!first)
+      stream << ",\n";
+
+    first = false;
+  }
+
+  static String escape (String const& s)
+  {
+    return s.replace ("\\", "\\\\").replace ("\"", "\\\"");
+  }
+
+private:
+  int64 const m_startTicks;
+  Atomic <int> m_nextThreadId;
+  AtomicPointer <ThreadBuffer> m_buffers;
+  ThreadLocalValue <ThreadBuffer*> m_threadBuffer;
+  CriticalSection m_mutex;
+  OwnedArray <MemoryBlock> m_names;
+};
+
+//------------------------------------------------------------------------------
+
+int volatile Trace::s_enabled = 0;
+
+void Trace::enable (bool shouldBeEnabled)
+{
+  // Creates the state before any thread records into it.
+  State::getInstance ();
+
+  s_enabled = shouldBeEnabled ? 1 : 0;
+}
+
+char const* Trace::intern (String const& name)
+{
+  return State::getInstance ().intern (name);
+}
+
+void Trace::writeChromeTrace (OutputStream& stream)
+{
+  State::getInstance ().writeChromeTrace (stream);
+}
+
+void Trace::begin (char const* name)
+{
+  State::getInstance ().getThreadBuffer ().record (name, 'B');
+}
+
+void Trace::end (char const* name)
+{
+  State::getInstance ().getThreadBuffer ().record (name, 'E');
+}
@@ -0,0 +1,168 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_TRACE_VFHEADER
+#define VF_TRACE_VFHEADER
+
+/*============================================================================*/
+/**
+  Low overhead tracing of hot paths.
+
+  Each thread records timestamped begin and end events into its own fixed
+  size ring buffer, without taking locks. When a buffer is full the oldest
+  events are overwritten, so the buffers always hold the most recent
+  activity. The events of all threads can be written out at any time in the
+  Chrome trace format, which is loaded by chrome://tracing or Perfetto.
+
+  Scopes are marked with VF_TRACE_SCOPE, which compiles to nothing unless
+  VF_USE_TRACING is set. When it is set, recording still does not start
+  until enable() is called, and a disabled scope costs a single load and
+  branch:
+
+  @code
+
+  void AudioEngine::process ()
+  {
+    VF_TRACE_SCOPE ("AudioEngine::process");
+
+    // ...
+  }
+
+  void onGlitch ()
+  {
+    FileOutputStream stream (File ("glitch.json"));
+
+    Trace::writeChromeTrace (stream);
+  }
+
+  @endcode
+
+  CallQueue, ThreadGroup and ParallelFor are instrumented. Each functor
+  called by a CallQueue is recorded with the name of its type, nested inside
+  a scope named after the queue.
+
+  @note Names must point to storage that lives until the trace is written,
+        such as string literals. Use intern() for names built at run time.
+
+  @ingroup vf_core
+*/
+class Trace
+{
+public:
+  enum
+  {
+    /** The number of events kept for each thread. Must be a power of two. */
+    eventsPerThread = 8192
+  };
+
+  /** Start or stop recording.
+  */
+  static void enable (bool shouldBeEnabled);
+
+  /** Determine if events are being recorded.
+  */
+  static inline bool isEnabled ()
+  {
+    return s_enabled != 0;
+  }
+
+  /** Obtain a permanent copy of a name.
+
+      Equal names return the same pointer. This takes a lock, so it
+      should be called once, for example in a constructor.
+  */
+  static char const* intern (String const& name);
+
+  /** Write every recorded event in Chrome trace JSON format.
+
+      This may be called while other threads are recording. Events which
+      are overwritten while they are being written out are left out.
+  */
+  static void writeChromeTrace (OutputStream& stream);
+
+  /** Record the beginning or end of a scope on the calling thread.
+  */
+  /** @{ */
+  static void begin (char const* name);
+  static void end (char const* name);
+  /** @} */
+
+  /** Records the lifetime of an object as a scope.
+
+      @see VF_TRACE_SCOPE
+  */
+  class Scope : Uncopyable
+  {
+  public:
+    explicit inline Scope (char const* name) : m_name (name)
+    {
+      if (m_name != nullptr)
+        begin (m_name);
+    }
+
+    inline ~Scope ()
+    {
+      if (m_name != nullptr)
+        end (m_name);
+    }
+
+  private:
+    char const* const m_name;
+  };
+
+private:
+  struct Event;
+  class ThreadBuffer;
+  class State;
+
+  // Deliberately not atomic, a plain load keeps disabled scopes cheap.
+  // Threads notice a change soon enough.
+  static int volatile s_enabled;
+};
+
+#define VF_TRACE_JOIN2_(a, b) a##b
+#define VF_TRACE_JOIN_(a, b) VF_TRACE_JOIN2_(a, b)
+
+/** Trace the enclosing scope.
+
+    The name expression is only evaluated while tracing is enabled.
+
+    @ingroup vf_core
+*/
+#if VF_USE_TRACING
+#define VF_TRACE_SCOPE(name) vf::Trace::Scope VF_TRACE_JOIN_(vfTraceScope_, __LINE__) \
+  (vf::Trace::isEnabled () ? (name) : nullptr)
+#else
+#define VF_TRACE_SCOPE(name)
+#endif
+
+#endif
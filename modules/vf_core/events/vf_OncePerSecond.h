@@ -33,7 +33,7 @@
 #ifndef VF_ONCEPERSECOND_VFHEADER
 #define VF_ONCEPERSECOND_VFHEADER
 
-#include "../containers/vf_List.h"
+#include "vf_TimerWheel.h"
 
 /*============================================================================*/
 /** 
@@ -43,6 +43,9 @@
     call startOncePerSecond() to begin receiving the notifications. No clean-up
     or other actions are required.
 
+    Notifications are made on the thread of the TimerWheel. Each object is
+    scheduled independently, one second apart from when it was started.
+
     @ingroup vf_core
 */
 class OncePerSecond : Uncopyable
@@ -62,13 +65,15 @@ protected:
   virtual void doOncePerSecond () = 0;
 
 private:
-  class TimerSingleton;
-  typedef ReferenceCountedObjectPtr <TimerSingleton> TimerPtr;
-
-  struct Elem : List <Elem>::Node
+  class Elem : public TimerWheel::Timer
   {
-    TimerPtr instance;
-    OncePerSecond* object;
+  public:
+    explicit Elem (OncePerSecond& object);
+
+  private:
+    void onTimerExpired ();
+
+    OncePerSecond& m_object;
   };
 
   Elem m_elem;
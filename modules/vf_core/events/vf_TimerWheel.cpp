@@ -0,0 +1,397 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+/*
+Implementation notes
+
+- Time is measured in ticks of one millisecond, counted from when the wheel
+  was created. The 32-bit millisecond counter is extended to 64 bits so it
+  never wraps.
+
+- m_now is the next tick to be processed. A timer whose expiration is less
+  than 256 ticks past m_now goes into level 0, less than 65536 ticks into
+  level 1, and so on. Each time level 0 completes a revolution, the next
+  slot of level 1 is cascaded: its timers are re-filed into lower levels.
+  Higher levels cascade the same way.
+
+- Expired timers are moved to m_due and called one at a time with the lock
+  released, so a callback may start or cancel any timer including itself.
+*/
+
+TimerWheel::TimerWheel ()
+  : RefCountedSingleton <TimerWheel> (SingletonLifetime::persistAfterCreation)
+  , m_thread ("TimerWheel")
+  , m_shouldStop (false)
+  , m_lastCounter (Time::getMillisecondCounter ())
+  , m_clock (0)
+  , m_now (0)
+  , m_wakeTicks (0)
+  , m_count (0)
+  , m_firing (nullptr)
+{
+  m_thread.start (vf::bind (&TimerWheel::run, this));
+}
+
+TimerWheel::~TimerWheel ()
+{
+  {
+    CriticalSection::ScopedLockType lock (m_mutex);
+
+    m_shouldStop = true;
+  }
+
+  m_thread.interrupt ();
+  m_thread.join ();
+
+  // If this goes off it means a timer is still running at exit.
+  jassert (m_count == 0);
+}
+
+TimerWheel* TimerWheel::createInstance ()
+{
+  return new TimerWheel;
+}
+
+// Caller must hold the lock.
+//
+int64 TimerWheel::getTicks ()
+{
+  uint32 const counter = Time::getMillisecondCounter ();
+
+  // Unsigned subtraction handles the wrap-around of the counter.
+  m_clock += uint32 (counter - m_lastCounter);
+  m_lastCounter = counter;
+
+  return m_clock;
+}
+
+// File the timer into the slot for its expiration time.
+// Caller must hold the lock.
+//
+void TimerWheel::insert (Timer& timer)
+{
+  int64 expires = jmax (timer.m_expires, m_now);
+  int64 const delta = expires - m_now;
+
+  int level;
+
+  if (delta < (int64 (1) << bitsPerLevel))
+  {
+    level = 0;
+  }
+  else if (delta < (int64 (1) << (2 * bitsPerLevel)))
+  {
+    level = 1;
+  }
+  else if (delta < (int64 (1) << (3 * bitsPerLevel)))
+  {
+    level = 2;
+  }
+  else
+  {
+    level = 3;
+
+    // Park timers that are beyond the range of the wheel in the
+    // furthest slot. They get re-filed when that slot cascades.
+    int64 const limit = (int64 (1) << (4 * bitsPerLevel)) - 1;
+    if (delta > limit)
+      expires = m_now + limit;
+  }
+
+  int const index = int (expires >> (level * bitsPerLevel)) & slotMask;
+
+  Slot& slot = m_slots [level][index];
+  slot.push_back (timer);
+  timer.m_slot = &slot;
+}
+
+// Caller must hold the lock.
+//
+void TimerWheel::unlink (Timer& timer)
+{
+  if (timer.m_slot != nullptr)
+  {
+    timer.m_slot->erase (timer.m_slot->iterator_to (timer));
+    timer.m_slot = nullptr;
+    --m_count;
+  }
+}
+
+void TimerWheel::start (Timer& timer, int64 expires, int periodMilliSeconds)
+{
+  jassert (periodMilliSeconds >= 0);
+
+  CriticalSection::ScopedLockType lock (m_mutex);
+
+  unlink (timer);
+
+  // An empty wheel is not advanced while it idles. Catch up first, so
+  // that the wheel thread does not step through the idle ticks later.
+  if (m_count == 0)
+    advance (getTicks ());
+
+  timer.m_expires = expires;
+  timer.m_period = periodMilliSeconds;
+
+  insert (timer);
+  ++m_count;
+
+  // Wake the thread if this timer expires before it would otherwise wake up.
+  if (expires < m_wakeTicks)
+  {
+    m_wakeTicks = expires;
+    m_thread.interrupt ();
+  }
+}
+
+void TimerWheel::cancel (Timer& timer)
+{
+  CriticalSection::ScopedLockType lock (m_mutex);
+
+  unlink (timer);
+
+  // Prevents a repeating timer from being re-armed after its callback.
+  timer.m_period = 0;
+
+  if (m_firing == &timer)
+  {
+    if (m_thread.isTheCurrentThread ())
+    {
+      // Called from the callback, which may be about to destroy the timer.
+      m_firing = nullptr;
+    }
+    else
+    {
+      // Wait for the callback in progress on the wheel thread to finish.
+      while (m_firing == &timer)
+      {
+        CriticalSection::ScopedUnlockType unlock (m_mutex);
+
+        Thread::yield ();
+      }
+    }
+  }
+}
+
+bool TimerWheel::isPending (Timer const& timer)
+{
+  CriticalSection::ScopedLockType lock (m_mutex);
+
+  return timer.m_slot != nullptr;
+}
+
+// Process all ticks up to and including the specified tick.
+// Caller must hold the lock.
+//
+void TimerWheel::advance (int64 ticks)
+{
+  // With no timers every slot is empty, so after a long idle
+  // period there is nothing to step through.
+  if (m_count == 0 && m_now <= ticks)
+    m_now = ticks + 1;
+
+  while (m_now <= ticks)
+  {
+    int const index = int (m_now) & slotMask;
+
+    if (index == 0)
+    {
+      for (int level = 1; level < numberOfLevels; ++level)
+      {
+        cascade (level);
+
+        // Higher levels only cascade when this one wraps.
+        if (((m_now >> (level * bitsPerLevel)) & slotMask) != 0)
+          break;
+      }
+    }
+
+    Slot& slot = m_slots [0][index];
+
+    while (!slot.empty ())
+    {
+      Timer& timer = slot.front ();
+      slot.pop_front ();
+      timer.m_slot = &m_due;
+      m_due.push_back (timer);
+    }
+
+    ++m_now;
+  }
+}
+
+// Re-file every timer in the current slot of a level.
+// Caller must hold the lock.
+//
+void TimerWheel::cascade (int level)
+{
+  int const index = int (m_now >> (level * bitsPerLevel)) & slotMask;
+
+  Slot timers;
+  timers.append (m_slots [level][index]);
+
+  while (!timers.empty ())
+  {
+    Timer& timer = timers.front ();
+    timers.pop_front ();
+    insert (timer);
+  }
+}
+
+// Returns the number of ticks past m_now of the next occupied slot in level 0,
+// or of the next cascade if level 0 is empty for the rest of its revolution.
+// Caller must hold the lock.
+//
+int TimerWheel::getTicksUntilNextSlot () const
+{
+  int const index = int (m_now) & slotMask;
+  int const remaining = slotsPerLevel - index;
+
+  for (int i = 0; i < remaining; ++i)
+  {
+    if (!m_slots [0][index + i].empty ())
+      return i;
+  }
+
+  return remaining;
+}
+
+void TimerWheel::run ()
+{
+  CriticalSection::ScopedLockType lock (m_mutex);
+
+  while (!m_shouldStop)
+  {
+    int64 const ticks = getTicks ();
+
+    advance (ticks);
+
+    while (!m_due.empty ())
+    {
+      Timer& timer = m_due.front ();
+      m_due.pop_front ();
+      timer.m_slot = nullptr;
+      --m_count;
+
+      m_firing = &timer;
+
+      {
+        CriticalSection::ScopedUnlockType unlock (m_mutex);
+
+        timer.onTimerExpired ();
+      }
+
+      // If the timer was cancelled from its own callback it may no
+      // longer exist, so it must not be touched.
+      bool const cancelled = (m_firing == nullptr);
+
+      m_firing = nullptr;
+
+      // Re-arm a repeating timer unless the callback restarted it. Periods
+      // are measured from the previous expiration to avoid drift, but a timer
+      // that fell behind is not allowed to fire repeatedly to catch up.
+      if (!cancelled && timer.m_slot == nullptr && timer.m_period > 0)
+      {
+        timer.m_expires = jmax (timer.m_expires + timer.m_period, ticks + 1);
+        insert (timer);
+        ++m_count;
+      }
+    }
+
+    int milliSeconds;
+
+    if (m_count > 0)
+    {
+      m_wakeTicks = m_now + getTicksUntilNextSlot ();
+      milliSeconds = int (m_wakeTicks - ticks);
+    }
+    else
+    {
+      milliSeconds = -1;
+      m_wakeTicks = std::numeric_limits <int64>::max ();
+    }
+
+    {
+      CriticalSection::ScopedUnlockType unlock (m_mutex);
+
+      m_thread.wait (milliSeconds);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+TimerWheel::Timer::Timer ()
+  : m_wheel (TimerWheel::getInstance ())
+  , m_slot (nullptr)
+  , m_expires (0)
+  , m_period (0)
+{
+}
+
+TimerWheel::Timer::~Timer ()
+{
+  cancelTimer ();
+}
+
+void TimerWheel::Timer::startTimer (int delayMilliSeconds, int periodMilliSeconds)
+{
+  jassert (delayMilliSeconds >= 0);
+
+  int64 expires;
+
+  {
+    CriticalSection::ScopedLockType lock (m_wheel->m_mutex);
+
+    expires = m_wheel->getTicks () + delayMilliSeconds;
+  }
+
+  m_wheel->start (*this, expires, periodMilliSeconds);
+}
+
+void TimerWheel::Timer::startTimerAt (Time deadline, int periodMilliSeconds)
+{
+  int64 const delay = deadline.toMilliseconds () - Time::currentTimeMillis ();
+
+  startTimer (int (jlimit (int64 (0), int64 (std::numeric_limits <int>::max ()), delay)),
+              periodMilliSeconds);
+}
+
+void TimerWheel::Timer::cancelTimer ()
+{
+  m_wheel->cancel (*this);
+}
+
+bool TimerWheel::Timer::isTimerRunning () const
+{
+  return m_wheel->isPending (*this);
+}
@@ -0,0 +1,204 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_TIMERWHEEL_VFHEADER
+#define VF_TIMERWHEEL_VFHEADER
+
+#include "../containers/vf_List.h"
+#include "../memory/vf_AtomicCounter.h"
+#include "../memory/vf_AtomicState.h"
+#include "../memory/vf_RefCountedSingleton.h"
+#include "../threads/vf_InterruptibleThread.h"
+
+/*============================================================================*/
+/**
+  A hierarchical timing wheel.
+
+  This provides one-shot and repeating timers with millisecond resolution and
+  arbitrary periods, all serviced by a single InterruptibleThread. Timers are
+  kept in four levels of 256 slots each, so that starting, cancelling and
+  expiring a timer are all constant time operations regardless of how many
+  timers are active. Timers further out than the range of the wheel are
+  parked in the outermost level and re-filed as the wheel turns.
+
+  To use a timer, derive from TimerWheel::Timer and override onTimerExpired().
+  The callback is made on the thread belonging to the wheel, so it should
+  execute quickly. To have the callback delivered to a particular thread
+  instead, use CallQueueTimer from the @ref vf_concurrent module.
+
+  @code
+
+  struct Blinker : TimerWheel::Timer
+  {
+    Blinker ()
+    {
+      startTimer (500, 500); // first in 500ms, then every 500ms
+    }
+
+    ~Blinker ()
+    {
+      cancelTimer ();
+    }
+
+    void onTimerExpired ()
+    {
+      // (toggle something)
+    }
+  };
+
+  @endcode
+
+  @see OncePerSecond
+
+  @ingroup vf_core
+*/
+class TimerWheel : public RefCountedSingleton <TimerWheel>
+{
+public:
+  class Timer;
+
+  static TimerWheel* createInstance ();
+
+private:
+  typedef List <Timer> Slot;
+
+  enum
+  {
+    bitsPerLevel = 8,
+    slotsPerLevel = 1 << bitsPerLevel,
+    slotMask = slotsPerLevel - 1,
+    numberOfLevels = 4
+  };
+
+  TimerWheel ();
+  ~TimerWheel ();
+
+  int64 getTicks ();
+  void insert (Timer& timer);
+  void unlink (Timer& timer);
+  void start (Timer& timer, int64 expires, int periodMilliSeconds);
+  void cancel (Timer& timer);
+  bool isPending (Timer const& timer);
+  void advance (int64 ticks);
+  void cascade (int level);
+  int getTicksUntilNextSlot () const;
+  void run ();
+
+private:
+  CriticalSection m_mutex;
+  InterruptibleThread m_thread;
+  bool m_shouldStop;
+  uint32 m_lastCounter;
+  int64 m_clock;
+  int64 m_now;
+  int64 m_wakeTicks;
+  int m_count;
+  Timer* m_firing;
+  Slot m_due;
+  Slot m_slots [numberOfLevels][slotsPerLevel];
+};
+
+//------------------------------------------------------------------------------
+
+/**
+  A timer serviced by the TimerWheel.
+
+  Derived classes must call cancelTimer() in their destructor if there is any
+  chance that the timer is still running, otherwise the callback could be
+  made on a partially destroyed object.
+
+  @ingroup vf_core
+*/
+class TimerWheel::Timer : public List <Timer>::Node
+{
+public:
+  Timer ();
+
+  /** Destroy the timer.
+
+      The timer is cancelled if it is still running.
+  */
+  virtual ~Timer ();
+
+  /** Start the timer.
+
+      If the timer is already running it is restarted with the new values.
+
+      @param delayMilliSeconds  The time until the first expiration.
+
+      @param periodMilliSeconds The time between subsequent expirations, or
+                                zero for a one-shot timer.
+  */
+  void startTimer (int delayMilliSeconds, int periodMilliSeconds = 0);
+
+  /** Start the timer with an absolute deadline.
+
+      A deadline in the past causes the timer to expire as soon as possible.
+
+      @param deadline           The time of the first expiration.
+
+      @param periodMilliSeconds The time between subsequent expirations, or
+                                zero for a one-shot timer.
+  */
+  void startTimerAt (Time deadline, int periodMilliSeconds = 0);
+
+  /** Cancel the timer.
+
+      When this returns, the callback is guaranteed not to be running on
+      another thread and will not be called again until the timer is restarted.
+      It is safe to call this from within onTimerExpired().
+  */
+  void cancelTimer ();
+
+  /** Determine if the timer is running.
+
+      @return `true` if the timer will expire in the future.
+  */
+  bool isTimerRunning () const;
+
+protected:
+  /** Called when the timer expires.
+
+      This is called on the thread of the TimerWheel.
+  */
+  virtual void onTimerExpired () = 0;
+
+private:
+  friend class TimerWheel;
+
+  TimerWheel::Ptr m_wheel;
+  Slot* m_slot;
+  int64 m_expires;
+  int m_period;
+};
+
+#endif
@@ -0,0 +1,172 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_BOUNDCALL_VFHEADER
+#define VF_BOUNDCALL_VFHEADER
+
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+
+/** A compile time list of indices, used to expand a tuple into arguments.
+*/
+template <int... Indices>
+struct IndexSequence
+{
+};
+
+template <int N, int... Indices>
+struct MakeIndexSequence : MakeIndexSequence <N - 1, N - 1, Indices...>
+{
+};
+
+template <int... Indices>
+struct MakeIndexSequence <0, Indices...>
+{
+  typedef IndexSequence <Indices...> type;
+};
+
+/*============================================================================*/
+/**
+  A function and its arguments, packaged for a later call.
+
+  This is the variadic counterpart of bind(), used by the submission
+  functions of CallQueue, ThreadGroup and ParallelFor. Each argument is
+  forwarded into the object once: rvalues are moved and lvalues copied.
+  Construct the BoundCall directly where it will live, for example in the
+  Work allocated from a FifoFreeStore, so that no further copies are made.
+
+  When called, the stored arguments are passed as lvalues, so the call may
+  be repeated. Arguments given to the call are appended to the stored ones,
+  which is how ParallelFor passes the loop index.
+
+  If the function is a pointer to a member function, the first stored
+  argument is a pointer to the object, or a smart pointer.
+
+  @ingroup vf_core
+*/
+template <class Fn, class... Args>
+class BoundCall
+{
+public:
+  // Excluded for copies, which use the copy constructor.
+  template <class F, class... A, class = typename std::enable_if <
+    !std::is_same <typename std::decay <F>::type, BoundCall>::value>::type>
+  explicit BoundCall (F&& f, A&&... args)
+    : m_f (std::forward <F> (f))
+    , m_args (std::forward <A> (args)...)
+  {
+  }
+
+  template <class... Extra>
+  void operator() (Extra&&... extra)
+  {
+    call (typename MakeIndexSequence <sizeof... (Args)>::type (),
+          std::forward <Extra> (extra)...);
+  }
+
+  /** Call a function or a pointer to a member function.
+  */
+  /** @{ */
+  template <class F, class Object, class... A>
+  static void invoke (std::true_type, F& f, Object&& object, A&&... args)
+  {
+    ((*object).*f) (std::forward <A> (args)...);
+  }
+
+  template <class F, class... A>
+  static void invoke (std::false_type, F& f, A&&... args)
+  {
+    f (std::forward <A> (args)...);
+  }
+  /** @} */
+
+private:
+  typedef typename std::decay <Fn>::type Function;
+  typedef std::tuple <typename std::decay <Args>::type...> Arguments;
+
+  template <int... Indices, class... Extra>
+  void call (IndexSequence <Indices...>, Extra&&... extra)
+  {
+    invoke (std::is_member_function_pointer <Function> (), m_f,
+            std::get <Indices> (m_args)..., std::forward <Extra> (extra)...);
+  }
+
+private:
+  Function m_f;
+  Arguments m_args;
+};
+
+//------------------------------------------------------------------------------
+/**
+  A member function and its arguments, packaged for calls on many objects.
+
+  This is the variadic counterpart of `bind (mf, _1, args...)`, used by
+  Listeners. The object is supplied to each call, followed by the stored
+  arguments.
+
+  @ingroup vf_core
+*/
+template <class Mf, class... Args>
+class BoundMemberCall
+{
+public:
+  template <class F, class... A, class = typename std::enable_if <
+    !std::is_same <typename std::decay <F>::type, BoundMemberCall>::value>::type>
+  explicit BoundMemberCall (F&& mf, A&&... args)
+    : m_mf (std::forward <F> (mf))
+    , m_args (std::forward <A> (args)...)
+  {
+  }
+
+  template <class Object>
+  void operator() (Object* object)
+  {
+    call (object, typename MakeIndexSequence <sizeof... (Args)>::type ());
+  }
+
+private:
+  typedef typename std::decay <Mf>::type Member;
+  typedef std::tuple <typename std::decay <Args>::type...> Arguments;
+
+  template <class Object, int... Indices>
+  void call (Object* object, IndexSequence <Indices...>)
+  {
+    (object->*m_mf) (std::get <Indices> (m_args)...);
+  }
+
+private:
+  Member m_mf;
+  Arguments m_args;
+};
+
+#endif
+
+#endif
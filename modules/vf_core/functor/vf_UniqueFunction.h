@@ -0,0 +1,269 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_UNIQUEFUNCTION_VFHEADER
+#define VF_UNIQUEFUNCTION_VFHEADER
+
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+
+/*============================================================================*/
+/**
+  Move-only function wrapper with small buffer storage.
+
+  This holds any callable object with a matching signature, like Function,
+  but differs in the ways that matter for work items passed between
+  threads:
+
+  - It is move-only, so the callable is never copied after it has been
+    wrapped. It may hold move-only objects, such as a ScopedPointer or
+    another UniqueFunction.
+
+  - Callables of up to Bytes in size are stored inside the object. Larger
+    ones are placed on the heap instead of failing to compile, so Bytes can
+    be sized for the common case rather than the worst one.
+
+  - Calls go through a function pointer stored in the object, with no
+    virtual table to load first.
+
+  @code
+
+  UniqueFunction <void (int)> f ([] (int value) { DBG (value); });
+
+  f (42);
+
+  UniqueFunction <void (int)> g (std::move (f));
+
+  @endcode
+
+  The default Bytes holds a member function pointer and two arguments
+  without going to the heap.
+
+  @ingroup vf_core
+*/
+template <typename Signature, int Bytes = 4 * sizeof (void*)>
+class UniqueFunction;
+
+template <typename R, typename... Args, int Bytes>
+class UniqueFunction <R (Args...), Bytes>
+{
+public:
+  typedef R result_type;
+
+  /** Create an empty function. Calling it is undefined. */
+  UniqueFunction () noexcept
+    : m_invoke (nullptr)
+    , m_manage (nullptr)
+  {
+  }
+
+  /** Create a function from a callable object.
+
+      The object is moved or copied into the function, depending on
+      whether an rvalue or an lvalue was passed.
+  */
+  template <class Functor, class = typename std::enable_if <
+    !std::is_same <typename std::decay <Functor>::type, UniqueFunction>::value>::type>
+  UniqueFunction (Functor&& f)
+  {
+    construct (std::forward <Functor> (f));
+  }
+
+  UniqueFunction (UniqueFunction&& other) noexcept
+    : m_invoke (other.m_invoke)
+    , m_manage (other.m_manage)
+  {
+    if (m_manage != nullptr)
+    {
+      m_manage (opMove, &m_storage, &other.m_storage);
+      other.m_invoke = nullptr;
+      other.m_manage = nullptr;
+    }
+  }
+
+  UniqueFunction& operator= (UniqueFunction&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset ();
+
+      if (other.m_manage != nullptr)
+      {
+        other.m_manage (opMove, &m_storage, &other.m_storage);
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+        other.m_invoke = nullptr;
+        other.m_manage = nullptr;
+      }
+    }
+
+    return *this;
+  }
+
+  ~UniqueFunction ()
+  {
+    reset ();
+  }
+
+  /** Destroy the callable object, leaving the function empty. */
+  void reset () noexcept
+  {
+    if (m_manage != nullptr)
+    {
+      m_manage (opDestroy, &m_storage, nullptr);
+      m_invoke = nullptr;
+      m_manage = nullptr;
+    }
+  }
+
+  /** Determine if the function holds a callable object. */
+  explicit operator bool () const noexcept
+  {
+    return m_invoke != nullptr;
+  }
+
+  /** Call the object. */
+  R operator() (Args... args)
+  {
+    jassert (m_invoke != nullptr);
+
+    return m_invoke (&m_storage, std::forward <Args> (args)...);
+  }
+
+  UniqueFunction (UniqueFunction const&) = delete;
+  UniqueFunction& operator= (UniqueFunction const&) = delete;
+
+private:
+  static_assert (Bytes >= int (sizeof (void*)), "Bytes must hold a pointer");
+
+  enum Operation
+  {
+    opMove,
+    opDestroy
+  };
+
+  typedef typename std::aligned_storage <Bytes>::type Storage;
+
+  typedef R (*Invoke) (void* storage, Args&&... args);
+  typedef void (*Manage) (Operation op, void* storage, void* source);
+
+  // Callables which cannot be moved without throwing go on the heap, so
+  // that moving the function never throws.
+  template <class Functor>
+  struct IsInline
+  {
+    enum
+    {
+      value = sizeof (Functor) <= sizeof (Storage)
+        && std::alignment_of <Functor>::value <= std::alignment_of <Storage>::value
+        && std::is_nothrow_move_constructible <Functor>::value
+    };
+  };
+
+  template <class Functor>
+  struct Inline
+  {
+    static R invoke (void* storage, Args&&... args)
+    {
+      return (*static_cast <Functor*> (storage)) (std::forward <Args> (args)...);
+    }
+
+    static void manage (Operation op, void* storage, void* source)
+    {
+      if (op == opMove)
+      {
+        Functor* const other = static_cast <Functor*> (source);
+        new (storage) Functor (std::move (*other));
+        other->~Functor ();
+      }
+      else
+      {
+        static_cast <Functor*> (storage)->~Functor ();
+      }
+    }
+  };
+
+  template <class Functor>
+  struct Heap
+  {
+    static Functor*& get (void* storage)
+    {
+      return *static_cast <Functor**> (storage);
+    }
+
+    static R invoke (void* storage, Args&&... args)
+    {
+      return (*get (storage)) (std::forward <Args> (args)...);
+    }
+
+    static void manage (Operation op, void* storage, void* source)
+    {
+      if (op == opMove)
+        new (storage) Functor* (get (source));
+      else
+        delete get (storage);
+    }
+  };
+
+  template <class Functor>
+  void construct (Functor&& f)
+  {
+    typedef typename std::decay <Functor>::type Stored;
+
+    constructAs <Stored> (std::forward <Functor> (f),
+      std::integral_constant <bool, IsInline <Stored>::value> ());
+  }
+
+  template <class Stored, class Functor>
+  void constructAs (Functor&& f, std::true_type)
+  {
+    new (&m_storage) Stored (std::forward <Functor> (f));
+    m_invoke = &Inline <Stored>::invoke;
+    m_manage = &Inline <Stored>::manage;
+  }
+
+  template <class Stored, class Functor>
+  void constructAs (Functor&& f, std::false_type)
+  {
+    new (&m_storage) Stored* (new Stored (std::forward <Functor> (f)));
+    m_invoke = &Heap <Stored>::invoke;
+    m_manage = &Heap <Stored>::manage;
+  }
+
+private:
+  Invoke m_invoke;
+  Manage m_manage;
+  Storage m_storage;
+};
+
+#endif
+
+#endif
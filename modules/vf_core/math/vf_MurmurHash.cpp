@@ -356,4 +356,518 @@ void MurmurHash3_x64_128 ( const void * key, const int len,
   ((uint64_t*)out)[1] = h2;
 }
 
+//-----------------------------------------------------------------------------
+// Batch hashing. Four keys are hashed at once, one per lane.
+
+static FORCE_INLINE uint32_t tail_x86_32 ( const uint8_t * tail, int len )
+{
+  uint32_t k1 = 0;
+
+  switch(len & 3)
+  {
+  case 3: k1 ^= tail[2] << 16;
+  case 2: k1 ^= tail[1] << 8;
+  case 1: k1 ^= tail[0];
+  };
+
+  return k1;
+}
+
+#if VF_USE_SSE2
+
+// SSE2 has no 32 bit multiply, so build one from the 64 bit multiply
+static FORCE_INLINE __m128i mul32 ( __m128i a, __m128i b )
+{
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+                            _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0,0,2,0)));
+}
+
+static FORCE_INLINE __m128i rotl32x4 ( __m128i x, int r )
+{
+  return _mm_or_si128(_mm_slli_epi32(x, r), _mm_srli_epi32(x, 32 - r));
+}
+
+static void hash4_x86_32 ( const uint8_t * data, int len, int stride,
+                           uint32_t seed, uint32_t * out )
+{
+  const int nblocks = len / 4;
+
+  const __m128i c1 = _mm_set1_epi32(int(0xcc9e2d51));
+  const __m128i c2 = _mm_set1_epi32(int(0x1b873593));
+
+  __m128i h1 = _mm_set1_epi32(int(seed));
+
+  const uint8_t * d0 = data;
+  const uint8_t * d1 = data + stride;
+  const uint8_t * d2 = data + stride*2;
+  const uint8_t * d3 = data + stride*3;
+
+  //----------
+  // body
+
+  for(int i = 0; i < nblocks; i++)
+  {
+    __m128i k1 = _mm_set_epi32(int(getblock((const uint32_t *)d3, i)),
+                               int(getblock((const uint32_t *)d2, i)),
+                               int(getblock((const uint32_t *)d1, i)),
+                               int(getblock((const uint32_t *)d0, i)));
+
+    k1 = mul32(k1, c1);
+    k1 = rotl32x4(k1, 15);
+    k1 = mul32(k1, c2);
+
+    h1 = _mm_xor_si128(h1, k1);
+    h1 = rotl32x4(h1, 13);
+    h1 = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(h1, 2), h1),
+                       _mm_set1_epi32(int(0xe6546b64)));
+  }
+
+  //----------
+  // tail
+
+  if(len & 3)
+  {
+    __m128i k1 = _mm_set_epi32(int(tail_x86_32(d3 + nblocks*4, len)),
+                               int(tail_x86_32(d2 + nblocks*4, len)),
+                               int(tail_x86_32(d1 + nblocks*4, len)),
+                               int(tail_x86_32(d0 + nblocks*4, len)));
+
+    k1 = mul32(k1, c1);
+    k1 = rotl32x4(k1, 15);
+    k1 = mul32(k1, c2);
+
+    h1 = _mm_xor_si128(h1, k1);
+  }
+
+  //----------
+  // finalization
+
+  h1 = _mm_xor_si128(h1, _mm_set1_epi32(len));
+
+  h1 = _mm_xor_si128(h1, _mm_srli_epi32(h1, 16));
+  h1 = mul32(h1, _mm_set1_epi32(int(0x85ebca6b)));
+  h1 = _mm_xor_si128(h1, _mm_srli_epi32(h1, 13));
+  h1 = mul32(h1, _mm_set1_epi32(int(0xc2b2ae35)));
+  h1 = _mm_xor_si128(h1, _mm_srli_epi32(h1, 16));
+
+  _mm_storeu_si128((__m128i *)out, h1);
+}
+
+#else
+
+// Independent lanes give the processor four chains to overlap
+static void hash4_x86_32 ( const uint8_t * data, int len, int stride,
+                           uint32_t seed, uint32_t * out )
+{
+  const int nblocks = len / 4;
+
+  uint32_t c1 = 0xcc9e2d51;
+  uint32_t c2 = 0x1b873593;
+
+  uint32_t h1[4] = { seed, seed, seed, seed };
+
+  for(int i = 0; i < nblocks; i++)
+  {
+    for(int lane = 0; lane < 4; lane++)
+    {
+      uint32_t k1 = getblock((const uint32_t *)(data + lane*stride), i);
+
+      k1 *= c1; k1 = ROTL32(k1,15); k1 *= c2;
+
+      h1[lane] ^= k1;
+      h1[lane] = ROTL32(h1[lane],13);
+      h1[lane] = h1[lane]*5+0xe6546b64;
+    }
+  }
+
+  for(int lane = 0; lane < 4; lane++)
+  {
+    if(len & 3)
+    {
+      uint32_t k1 = tail_x86_32(data + lane*stride + nblocks*4, len);
+
+      k1 *= c1; k1 = ROTL32(k1,15); k1 *= c2; h1[lane] ^= k1;
+    }
+
+    h1[lane] ^= len;
+
+    out[lane] = fmix(h1[lane]);
+  }
+}
+
+#endif
+
+void MurmurHash3_x86_32_batch ( const void * keys, int len, int stride,
+                                int count, uint32_t seed, uint32_t * out )
+{
+  const uint8_t * data = (const uint8_t*)keys;
+
+  int i = 0;
+
+  for(; i + 4 <= count; i += 4)
+    hash4_x86_32(data + i*stride, len, stride, seed, out + i);
+
+  for(; i < count; i++)
+    MurmurHash3_x86_32(data + i*stride, len, seed, out + i);
+}
+
+//-----------------------------------------------------------------------------
+// Incremental hashing. Each hasher keeps the running state of the one shot
+// function, plus the bytes of a partial block until the block is complete.
+
+Hasher_x86_32::Hasher_x86_32 (uint32 seed)
+{
+  init (seed);
+}
+
+void Hasher_x86_32::init (uint32 seed)
+{
+  m_h1 = seed;
+  m_length = 0;
+  m_tailLength = 0;
+}
+
+void Hasher_x86_32::update (const void* data, int len)
+{
+  const uint8_t * p = (const uint8_t*)data;
+
+  uint32_t c1 = 0xcc9e2d51;
+  uint32_t c2 = 0x1b873593;
+
+  uint32_t h1 = m_h1;
+
+  m_length += len;
+
+  while(len > 0)
+  {
+    const uint8_t * block;
+
+    if(m_tailLength > 0 || len < 4)
+    {
+      // Collect a partial block
+      int n = jmin(4 - m_tailLength, len);
+      memcpy(m_tail + m_tailLength, p, n);
+      m_tailLength += n;
+      p += n;
+      len -= n;
+
+      if(m_tailLength < 4)
+        break;
+
+      block = m_tail;
+      m_tailLength = 0;
+    }
+    else
+    {
+      block = p;
+      p += 4;
+      len -= 4;
+    }
+
+    uint32_t k1 = getblock((const uint32_t *)block, 0);
+
+    k1 *= c1;
+    k1 = ROTL32(k1,15);
+    k1 *= c2;
+
+    h1 ^= k1;
+    h1 = ROTL32(h1,13);
+    h1 = h1*5+0xe6546b64;
+  }
+
+  m_h1 = h1;
+}
+
+void Hasher_x86_32::finalize (void* out) const
+{
+  uint32_t c1 = 0xcc9e2d51;
+  uint32_t c2 = 0x1b873593;
+
+  uint32_t h1 = m_h1;
+
+  if(m_tailLength > 0)
+  {
+    uint32_t k1 = tail_x86_32(m_tail, m_tailLength);
+
+    k1 *= c1; k1 = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+  }
+
+  h1 ^= m_length;
+
+  h1 = fmix(h1);
+
+  *(uint32_t*)out = h1;
+}
+
+//-----------------------------------------------------------------------------
+
+Hasher_x86_128::Hasher_x86_128 (uint32 seed)
+{
+  init (seed);
+}
+
+void Hasher_x86_128::init (uint32 seed)
+{
+  m_h[0] = m_h[1] = m_h[2] = m_h[3] = seed;
+  m_length = 0;
+  m_tailLength = 0;
+}
+
+void Hasher_x86_128::update (const void* data, int len)
+{
+  const uint8_t * p = (const uint8_t*)data;
+
+  uint32_t h1 = m_h[0];
+  uint32_t h2 = m_h[1];
+  uint32_t h3 = m_h[2];
+  uint32_t h4 = m_h[3];
+
+  uint32_t c1 = 0x239b961b;
+  uint32_t c2 = 0xab0e9789;
+  uint32_t c3 = 0x38b34ae5;
+  uint32_t c4 = 0xa1e38b93;
+
+  m_length += len;
+
+  while(len > 0)
+  {
+    const uint8_t * block;
+
+    if(m_tailLength > 0 || len < 16)
+    {
+      int n = jmin(16 - m_tailLength, len);
+      memcpy(m_tail + m_tailLength, p, n);
+      m_tailLength += n;
+      p += n;
+      len -= n;
+
+      if(m_tailLength < 16)
+        break;
+
+      block = m_tail;
+      m_tailLength = 0;
+    }
+    else
+    {
+      block = p;
+      p += 16;
+      len -= 16;
+    }
+
+    const uint32_t * blocks = (const uint32_t *)block;
+
+    uint32_t k1 = getblock(blocks,0);
+    uint32_t k2 = getblock(blocks,1);
+    uint32_t k3 = getblock(blocks,2);
+    uint32_t k4 = getblock(blocks,3);
+
+    k1 *= c1; k1  = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+
+    h1 = ROTL32(h1,19); h1 += h2; h1 = h1*5+0x561ccd1b;
+
+    k2 *= c2; k2  = ROTL32(k2,16); k2 *= c3; h2 ^= k2;
+
+    h2 = ROTL32(h2,17); h2 += h3; h2 = h2*5+0x0bcaa747;
+
+    k3 *= c3; k3  = ROTL32(k3,17); k3 *= c4; h3 ^= k3;
+
+    h3 = ROTL32(h3,15); h3 += h4; h3 = h3*5+0x96cd1c35;
+
+    k4 *= c4; k4  = ROTL32(k4,18); k4 *= c1; h4 ^= k4;
+
+    h4 = ROTL32(h4,13); h4 += h1; h4 = h4*5+0x32ac3b17;
+  }
+
+  m_h[0] = h1;
+  m_h[1] = h2;
+  m_h[2] = h3;
+  m_h[3] = h4;
+}
+
+void Hasher_x86_128::finalize (void* out) const
+{
+  uint32_t h1 = m_h[0];
+  uint32_t h2 = m_h[1];
+  uint32_t h3 = m_h[2];
+  uint32_t h4 = m_h[3];
+
+  uint32_t c1 = 0x239b961b;
+  uint32_t c2 = 0xab0e9789;
+  uint32_t c3 = 0x38b34ae5;
+  uint32_t c4 = 0xa1e38b93;
+
+  const uint8_t * tail = m_tail;
+
+  uint32_t k1 = 0;
+  uint32_t k2 = 0;
+  uint32_t k3 = 0;
+  uint32_t k4 = 0;
+
+  switch(m_tailLength)
+  {
+  case 15: k4 ^= tail[14] << 16;
+  case 14: k4 ^= tail[13] << 8;
+  case 13: k4 ^= tail[12] << 0;
+           k4 *= c4; k4  = ROTL32(k4,18); k4 *= c1; h4 ^= k4;
+
+  case 12: k3 ^= tail[11] << 24;
+  case 11: k3 ^= tail[10] << 16;
+  case 10: k3 ^= tail[ 9] << 8;
+  case  9: k3 ^= tail[ 8] << 0;
+           k3 *= c3; k3  = ROTL32(k3,17); k3 *= c4; h3 ^= k3;
+
+  case  8: k2 ^= tail[ 7] << 24;
+  case  7: k2 ^= tail[ 6] << 16;
+  case  6: k2 ^= tail[ 5] << 8;
+  case  5: k2 ^= tail[ 4] << 0;
+           k2 *= c2; k2  = ROTL32(k2,16); k2 *= c3; h2 ^= k2;
+
+  case  4: k1 ^= tail[ 3] << 24;
+  case  3: k1 ^= tail[ 2] << 16;
+  case  2: k1 ^= tail[ 1] << 8;
+  case  1: k1 ^= tail[ 0] << 0;
+           k1 *= c1; k1  = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+  };
+
+  h1 ^= m_length; h2 ^= m_length; h3 ^= m_length; h4 ^= m_length;
+
+  h1 += h2; h1 += h3; h1 += h4;
+  h2 += h1; h3 += h1; h4 += h1;
+
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h3 = fmix(h3);
+  h4 = fmix(h4);
+
+  h1 += h2; h1 += h3; h1 += h4;
+  h2 += h1; h3 += h1; h4 += h1;
+
+  ((uint32_t*)out)[0] = h1;
+  ((uint32_t*)out)[1] = h2;
+  ((uint32_t*)out)[2] = h3;
+  ((uint32_t*)out)[3] = h4;
+}
+
+//-----------------------------------------------------------------------------
+
+Hasher_x64_128::Hasher_x64_128 (uint32 seed)
+{
+  init (seed);
+}
+
+void Hasher_x64_128::init (uint32 seed)
+{
+  m_h[0] = m_h[1] = seed;
+  m_length = 0;
+  m_tailLength = 0;
+}
+
+void Hasher_x64_128::update (const void* data, int len)
+{
+  const uint8_t * p = (const uint8_t*)data;
+
+  uint64_t h1 = m_h[0];
+  uint64_t h2 = m_h[1];
+
+  uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+  uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+  m_length += len;
+
+  while(len > 0)
+  {
+    const uint8_t * block;
+
+    if(m_tailLength > 0 || len < 16)
+    {
+      int n = jmin(16 - m_tailLength, len);
+      memcpy(m_tail + m_tailLength, p, n);
+      m_tailLength += n;
+      p += n;
+      len -= n;
+
+      if(m_tailLength < 16)
+        break;
+
+      block = m_tail;
+      m_tailLength = 0;
+    }
+    else
+    {
+      block = p;
+      p += 16;
+      len -= 16;
+    }
+
+    const uint64_t * blocks = (const uint64_t *)block;
+
+    uint64_t k1 = getblock(blocks,0);
+    uint64_t k2 = getblock(blocks,1);
+
+    k1 *= c1; k1  = ROTL64(k1,31); k1 *= c2; h1 ^= k1;
+
+    h1 = ROTL64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+
+    k2 *= c2; k2  = ROTL64(k2,33); k2 *= c1; h2 ^= k2;
+
+    h2 = ROTL64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+  }
+
+  m_h[0] = h1;
+  m_h[1] = h2;
+}
+
+void Hasher_x64_128::finalize (void* out) const
+{
+  uint64_t h1 = m_h[0];
+  uint64_t h2 = m_h[1];
+
+  uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+  uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+  const uint8_t * tail = m_tail;
+
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+
+  switch(m_tailLength)
+  {
+  case 15: k2 ^= uint64_t(tail[14]) << 48;
+  case 14: k2 ^= uint64_t(tail[13]) << 40;
+  case 13: k2 ^= uint64_t(tail[12]) << 32;
+  case 12: k2 ^= uint64_t(tail[11]) << 24;
+  case 11: k2 ^= uint64_t(tail[10]) << 16;
+  case 10: k2 ^= uint64_t(tail[ 9]) << 8;
+  case  9: k2 ^= uint64_t(tail[ 8]) << 0;
+           k2 *= c2; k2  = ROTL64(k2,33); k2 *= c1; h2 ^= k2;
+
+  case  8: k1 ^= uint64_t(tail[ 7]) << 56;
+  case  7: k1 ^= uint64_t(tail[ 6]) << 48;
+  case  6: k1 ^= uint64_t(tail[ 5]) << 40;
+  case  5: k1 ^= uint64_t(tail[ 4]) << 32;
+  case  4: k1 ^= uint64_t(tail[ 3]) << 24;
+  case  3: k1 ^= uint64_t(tail[ 2]) << 16;
+  case  2: k1 ^= uint64_t(tail[ 1]) << 8;
+  case  1: k1 ^= uint64_t(tail[ 0]) << 0;
+           k1 *= c1; k1  = ROTL64(k1,31); k1 *= c2; h1 ^= k1;
+  };
+
+  h1 ^= m_length; h2 ^= m_length;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  ((uint64_t*)out)[0] = h1;
+  ((uint64_t*)out)[1] = h2;
+}
+
 }
@@ -43,6 +43,74 @@ extern void MurmurHash3_x86_32  (const void *key, int len, uint32 seed, void* ou
 extern void MurmurHash3_x86_128 (const void *key, int len, uint32 seed, void* out);
 extern void MurmurHash3_x64_128 (const void *key, int len, uint32 seed, void* out);
 
+// Hashes count keys of len bytes each, the first at keys and each following
+// one stride bytes further, into out [0..count). The result for each key is
+// the same as MurmurHash3_x86_32. Groups of four keys are hashed together
+// in interleaved lanes, with SSE2 where it is available.
+extern void MurmurHash3_x86_32_batch (const void* keys, int len, int stride,
+                                      int count, uint32 seed, uint32* out);
+
+//------------------------------------------------------------------------------
+
+// Incremental forms of the hash functions, for data that arrives in pieces.
+// Call update() with each piece in order, then finalize() to produce the
+// same hash as the function above over all the pieces concatenated.
+// finalize() does not change the state, so more data may follow it.
+
+class Hasher_x86_32
+{
+public:
+  explicit Hasher_x86_32 (uint32 seed = 0);
+  void init (uint32 seed = 0);
+  void update (const void* data, int len);
+  void finalize (void* out) const;
+
+private:
+  uint32 m_h1;
+  uint32 m_length;
+  int m_tailLength;
+  uint8 m_tail [4];
+};
+
+class Hasher_x86_128
+{
+public:
+  explicit Hasher_x86_128 (uint32 seed = 0);
+  void init (uint32 seed = 0);
+  void update (const void* data, int len);
+  void finalize (void* out) const;
+
+private:
+  uint32 m_h [4];
+  uint32 m_length;
+  int m_tailLength;
+  uint8 m_tail [16];
+};
+
+class Hasher_x64_128
+{
+public:
+  explicit Hasher_x64_128 (uint32 seed = 0);
+  void init (uint32 seed = 0);
+  void update (const void* data, int len);
+  void finalize (void* out) const;
+
+private:
+  uint64 m_h [2];
+  uint32 m_length;
+  int m_tailLength;
+  uint8 m_tail [16];
+};
+
+// The 128 bit hasher that matches Hash() for a 128 bit HashType
+#if JUCE_64BIT
+typedef Hasher_x64_128 Hasher128;
+#else
+typedef Hasher_x86_128 Hasher128;
+#endif
+
+typedef Hasher_x86_32 Hasher32;
+
 // Uses Juce to choose an appropriate routine
 
 // This handy template deduces which size hash is desired
@@ -65,6 +133,55 @@ inline void Hash (const void* key, int len, uint32 seed, HashType* out)
   };
 }
 
+// Function object for hashed containers. The key must be a plain
+// type whose bytes determine equality, such as an integer or pointer.
+// Structures with padding, floating point values where 0 equals -0,
+// and types owning memory through pointers hash differently from the
+// way they compare. Give those types their own specialization.
+template <class Key>
+struct HashFunction
+{
+  explicit HashFunction (uint32 seed = 0) : m_seed (seed)
+  {
+  }
+
+  inline uint32 operator() (Key const& key) const
+  {
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+    static_assert (std::is_trivially_copyable <Key>::value,
+                   "Keys that are not plain data need a HashFunction specialization");
+#endif
+
+    uint32 result;
+    MurmurHash3_x86_32 (&key, int (sizeof (Key)), m_seed, &result);
+    return result;
+  }
+
+private:
+  uint32 m_seed;
+};
+
+// Strings are hashed by their UTF-8 characters.
+template <>
+struct HashFunction <String>
+{
+  explicit HashFunction (uint32 seed = 0) : m_seed (seed)
+  {
+  }
+
+  inline uint32 operator() (String const& key) const
+  {
+    char const* const utf8 = key.toUTF8 ();
+
+    uint32 result;
+    MurmurHash3_x86_32 (utf8, int (strlen (utf8)), m_seed, &result);
+    return result;
+  }
+
+private:
+  uint32 m_seed;
+};
+
 }
 
 #endif
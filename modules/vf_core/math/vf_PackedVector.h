@@ -0,0 +1,606 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_PACKEDVECTOR_VFHEADER
+#define VF_PACKEDVECTOR_VFHEADER
+
+/*============================================================================*/
+/**
+  Four floats in one SIMD register.
+
+  The implementation is chosen at compile time. It uses SSE2 when
+  VF_USE_SSE2 is set, NEON when VF_USE_NEON is set, and otherwise a
+  plain array which the compiler may still vectorize.
+
+  Comparisons produce masks, where each lane has either all bits set or
+  none. Use them with select().
+
+  @ingroup vf_core
+*/
+class Vec4f
+{
+public:
+#if VF_USE_SSE2
+  typedef __m128 NativeType;
+#elif VF_USE_NEON
+  typedef float32x4_t NativeType;
+#else
+  struct NativeType { float v [4]; };
+#endif
+
+  enum
+  {
+    /** Nonzero if the lanes are processed by SIMD instructions. Where they
+        are not, code that is written for one value at a time may be faster.
+    */
+    isNative = (VF_USE_SSE2 || VF_USE_NEON) ? 1 : 0
+  };
+
+  /** Create an uninitialized vector. */
+  Vec4f () noexcept
+  {
+  }
+
+  explicit Vec4f (NativeType value) noexcept
+    : m_value (value)
+  {
+  }
+
+  /** Create a vector with every lane set to the same value. */
+  explicit Vec4f (float value) noexcept
+  {
+#if VF_USE_SSE2
+    m_value = _mm_set1_ps (value);
+#elif VF_USE_NEON
+    m_value = vdupq_n_f32 (value);
+#else
+    for (int i = 0; i < 4; ++i)
+      m_value.v [i] = value;
+#endif
+  }
+
+  /** Create a vector from four values, in lane order. */
+  Vec4f (float x, float y, float z, float w) noexcept
+  {
+#if VF_USE_SSE2
+    m_value = _mm_setr_ps (x, y, z, w);
+#else
+    float const values [4] = { x, y, z, w };
+    *this = load (values);
+#endif
+  }
+
+  /** Load four consecutive floats from any address. */
+  static Vec4f load (float const* source) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_loadu_ps (source));
+#elif VF_USE_NEON
+    return Vec4f (vld1q_f32 (source));
+#else
+    Vec4f result;
+    for (int i = 0; i < 4; ++i)
+      result.m_value.v [i] = source [i];
+    return result;
+#endif
+  }
+
+  /** Store the four lanes to any address. */
+  void store (float* dest) const noexcept
+  {
+#if VF_USE_SSE2
+    _mm_storeu_ps (dest, m_value);
+#elif VF_USE_NEON
+    vst1q_f32 (dest, m_value);
+#else
+    for (int i = 0; i < 4; ++i)
+      dest [i] = m_value.v [i];
+#endif
+  }
+
+  inline NativeType getNative () const noexcept
+  {
+    return m_value;
+  }
+
+  //----------------------------------------------------------------------------
+
+  friend Vec4f operator+ (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_add_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vaddq_f32 (a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] += b.m_value.v [i];
+    return a;
+#endif
+  }
+
+  friend Vec4f operator- (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_sub_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vsubq_f32 (a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] -= b.m_value.v [i];
+    return a;
+#endif
+  }
+
+  friend Vec4f operator* (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_mul_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vmulq_f32 (a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] *= b.m_value.v [i];
+    return a;
+#endif
+  }
+
+  friend Vec4f operator/ (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_div_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON && defined (__aarch64__)
+    return Vec4f (vdivq_f32 (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    // Reciprocal estimate with two Newton-Raphson steps.
+    float32x4_t r = vrecpeq_f32 (b.m_value);
+    r = vmulq_f32 (vrecpsq_f32 (b.m_value, r), r);
+    r = vmulq_f32 (vrecpsq_f32 (b.m_value, r), r);
+    return Vec4f (vmulq_f32 (a.m_value, r));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] /= b.m_value.v [i];
+    return a;
+#endif
+  }
+
+  /** Returns a * b + c. */
+  static Vec4f multiplyAdd (Vec4f a, Vec4f b, Vec4f c) noexcept
+  {
+    return a * b + c;
+  }
+
+  static Vec4f minimum (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_min_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vminq_f32 (a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] = jmin (a.m_value.v [i], b.m_value.v [i]);
+    return a;
+#endif
+  }
+
+  static Vec4f maximum (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_max_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vmaxq_f32 (a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+      a.m_value.v [i] = jmax (a.m_value.v [i], b.m_value.v [i]);
+    return a;
+#endif
+  }
+
+  static Vec4f sqrt (Vec4f a) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_sqrt_ps (a.m_value));
+#elif VF_USE_NEON && defined (__aarch64__)
+    return Vec4f (vsqrtq_f32 (a.m_value));
+#else
+    float values [4];
+    a.store (values);
+    for (int i = 0; i < 4; ++i)
+      values [i] = std::sqrt (values [i]);
+    return load (values);
+#endif
+  }
+
+  /** Returns the cube root of positive values.
+
+      An estimate taken from the exponent bits is refined with two Halley
+      iterations, which gives full float precision up to FLT_MAX. Lanes
+      which are zero, negative or denormal return zero.
+  */
+  static Vec4f cbrt (Vec4f a) noexcept
+  {
+    // Dividing the bit pattern by three divides the exponent by three.
+    // The division is done in floating point, which is accurate enough
+    // for an estimate.
+    float const third = 1.f / 3.f;
+    int const bias = 709921077;
+
+#if VF_USE_SSE2
+    __m128i bits = _mm_castps_si128 (a.m_value);
+    bits = _mm_cvttps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (bits), _mm_set1_ps (third)));
+    bits = _mm_add_epi32 (bits, _mm_set1_epi32 (bias));
+    Vec4f y (_mm_castsi128_ps (bits));
+#elif VF_USE_NEON
+    int32x4_t bits = vreinterpretq_s32_f32 (a.m_value);
+    bits = vcvtq_s32_f32 (vmulq_n_f32 (vcvtq_f32_s32 (bits), third));
+    bits = vaddq_s32 (bits, vdupq_n_s32 (bias));
+    Vec4f y (vreinterpretq_f32_s32 (bits));
+#else
+    Vec4f y;
+    for (int i = 0; i < 4; ++i)
+    {
+      int32 bits;
+      memcpy (&bits, &a.m_value.v [i], sizeof (bits));
+      bits = int32 (bits * third) + bias;
+      memcpy (&y.m_value.v [i], &bits, sizeof (bits));
+    }
+#endif
+
+    // The iteration uses the ratio r = y^3 / a, which stays close to
+    // one, so that no term overflows for values close to FLT_MAX.
+    Vec4f const one (1.f);
+    Vec4f const two (2.f);
+    Vec4f const inverse = one / a;
+
+    for (int i = 0; i < 2; ++i)
+    {
+      Vec4f const r = y * inverse * y * y;
+      y = y * ((r + two) / (two * r + one));
+    }
+
+    // The lanes below FLT_MIN may hold NaN from the estimate.
+    return select (greaterThan (Vec4f (FLT_MIN), a), Vec4f (0.f), y);
+  }
+
+  /** Returns a mask of the lanes where a is greater than b. */
+  static Vec4f greaterThan (Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_cmpgt_ps (a.m_value, b.m_value));
+#elif VF_USE_NEON
+    return Vec4f (vreinterpretq_f32_u32 (vcgtq_f32 (a.m_value, b.m_value)));
+#else
+    for (int i = 0; i < 4; ++i)
+    {
+      uint32 const bits = a.m_value.v [i] > b.m_value.v [i] ? 0xffffffff : 0;
+      memcpy (&a.m_value.v [i], &bits, sizeof (bits));
+    }
+    return a;
+#endif
+  }
+
+  /** Returns the lanes of a where the mask is set, and of b elsewhere. */
+  static Vec4f select (Vec4f mask, Vec4f a, Vec4f b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec4f (_mm_or_ps (_mm_and_ps (mask.m_value, a.m_value),
+                             _mm_andnot_ps (mask.m_value, b.m_value)));
+#elif VF_USE_NEON
+    return Vec4f (vbslq_f32 (vreinterpretq_u32_f32 (mask.m_value), a.m_value, b.m_value));
+#else
+    for (int i = 0; i < 4; ++i)
+    {
+      uint32 bits;
+      memcpy (&bits, &mask.m_value.v [i], sizeof (bits));
+      if (bits == 0)
+        a.m_value.v [i] = b.m_value.v [i];
+    }
+    return a;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+
+  /** Transpose a 4x4 matrix held in four vectors.
+
+      This converts four (x, y, z, w) records into a vector of x values,
+      a vector of y values, and so on, and back again.
+  */
+  static void transpose (Vec4f& a, Vec4f& b, Vec4f& c, Vec4f& d) noexcept
+  {
+#if VF_USE_SSE2
+    _MM_TRANSPOSE4_PS (a.m_value, b.m_value, c.m_value, d.m_value);
+#elif VF_USE_NEON
+    float32x4x2_t const ab = vtrnq_f32 (a.m_value, b.m_value);
+    float32x4x2_t const cd = vtrnq_f32 (c.m_value, d.m_value);
+    a.m_value = vcombine_f32 (vget_low_f32  (ab.val [0]), vget_low_f32  (cd.val [0]));
+    b.m_value = vcombine_f32 (vget_low_f32  (ab.val [1]), vget_low_f32  (cd.val [1]));
+    c.m_value = vcombine_f32 (vget_high_f32 (ab.val [0]), vget_high_f32 (cd.val [0]));
+    d.m_value = vcombine_f32 (vget_high_f32 (ab.val [1]), vget_high_f32 (cd.val [1]));
+#else
+    Vec4f* const rows [4] = { &a, &b, &c, &d };
+    for (int i = 0; i < 4; ++i)
+      for (int j = i + 1; j < 4; ++j)
+        std::swap (rows [i]->m_value.v [j], rows [j]->m_value.v [i]);
+#endif
+  }
+
+  /** Load four (x, y, z) records and separate their components.
+
+      @param source Points to twelve floats.
+  */
+  static void loadInterleaved3 (float const* source, Vec4f& x, Vec4f& y, Vec4f& z) noexcept
+  {
+#if VF_USE_SSE2
+    // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+    __m128 const a = _mm_loadu_ps (source);
+    __m128 const b = _mm_loadu_ps (source + 4);
+    __m128 const c = _mm_loadu_ps (source + 8);
+
+    x.m_value = _mm_shuffle_ps (_mm_shuffle_ps (a, a, _MM_SHUFFLE (3, 3, 0, 0)),
+                                _mm_shuffle_ps (b, c, _MM_SHUFFLE (1, 1, 2, 2)),
+                                _MM_SHUFFLE (2, 0, 2, 0));
+    y.m_value = _mm_shuffle_ps (_mm_shuffle_ps (a, b, _MM_SHUFFLE (0, 0, 1, 1)),
+                                _mm_shuffle_ps (b, c, _MM_SHUFFLE (2, 2, 3, 3)),
+                                _MM_SHUFFLE (2, 0, 2, 0));
+    z.m_value = _mm_shuffle_ps (_mm_shuffle_ps (a, b, _MM_SHUFFLE (1, 1, 2, 2)),
+                                _mm_shuffle_ps (c, c, _MM_SHUFFLE (3, 3, 0, 0)),
+                                _MM_SHUFFLE (2, 0, 2, 0));
+#elif VF_USE_NEON
+    float32x4x3_t const v = vld3q_f32 (source);
+    x.m_value = v.val [0];
+    y.m_value = v.val [1];
+    z.m_value = v.val [2];
+#else
+    for (int i = 0; i < 4; ++i)
+    {
+      x.m_value.v [i] = source [3 * i];
+      y.m_value.v [i] = source [3 * i + 1];
+      z.m_value.v [i] = source [3 * i + 2];
+    }
+#endif
+  }
+
+  /** Combine components into four (x, y, z) records and store them.
+
+      @param dest Points to room for twelve floats.
+  */
+  static void storeInterleaved3 (float* dest, Vec4f x, Vec4f y, Vec4f z) noexcept
+  {
+#if VF_USE_SSE2
+    __m128 const a = _mm_shuffle_ps (_mm_shuffle_ps (x.m_value, y.m_value, _MM_SHUFFLE (0, 0, 0, 0)),
+                                     _mm_shuffle_ps (z.m_value, x.m_value, _MM_SHUFFLE (1, 1, 0, 0)),
+                                     _MM_SHUFFLE (2, 0, 2, 0));
+    __m128 const b = _mm_shuffle_ps (_mm_shuffle_ps (y.m_value, z.m_value, _MM_SHUFFLE (1, 1, 1, 1)),
+                                     _mm_shuffle_ps (x.m_value, y.m_value, _MM_SHUFFLE (2, 2, 2, 2)),
+                                     _MM_SHUFFLE (2, 0, 2, 0));
+    __m128 const c = _mm_shuffle_ps (_mm_shuffle_ps (z.m_value, x.m_value, _MM_SHUFFLE (3, 3, 2, 2)),
+                                     _mm_shuffle_ps (y.m_value, z.m_value, _MM_SHUFFLE (3, 3, 3, 3)),
+                                     _MM_SHUFFLE (2, 0, 2, 0));
+    _mm_storeu_ps (dest, a);
+    _mm_storeu_ps (dest + 4, b);
+    _mm_storeu_ps (dest + 8, c);
+#elif VF_USE_NEON
+    float32x4x3_t v;
+    v.val [0] = x.m_value;
+    v.val [1] = y.m_value;
+    v.val [2] = z.m_value;
+    vst3q_f32 (dest, v);
+#else
+    for (int i = 0; i < 4; ++i)
+    {
+      dest [3 * i]     = x.m_value.v [i];
+      dest [3 * i + 1] = y.m_value.v [i];
+      dest [3 * i + 2] = z.m_value.v [i];
+    }
+#endif
+  }
+
+private:
+  NativeType m_value;
+};
+
+//------------------------------------------------------------------------------
+
+/**
+  Two doubles in one SIMD register.
+
+  This uses SSE2 when VF_USE_SSE2 is set, and otherwise a plain array.
+
+  @ingroup vf_core
+*/
+class Vec2d
+{
+public:
+#if VF_USE_SSE2
+  typedef __m128d NativeType;
+#else
+  struct NativeType { double v [2]; };
+#endif
+
+  /** Create an uninitialized vector. */
+  Vec2d () noexcept
+  {
+  }
+
+  explicit Vec2d (NativeType value) noexcept
+    : m_value (value)
+  {
+  }
+
+  /** Create a vector with both lanes set to the same value. */
+  explicit Vec2d (double value) noexcept
+  {
+#if VF_USE_SSE2
+    m_value = _mm_set1_pd (value);
+#else
+    m_value.v [0] = value;
+    m_value.v [1] = value;
+#endif
+  }
+
+  /** Create a vector from two values, in lane order. */
+  Vec2d (double x, double y) noexcept
+  {
+#if VF_USE_SSE2
+    m_value = _mm_setr_pd (x, y);
+#else
+    m_value.v [0] = x;
+    m_value.v [1] = y;
+#endif
+  }
+
+  /** Load two consecutive doubles from any address. */
+  static Vec2d load (double const* source) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_loadu_pd (source));
+#else
+    return Vec2d (source [0], source [1]);
+#endif
+  }
+
+  /** Store the two lanes to any address. */
+  void store (double* dest) const noexcept
+  {
+#if VF_USE_SSE2
+    _mm_storeu_pd (dest, m_value);
+#else
+    dest [0] = m_value.v [0];
+    dest [1] = m_value.v [1];
+#endif
+  }
+
+  inline NativeType getNative () const noexcept
+  {
+    return m_value;
+  }
+
+  //----------------------------------------------------------------------------
+
+  friend Vec2d operator+ (Vec2d a, Vec2d b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_add_pd (a.m_value, b.m_value));
+#else
+    return Vec2d (a.m_value.v [0] + b.m_value.v [0], a.m_value.v [1] + b.m_value.v [1]);
+#endif
+  }
+
+  friend Vec2d operator- (Vec2d a, Vec2d b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_sub_pd (a.m_value, b.m_value));
+#else
+    return Vec2d (a.m_value.v [0] - b.m_value.v [0], a.m_value.v [1] - b.m_value.v [1]);
+#endif
+  }
+
+  friend Vec2d operator* (Vec2d a, Vec2d b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_mul_pd (a.m_value, b.m_value));
+#else
+    return Vec2d (a.m_value.v [0] * b.m_value.v [0], a.m_value.v [1] * b.m_value.v [1]);
+#endif
+  }
+
+  friend Vec2d operator/ (Vec2d a, Vec2d b) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_div_pd (a.m_value, b.m_value));
+#else
+    return Vec2d (a.m_value.v [0] / b.m_value.v [0], a.m_value.v [1] / b.m_value.v [1]);
+#endif
+  }
+
+  /** Returns a * b + c. */
+  static Vec2d multiplyAdd (Vec2d a, Vec2d b, Vec2d c) noexcept
+  {
+    return a * b + c;
+  }
+
+  static Vec2d sqrt (Vec2d a) noexcept
+  {
+#if VF_USE_SSE2
+    return Vec2d (_mm_sqrt_pd (a.m_value));
+#else
+    return Vec2d (std::sqrt (a.m_value.v [0]), std::sqrt (a.m_value.v [1]));
+#endif
+  }
+
+  /** Load two (x, y, z) records and separate their components.
+
+      @param source Points to six doubles.
+  */
+  static void loadInterleaved3 (double const* source, Vec2d& x, Vec2d& y, Vec2d& z) noexcept
+  {
+#if VF_USE_SSE2
+    // a = x0 y0, b = z0 x1, c = y1 z1
+    __m128d const a = _mm_loadu_pd (source);
+    __m128d const b = _mm_loadu_pd (source + 2);
+    __m128d const c = _mm_loadu_pd (source + 4);
+
+    x.m_value = _mm_shuffle_pd (a, b, 2);
+    y.m_value = _mm_shuffle_pd (a, c, 1);
+    z.m_value = _mm_shuffle_pd (b, c, 2);
+#else
+    x = Vec2d (source [0], source [3]);
+    y = Vec2d (source [1], source [4]);
+    z = Vec2d (source [2], source [5]);
+#endif
+  }
+
+  /** Combine components into two (x, y, z) records and store them.
+
+      @param dest Points to room for six doubles.
+  */
+  static void storeInterleaved3 (double* dest, Vec2d x, Vec2d y, Vec2d z) noexcept
+  {
+#if VF_USE_SSE2
+    _mm_storeu_pd (dest,     _mm_shuffle_pd (x.m_value, y.m_value, 0));
+    _mm_storeu_pd (dest + 2, _mm_shuffle_pd (z.m_value, x.m_value, 2));
+    _mm_storeu_pd (dest + 4, _mm_shuffle_pd (y.m_value, z.m_value, 3));
+#else
+    dest [0] = x.m_value.v [0];
+    dest [1] = y.m_value.v [0];
+    dest [2] = z.m_value.v [0];
+    dest [3] = x.m_value.v [1];
+    dest [4] = y.m_value.v [1];
+    dest [5] = z.m_value.v [1];
+#endif
+  }
+
+private:
+  NativeType m_value;
+};
+
+#endif
@@ -0,0 +1,152 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+static_jassert (sizeof (Vec3 <float>) == 3 * sizeof (float));
+static_jassert (sizeof (Vec3 <double>) == 3 * sizeof (double));
+
+void VectorBatch::transform (float const (&matrix) [3][4],
+                             Vec3 <float> const* source,
+                             Vec3 <float>* dest,
+                             int count) noexcept
+{
+  Vec4f m [3][4];
+
+  for (int row = 0; row < 3; ++row)
+    for (int col = 0; col < 4; ++col)
+      m [row][col] = Vec4f (matrix [row][col]);
+
+  int i = 0;
+
+  for (; i + 4 <= count; i += 4)
+  {
+    Vec4f x, y, z;
+    Vec4f::loadInterleaved3 (&source [i].x, x, y, z);
+
+    Vec4f const tx = m [0][0] * x + m [0][1] * y + m [0][2] * z + m [0][3];
+    Vec4f const ty = m [1][0] * x + m [1][1] * y + m [1][2] * z + m [1][3];
+    Vec4f const tz = m [2][0] * x + m [2][1] * y + m [2][2] * z + m [2][3];
+
+    Vec4f::storeInterleaved3 (&dest [i].x, tx, ty, tz);
+  }
+
+  for (; i < count; ++i)
+  {
+    Vec3 <float> const p = source [i];
+
+    dest [i] = Vec3 <float> (
+      matrix [0][0] * p.x + matrix [0][1] * p.y + matrix [0][2] * p.z + matrix [0][3],
+      matrix [1][0] * p.x + matrix [1][1] * p.y + matrix [1][2] * p.z + matrix [1][3],
+      matrix [2][0] * p.x + matrix [2][1] * p.y + matrix [2][2] * p.z + matrix [2][3]);
+  }
+}
+
+void VectorBatch::transform (double const (&matrix) [3][4],
+                             Vec3 <double> const* source,
+                             Vec3 <double>* dest,
+                             int count) noexcept
+{
+  Vec2d m [3][4];
+
+  for (int row = 0; row < 3; ++row)
+    for (int col = 0; col < 4; ++col)
+      m [row][col] = Vec2d (matrix [row][col]);
+
+  int i = 0;
+
+  for (; i + 2 <= count; i += 2)
+  {
+    Vec2d x, y, z;
+    Vec2d::loadInterleaved3 (&source [i].x, x, y, z);
+
+    Vec2d const tx = m [0][0] * x + m [0][1] * y + m [0][2] * z + m [0][3];
+    Vec2d const ty = m [1][0] * x + m [1][1] * y + m [1][2] * z + m [1][3];
+    Vec2d const tz = m [2][0] * x + m [2][1] * y + m [2][2] * z + m [2][3];
+
+    Vec2d::storeInterleaved3 (&dest [i].x, tx, ty, tz);
+  }
+
+  for (; i < count; ++i)
+  {
+    Vec3 <double> const p = source [i];
+
+    dest [i] = Vec3 <double> (
+      matrix [0][0] * p.x + matrix [0][1] * p.y + matrix [0][2] * p.z + matrix [0][3],
+      matrix [1][0] * p.x + matrix [1][1] * p.y + matrix [1][2] * p.z + matrix [1][3],
+      matrix [2][0] * p.x + matrix [2][1] * p.y + matrix [2][2] * p.z + matrix [2][3]);
+  }
+}
+
+void VectorBatch::normalize (Vec3 <float>* vectors, int count) noexcept
+{
+  Vec4f const zero (0.f);
+  Vec4f const one (1.f);
+
+  int i = 0;
+
+  for (; i + 4 <= count; i += 4)
+  {
+    Vec4f x, y, z;
+    Vec4f::loadInterleaved3 (&vectors [i].x, x, y, z);
+
+    Vec4f const lengthSquared = x * x + y * y + z * z;
+    Vec4f const scale = Vec4f::select (Vec4f::greaterThan (lengthSquared, zero),
+                                       one / Vec4f::sqrt (lengthSquared), one);
+
+    Vec4f::storeInterleaved3 (&vectors [i].x, x * scale, y * scale, z * scale);
+  }
+
+  for (; i < count; ++i)
+    vectors [i].normalize ();
+}
+
+void VectorBatch::dotProduct (Vec3 <float> const* vectors,
+                              Vec3 <float> const& other,
+                              float* results,
+                              int count) noexcept
+{
+  Vec4f const ox (other.x);
+  Vec4f const oy (other.y);
+  Vec4f const oz (other.z);
+
+  int i = 0;
+
+  for (; i + 4 <= count; i += 4)
+  {
+    Vec4f x, y, z;
+    Vec4f::loadInterleaved3 (&vectors [i].x, x, y, z);
+
+    (x * ox + y * oy + z * oz).store (results + i);
+  }
+
+  for (; i < count; ++i)
+    results [i] = vectors [i].getDotProduct (other);
+}
@@ -0,0 +1,86 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_VECTORBATCH_VFHEADER
+#define VF_VECTORBATCH_VFHEADER
+
+#include "vf_PackedVector.h"
+#include "vf_Vec3.h"
+
+/*============================================================================*/
+/**
+  Operations on arrays of Vec3.
+
+  The points are processed four floats or two doubles at a time, using
+  Vec4f and Vec2d, so each function runs on SSE2 or NEON where available.
+  Any remaining points are handled one by one. The source and destination
+  may be the same array.
+
+  An affine transform is given as three rows of four values, so that
+
+    x' = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3]
+
+  and likewise for y' and z'.
+
+  @ingroup vf_core
+*/
+struct VectorBatch
+{
+  /** Apply an affine transform to an array of points. */
+  static void transform (float const (&matrix) [3][4],
+                         Vec3 <float> const* source,
+                         Vec3 <float>* dest,
+                         int count) noexcept;
+
+  /** Apply an affine transform to an array of points. */
+  static void transform (double const (&matrix) [3][4],
+                         Vec3 <double> const* source,
+                         Vec3 <double>* dest,
+                         int count) noexcept;
+
+  /** Scale each vector to unit length.
+
+      Zero vectors are left unchanged, as with Vec3::normalize().
+  */
+  static void normalize (Vec3 <float>* vectors, int count) noexcept;
+
+  /** Calculate the dot product of each vector with one other vector.
+
+      This is the diffuse term of a light shining on an array of normals.
+  */
+  static void dotProduct (Vec3 <float> const* vectors,
+                          Vec3 <float> const& other,
+                          float* results,
+                          int count) noexcept;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_ALIGNEDHEAPBLOCK_VFHEADER
+#define VF_ALIGNEDHEAPBLOCK_VFHEADER
+
+#include "vf_MemoryAlignment.h"
+
+/*============================================================================*/
+/**
+  Heap block whose first element is aligned.
+
+  This is like HeapBlock, for arrays of plain elements that are accessed with
+  SIMD instructions or divided between threads: the data starts on a multiple
+  of Alignment bytes, a cache line by default, so that neither loads nor
+  false sharing straddle a line at the start of the block.
+
+  A block which is requested zero filled is obtained from calloc(). For large
+  blocks, the system provides pages which are already zero and are only
+  touched when first written, so the memory is not cleared up front.
+
+  As with HeapBlock, no constructors or destructors are run.
+
+  @ingroup vf_core
+*/
+template <class T, int Alignment = Memory::cacheLineAlignBytes>
+class AlignedHeapBlock : Uncopyable
+{
+public:
+  /** Create an empty block. */
+  AlignedHeapBlock () noexcept
+    : m_block (nullptr)
+    , m_data (nullptr)
+  {
+  }
+
+  /** Create a block with room for a number of elements. */
+  explicit AlignedHeapBlock (size_t numElements, bool initialiseToZero = false)
+    : m_block (nullptr)
+    , m_data (nullptr)
+  {
+    allocate (numElements, initialiseToZero);
+  }
+
+  ~AlignedHeapBlock ()
+  {
+    ::free (m_block);
+  }
+
+  /** Replace the block with a new one.
+
+      The previous contents are lost.
+
+      @throws std::bad_alloc if the memory is not available.
+  */
+  void allocate (size_t numElements, bool initialiseToZero = false)
+  {
+    static_jassert ((Alignment & (Alignment - 1)) == 0);
+
+    free ();
+
+    size_t const bytes = numElements * sizeof (T) + Alignment;
+
+    m_block = initialiseToZero ? ::calloc (bytes, 1) : ::malloc (bytes);
+
+    if (m_block == nullptr)
+      Throw (std::bad_alloc ());
+
+    uintptr_t const address = uintptr_t (m_block);
+    m_data = reinterpret_cast <T*> ((address + Alignment - 1) & ~uintptr_t (Alignment - 1));
+  }
+
+  /** Release the memory. */
+  void free () noexcept
+  {
+    ::free (m_block);
+    m_block = nullptr;
+    m_data = nullptr;
+  }
+
+  inline T* getData () const noexcept
+  {
+    return m_data;
+  }
+
+  inline operator T* () const noexcept
+  {
+    return m_data;
+  }
+
+  template <typename IndexType>
+  inline T& operator[] (IndexType index) const noexcept
+  {
+    return m_data [index];
+  }
+
+private:
+  void* m_block;
+  T* m_data;
+};
+
+#endif
@@ -67,6 +67,19 @@ inline P* pointerAdjustedForAlignment (P* const p)
                                 bytesNeededForAlignment (p));
 }
 
+// Returns the fewest elements of T which fill a whole number of cache
+// lines. A count of elements rounded up to a multiple of this keeps the
+// element that follows on a cache line, even when sizeof (T) does not
+// divide the line size.
+template <typename T>
+inline int cacheLineElementMultiple ()
+{
+  // The largest power of two which divides the size, at most a line.
+  size_t const grain = sizeof (T) & (~sizeof (T) + 1);
+
+  return (grain < size_t (cacheLineAlignBytes)) ? int (cacheLineAlignBytes / grain) : 1;
+}
+
 }
 
 #endif
@@ -29,3 +29,82 @@
   IN THE SOFTWARE.
 */
 /*============================================================================*/
+
+bool ThreadScheduling::applyToCurrentThread () const
+{
+  bool success = true;
+
+  pthread_t const thread = pthread_self ();
+
+#if JUCE_LINUX
+  CpuSet const cpuSet = (cpus.empty () && numaNode != -1) ?
+    getCpusOfNumaNode (numaNode) : cpus;
+
+  if (!cpuSet.empty ())
+  {
+    cpu_set_t mask;
+    CPU_ZERO (&mask);
+
+    for (std::size_t i = 0; i < cpuSet.size (); ++i)
+    {
+      if (cpuSet [i] >= 0 && cpuSet [i] < CPU_SETSIZE)
+        CPU_SET (cpuSet [i], &mask);
+    }
+
+    if (pthread_setaffinity_np (thread, sizeof (mask), &mask) != 0)
+      success = false;
+  }
+  else if (numaNode != -1)
+  {
+    // The node does not exist.
+    success = false;
+  }
+
+#else
+  // No portable way to set affinity.
+  if (!cpus.empty () || numaNode != -1)
+    success = false;
+
+#endif
+
+  if (policy != policyDefault)
+  {
+    int const nativePolicy = (policy == policyFifo) ? SCHED_FIFO : SCHED_OTHER;
+
+    sched_param param;
+    zerostruct (param);
+
+    if (policy == policyFifo)
+    {
+      param.sched_priority = jlimit (sched_get_priority_min (nativePolicy),
+                                     sched_get_priority_max (nativePolicy),
+                                     priority);
+    }
+
+    if (pthread_setschedparam (thread, nativePolicy, &param) != 0)
+      success = false;
+  }
+
+  return success;
+}
+
+ThreadScheduling::CpuSet ThreadScheduling::getCpusOfNumaNode (int numaNode)
+{
+  CpuSet cpus;
+
+#if JUCE_LINUX
+  if (numaNode >= 0)
+  {
+    String path;
+    path << "/sys/devices/system/node/node" << numaNode << "/cpulist";
+
+    File const file (path);
+
+    if (file.existsAsFile ())
+      cpus = parseCpuList (file.loadFileAsString ());
+  }
+
+#endif
+
+  return cpus;
+}
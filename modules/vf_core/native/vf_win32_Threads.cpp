@@ -29,3 +29,63 @@
   IN THE SOFTWARE.
 */
 /*============================================================================*/
+
+bool ThreadScheduling::applyToCurrentThread () const
+{
+  bool success = true;
+
+  HANDLE const thread = GetCurrentThread ();
+
+  CpuSet const cpuSet = (cpus.empty () && numaNode != -1) ?
+    getCpusOfNumaNode (numaNode) : cpus;
+
+  if (!cpuSet.empty ())
+  {
+    DWORD_PTR mask = 0;
+
+    for (std::size_t i = 0; i < cpuSet.size (); ++i)
+    {
+      if (cpuSet [i] >= 0 && cpuSet [i] < int (sizeof (DWORD_PTR) * 8))
+        mask |= DWORD_PTR (1) << cpuSet [i];
+    }
+
+    if (mask == 0 || SetThreadAffinityMask (thread, mask) == 0)
+      success = false;
+  }
+  else if (numaNode != -1)
+  {
+    // The node does not exist.
+    success = false;
+  }
+
+  if (policy != policyDefault)
+  {
+    int const nativePriority = (policy == policyFifo) ?
+      THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_NORMAL;
+
+    if (! SetThreadPriority (thread, nativePriority))
+      success = false;
+  }
+
+  return success;
+}
+
+ThreadScheduling::CpuSet ThreadScheduling::getCpusOfNumaNode (int numaNode)
+{
+  CpuSet cpus;
+
+  ULONGLONG mask;
+
+  if (numaNode >= 0 &&
+      numaNode <= 0xff &&
+      GetNumaNodeProcessorMask (UCHAR (numaNode), &mask))
+  {
+    for (int cpu = 0; cpu < 64; ++cpu)
+    {
+      if ((mask & (ULONGLONG (1) << cpu)) != 0)
+        cpus.push_back (cpu);
+    }
+  }
+
+  return cpus;
+}
@@ -0,0 +1,85 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+ThreadScheduling::ThreadScheduling ()
+  : numaNode (-1)
+  , policy (policyDefault)
+  , priority (0)
+{
+}
+
+ThreadScheduling::CpuSet ThreadScheduling::parseCpuList (String const& cpuList)
+{
+  CpuSet cpus;
+
+  int const numCpus = SystemStats::getNumCpus ();
+
+  StringArray ranges;
+  ranges.addTokens (cpuList.trim (), ",", String::empty);
+
+  for (int i = 0; i < ranges.size (); ++i)
+  {
+    String const range (ranges [i].trim ());
+
+    if (range.isNotEmpty ())
+    {
+      int const dash = range.indexOfChar ('-');
+
+      int first;
+      int last;
+
+      if (dash != -1)
+      {
+        first = range.substring (0, dash).getIntValue ();
+        last = range.substring (dash + 1).getIntValue ();
+      }
+      else
+      {
+        first = range.getIntValue ();
+        last = first;
+      }
+
+      // Reversed ranges are malformed and skipped. The rest are clamped
+      // to the processors that exist, so a huge range can't run away.
+      if (first <= last)
+      {
+        first = jmax (first, 0);
+        last = jmin (last, numCpus - 1);
+
+        for (int cpu = first; cpu <= last; ++cpu)
+          cpus.push_back (cpu);
+      }
+    }
+  }
+
+  return cpus;
+}
@@ -0,0 +1,143 @@
+/*============================================================================*/
+/*
+  VFLib: https://github.com/vinniefalco/VFLib
+
+  Copyright (C) 2008 by Vinnie Falco <vinnie.falco@gmail.com>
+
+  This library contains portions of other open source products covered by
+  separate licenses. Please see the corresponding source files for specific
+  terms.
+  
+  VFLib is provided under the terms of The MIT License (MIT):
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  IN THE SOFTWARE.
+*/
+/*============================================================================*/
+
+#ifndef VF_THREADSCHEDULING_VFHEADER
+#define VF_THREADSCHEDULING_VFHEADER
+
+/*============================================================================*/
+/**
+  Scheduling attributes for a thread.
+
+  This describes the processor affinity, NUMA placement, scheduler policy and
+  priority of a thread. Attributes left at their default values are not
+  changed when the scheduling is applied. The attributes are applied from the
+  thread itself, typically at the beginning of its thread function.
+
+  Not every platform supports every attribute:
+
+  - Processor affinity and NUMA placement are supported on Linux and Windows.
+
+  - The FIFO policy maps to SCHED_FIFO on POSIX systems, and to a time
+    critical thread priority on Windows.
+
+  - NUMA placement only restricts the thread to the processors of the node,
+    memory allocation policy is not changed.
+
+  @ingroup vf_core
+*/
+class ThreadScheduling
+{
+public:
+  /** A set of processor numbers.
+
+      An empty set means that the thread may run on any processor.
+  */
+  typedef std::vector <int> CpuSet;
+
+  /** Scheduler policies.
+  */
+  enum Policy
+  {
+    /** Leave the policy and priority unchanged.
+    */
+    policyDefault,
+
+    /** Time sharing policy (SCHED_OTHER).
+    */
+    policyOther,
+
+    /** First in first out real-time policy (SCHED_FIFO).
+    */
+    policyFifo
+  };
+
+  /** Create default scheduling attributes.
+
+      The default attributes leave the thread unchanged.
+  */
+  ThreadScheduling ();
+
+  /** The processors the thread may run on.
+
+      If this is empty and numaNode is set, the thread is restricted to the
+      processors of the NUMA node instead.
+  */
+  CpuSet cpus;
+
+  /** The NUMA node to run on, or -1 for any.
+  */
+  int numaNode;
+
+  /** The scheduler policy.
+  */
+  Policy policy;
+
+  /** The priority within the scheduler policy.
+
+      For policyFifo this is the native real-time priority, and is clamped to
+      the range allowed by the system. It is ignored for the other policies.
+  */
+  int priority;
+
+  /** Apply the attributes to the calling thread.
+
+      Changing the policy to policyFifo usually requires elevated privileges.
+      Attributes which cannot be applied are skipped, the rest are still
+      applied.
+
+      @return `true` if every requested attribute was applied.
+  */
+  bool applyToCurrentThread () const;
+
+  /** Retrieve the processors belonging to a NUMA node.
+
+      @param numaNode The zero based index of the NUMA node.
+
+      @return The set of processors, or an empty set if the node does not
+              exist or the platform does not provide the information.
+  */
+  static CpuSet getCpusOfNumaNode (int numaNode);
+
+  /** Parse a processor list.
+
+      The list is in the format used by Linux, for example "0-3,8,10-11".
+      Processors which don't exist are left out, and ranges where the last
+      processor comes before the first are ignored.
+
+      @param cpuList The text of the list.
+
+      @return The set of processors in the list.
+  */
+  static CpuSet parseCpuList (String const& cpuList);
+};
+
+#endif
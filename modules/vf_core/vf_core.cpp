@@ -46,6 +46,13 @@
 #include <crtdbg.h>
 #endif
 
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #if JUCE_MSVC
 #pragma warning (push)
 #pragma warning (disable: 4100) // unreferenced formal parmaeter
@@ -60,14 +67,19 @@ namespace vf
 #include "diagnostic/vf_Error.cpp"
 #include "diagnostic/vf_FPUFlags.cpp"
 #include "diagnostic/vf_LeakChecked.cpp"
+#include "diagnostic/vf_Metrics.cpp"
+#include "diagnostic/vf_Trace.cpp"
 
 #include "events/vf_OncePerSecond.cpp"
 #include "events/vf_PerformedAtExit.cpp"
+#include "events/vf_TimerWheel.cpp"
 
 #include "math/vf_MurmurHash.cpp"
+#include "math/vf_VectorBatch.cpp"
 
 #include "threads/vf_InterruptibleThread.cpp"
 #include "threads/vf_Semaphore.cpp"
+#include "threads/vf_ThreadScheduling.cpp"
 
 #if JUCE_WINDOWS
 #include "native/vf_win32_FPUFlags.cpp"
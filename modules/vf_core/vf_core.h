@@ -277,6 +277,44 @@
 #define VF_USE_LEAKCHECKED JUCE_CHECK_MEMORY_LEAKS
 #endif
 
+#ifndef VF_USE_METRICS
+#define VF_USE_METRICS 0
+#endif
+
+#ifndef VF_USE_TRACING
+#define VF_USE_TRACING 0
+#endif
+
+#ifndef VF_USE_COROUTINES
+# if defined (__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#  define VF_USE_COROUTINES 1
+# else
+#  define VF_USE_COROUTINES 0
+# endif
+#endif
+
+// Variadic templates, rvalue references and perfect forwarding
+#ifndef VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+# if (__cplusplus >= 201103L) || (defined (_MSC_VER) && _MSC_VER >= 1800)
+#  define VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES 1
+# else
+#  define VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES 0
+# endif
+#endif
+
+#ifndef VF_USE_SSE2
+# if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define VF_USE_SSE2 1
+# else
+#  define VF_USE_SSE2 0
+# endif
+#endif
+
+// The NEON code has not been built yet, so it is only used on request.
+#ifndef VF_USE_NEON
+# define VF_USE_NEON 0
+#endif
+
 /* Get this early so we can use it. */
 #include "modules/juce_core/system/juce_TargetPlatform.h"
 
@@ -349,6 +387,12 @@
 #include <typeinfo>
 #include <vector>
 
+#if VF_COMPILER_SUPPORTS_VARIADIC_TEMPLATES
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#endif
+
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
@@ -362,6 +406,18 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if VF_USE_COROUTINES
+#include <coroutine>
+#endif
+
+#if VF_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if VF_USE_NEON
+#include <arm_neon.h>
+#endif
+
 // Includes Juce
 
 #ifdef _CRTDBG_MAP_ALLOC
@@ -445,27 +501,43 @@ using namespace juce;
 #include "diagnostic/vf_Error.h"
 #include "diagnostic/vf_FPUFlags.h"
 #include "diagnostic/vf_LeakChecked.h"
+#include "diagnostic/vf_Metrics.h"
 #include "diagnostic/vf_SafeBool.h"
 #include "diagnostic/vf_Throw.h"
+#include "diagnostic/vf_Trace.h"
 
+#include "containers/vf_ConcurrentHashMap.h"
+#include "containers/vf_IntervalSet.h"
+#include "containers/vf_IntervalTree.h"
 #include "containers/vf_List.h"
 #include "containers/vf_LockFreeStack.h"
 #include "containers/vf_LockFreeQueue.h"
 #include "containers/vf_Map2D.h"
+#include "containers/vf_MemoizationCache.h"
+#include "containers/vf_PackedList.h"
+#include "containers/vf_PlanarMap2D.h"
 #include "containers/vf_SharedTable.h"
+#include "containers/vf_SortedLookupLayout.h"
 #include "containers/vf_SortedLookupTable.h"
+#include "containers/vf_VersionedSharedTable.h"
 
 #include "events/vf_OncePerSecond.h"
 #include "events/vf_PerformedAtExit.h"
+#include "events/vf_TimerWheel.h"
 
 #include "functor/vf_Bind.h"
+#include "functor/vf_BoundCall.h"
 #include "functor/vf_Function.h"
+#include "functor/vf_UniqueFunction.h"
 
 #include "math/vf_Interval.h"
 #include "math/vf_Math.h"
 #include "math/vf_MurmurHash.h"
+#include "math/vf_PackedVector.h"
 #include "math/vf_Vec3.h"
+#include "math/vf_VectorBatch.h"
 
+#include "memory/vf_AlignedHeapBlock.h"
 #include "memory/vf_AtomicCounter.h"
 #include "memory/vf_AtomicFlag.h"
 #include "memory/vf_AtomicPointer.h"
@@ -488,6 +560,7 @@ using namespace juce;
 #include "threads/vf_Semaphore.h"
 #include "threads/vf_SerialFor.h"
 #include "threads/vf_SpinDelay.h"
+#include "threads/vf_ThreadScheduling.h"
 #include "threads/vf_InterruptibleThread.h"
 
 }
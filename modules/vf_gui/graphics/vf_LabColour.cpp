@@ -123,6 +123,134 @@ LabColour const LabColour::from (XYZColour const& xyz)
   return LabColour (L, a, b, xyz.getAlpha ());
 }
 
+void LabColour::convert (XYZColour const* source, LabColour* dest, int count)
+{
+  static_jassert (sizeof (XYZColour) == 4 * sizeof (float));
+  static_jassert (sizeof (LabColour) == 4 * sizeof (float));
+
+  if (! Vec4f::isNative)
+  {
+    for (int i = 0; i < count; ++i)
+      dest [i] = from (source [i]);
+
+    return;
+  }
+
+  // D65, Observer= 2
+  Vec4f const x0 (95.047f);
+  Vec4f const y0 (100.000f);
+  Vec4f const z0 (108.883f);
+
+  Vec4f const threshold (0.008856f);
+  Vec4f const slope (7.7787f);
+  Vec4f const offset (16.f/116.f);
+
+  for (int i = 0; i < count; i += 4)
+  {
+    int const n = jmin (4, count - i);
+
+    XYZColour in [4];
+    std::copy (source + i, source + i + n, in);
+
+    float const* const floats = reinterpret_cast <float const*> (in);
+
+    // Separate the components of four colours.
+    Vec4f x = Vec4f::load (floats);
+    Vec4f y = Vec4f::load (floats + 4);
+    Vec4f z = Vec4f::load (floats + 8);
+    Vec4f alpha = Vec4f::load (floats + 12);
+    Vec4f::transpose (x, y, z, alpha);
+
+    x = x / x0;
+    y = y / y0;
+    z = z / z0;
+
+    x = Vec4f::select (Vec4f::greaterThan (x, threshold), Vec4f::cbrt (x), slope * x + offset);
+    y = Vec4f::select (Vec4f::greaterThan (y, threshold), Vec4f::cbrt (y), slope * y + offset);
+    z = Vec4f::select (Vec4f::greaterThan (z, threshold), Vec4f::cbrt (z), slope * z + offset);
+
+    Vec4f L = Vec4f (116.f) * y - Vec4f (16.f);
+    Vec4f a = Vec4f (500.f) * (x - y);
+    Vec4f b = Vec4f (200.f) * (y - z);
+    Vec4f::transpose (L, a, b, alpha);
+
+    LabColour out [4];
+    float* const result = reinterpret_cast <float*> (out);
+    L.store (result);
+    a.store (result + 4);
+    b.store (result + 8);
+    alpha.store (result + 12);
+
+    std::copy (out, out + n, dest + i);
+  }
+}
+
+void LabColour::convert (LabColour const* source, XYZColour* dest, int count)
+{
+  static_jassert (sizeof (XYZColour) == 4 * sizeof (float));
+  static_jassert (sizeof (LabColour) == 4 * sizeof (float));
+
+  if (! Vec4f::isNative)
+  {
+    for (int i = 0; i < count; ++i)
+      dest [i] = source [i].toXYZ ();
+
+    return;
+  }
+
+  // D65, Observer= 2
+  Vec4f const x0 (95.047f);
+  Vec4f const y0 (100.000f);
+  Vec4f const z0 (108.883f);
+
+  Vec4f const threshold (0.008856f);
+  Vec4f const slope (7.787f);
+  Vec4f const offset (16.f/116.f);
+
+  for (int i = 0; i < count; i += 4)
+  {
+    int const n = jmin (4, count - i);
+
+    LabColour in [4];
+    std::copy (source + i, source + i + n, in);
+
+    float const* const floats = reinterpret_cast <float const*> (in);
+
+    // Separate the components of four colours.
+    Vec4f L = Vec4f::load (floats);
+    Vec4f a = Vec4f::load (floats + 4);
+    Vec4f b = Vec4f::load (floats + 8);
+    Vec4f alpha = Vec4f::load (floats + 12);
+    Vec4f::transpose (L, a, b, alpha);
+
+    Vec4f y = (L + Vec4f (16.f)) / Vec4f (116.f);
+    Vec4f x = a / Vec4f (500.f) + y;
+    Vec4f z = y - b / Vec4f (200.f);
+
+    Vec4f const tx = x * x * x;
+    Vec4f const ty = y * y * y;
+    Vec4f const tz = z * z * z;
+
+    x = Vec4f::select (Vec4f::greaterThan (tx, threshold), tx, (x - offset) / slope);
+    y = Vec4f::select (Vec4f::greaterThan (ty, threshold), ty, (y - offset) / slope);
+    z = Vec4f::select (Vec4f::greaterThan (tz, threshold), tz, (z - offset) / slope);
+
+    x = x * x0;
+    y = y * y0;
+    z = z * z0;
+    Vec4f::transpose (x, y, z, alpha);
+
+    XYZColour out [4];
+    float* const result = reinterpret_cast <float*> (out);
+    x.store (result);
+    y.store (result + 4);
+    z.store (result + 8);
+    alpha.store (result + 12);
+
+    std::copy (out, out + n, dest + i);
+  }
+}
+
 LabColour const LabColour::withLuminance (float L) const
 {
   return LabColour (
@@ -89,6 +89,21 @@ public:
   LabColour const withAddedLuminance (float amount) const; // amount [0,1]
   LabColour const withMultipliedColour (float amount) const;
 
+  /** Convert an array of colours from XYZ.
+
+      Four colours are converted at a time with SIMD instructions where
+      available. The cube roots are computed by iteration, so the results
+      can differ from the constructor's in the last bit.
+  */
+  static void convert (XYZColour const* source, LabColour* dest, int count);
+
+  /** Convert an array of colours to XYZ.
+
+      Four colours are converted at a time with SIMD instructions where
+      available.
+  */
+  static void convert (LabColour const* source, XYZColour* dest, int count);
+
 private:
   static LabColour const from (XYZColour const& xyz);
 
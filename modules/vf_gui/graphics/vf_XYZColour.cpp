@@ -111,3 +111,113 @@ Colour const XYZColour::toRGB () const
 
   return Colour::fromFloatRGBA  (r, g, b, m_alpha);
 }
+
+float const* XYZColour::getLinearTable ()
+{
+  // The linear value of each 8 bit sRGB component, computed as in from().
+  struct LinearTable
+  {
+    LinearTable ()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        float v = i / 255.f;
+
+        if (v > 0.04045f) v = 100.f * pow ((v + 0.055f) / 1.055f, 2.4f); else v = v / 12.92f;
+
+        values [i] = v;
+      }
+    }
+
+    float values [256];
+  };
+
+  static LinearTable const table;
+
+  return table.values;
+}
+
+void XYZColour::convert (Colour const* source, XYZColour* dest, int count)
+{
+  float const* const linear = getLinearTable ();
+
+  // D65, one column per component
+  Vec4f const red   (0.4124f, 0.2126f, 0.0193f, 0.f);
+  Vec4f const green (0.3576f, 0.7152f, 0.1192f, 0.f);
+  Vec4f const blue  (0.1805f, 0.0722f, 0.9505f, 0.f);
+
+  for (int i = 0; i < count; ++i)
+  {
+    Colour const& c = source [i];
+
+    Vec4f const xyz = red   * Vec4f (linear [c.getRed ()])
+                    + green * Vec4f (linear [c.getGreen ()])
+                    + blue  * Vec4f (linear [c.getBlue ()]);
+
+    float result [4];
+    xyz.store (result);
+
+    dest [i] = XYZColour (result [0], result [1], result [2], c.getAlpha () / 255.f);
+  }
+}
+
+void XYZColour::convert (XYZColour const* source, Colour* dest, int count)
+{
+  static_jassert (sizeof (XYZColour) == 4 * sizeof (float));
+
+  if (! Vec4f::isNative)
+  {
+    for (int i = 0; i < count; ++i)
+      dest [i] = source [i].toRGB ();
+
+    return;
+  }
+
+  Vec4f const hundred (100.f);
+
+  for (int i = 0; i < count; i += 4)
+  {
+    int const n = jmin (4, count - i);
+
+    XYZColour block [4];
+    std::copy (source + i, source + i + n, block);
+
+    float const* const floats = reinterpret_cast <float const*> (block);
+
+    // Separate the components of four colours.
+    Vec4f x = Vec4f::load (floats);
+    Vec4f y = Vec4f::load (floats + 4);
+    Vec4f z = Vec4f::load (floats + 8);
+    Vec4f alpha = Vec4f::load (floats + 12);
+    Vec4f::transpose (x, y, z, alpha);
+
+    x = x / hundred;
+    y = y / hundred;
+    z = z / hundred;
+
+    float r [4];
+    float g [4];
+    float b [4];
+    float a [4];
+
+    encode (x * Vec4f ( 3.2406f) + y * Vec4f (-1.5372f) + z * Vec4f (-0.4986f)).store (r);
+    encode (x * Vec4f (-0.9689f) + y * Vec4f ( 1.8758f) + z * Vec4f ( 0.0415f)).store (g);
+    encode (x * Vec4f ( 0.0557f) + y * Vec4f (-0.2040f) + z * Vec4f ( 1.0570f)).store (b);
+    alpha.store (a);
+
+    for (int k = 0; k < n; ++k)
+      dest [i + k] = Colour::fromFloatRGBA (r [k], g [k], b [k], a [k]);
+  }
+}
+
+Vec4f XYZColour::encode (Vec4f v)
+{
+  // v^(1/2.4) is computed as v^(1/3) * v^(1/12), the second factor
+  // being the fourth root of the first.
+  Vec4f const root = Vec4f::cbrt (v);
+  Vec4f const power = root * Vec4f::sqrt (Vec4f::sqrt (root));
+
+  return Vec4f::select (Vec4f::greaterThan (v, Vec4f (0.0031308f)),
+                        Vec4f (1.055f) * power - Vec4f (0.055f),
+                        Vec4f (12.92f) * v);
+}
@@ -59,8 +59,27 @@ public:
 
   Colour const toRGB () const;
 
+  /** Convert an array of colours from sRGB.
+
+      This gives the same results as the constructor. The gamma curve is
+      taken from a table of the 256 possible component values, and the
+      matrix is applied with SIMD instructions where available.
+  */
+  static void convert (Colour const* source, XYZColour* dest, int count);
+
+  /** Convert an array of colours to sRGB.
+
+      Four colours are converted at a time with SIMD instructions where
+      available. The gamma curve is computed from cube and square roots
+      instead of pow(), so a component can differ from the result of
+      toRGB() by one step.
+  */
+  static void convert (XYZColour const* source, Colour* dest, int count);
+
 private:
   static XYZColour const from (Colour const& sRGB);
+  static float const* getLinearTable ();
+  static Vec4f encode (Vec4f linear);
 
 private:
   float m_x;